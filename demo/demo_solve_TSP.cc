@@ -1,4 +1,5 @@
 #include "xtsp/core/tour_alternatives.h"
+#include "xtsp/core/cost_tracking_tour.h"
 #include "xtsp/initialization/insertion.h"
 #include "xtsp/core/utils.h"
 #include "xtsp/local_search/kopt.h"
@@ -58,12 +59,16 @@ int main(int argc, char const *argv[])
   // typically still faster despite the conversion overhead
   // e.g., in pr144
   // auto tourRefined = tour;
-  xtsp::AdjTabTour tourRefined (tour.getSeqMutableRef__()); 
+  xtsp::AdjTabTour tourRefined (tour.getSequence());
+  // solve on the concrete tour type, so that the 2-opt loop is devirtualized
+  // (a wrapper would turn every tour access into virtual calls)
   xtsp::algo::PriorityTwoOptFinder solver(tourRefined, gExplicit);
   auto twoOptOutcome = solver.solve(tourRefined, gExplicit, 100, true);
 
   auto t3 = std::chrono::high_resolution_clock::now();
-  auto costNew = xtsp::evalTour(tourRefined, gExplicit)/upscale;
+  // outside the timed region, the wrapper evaluates the cost once
+  xtsp::CostTrackingTour<int> tourTracked (tourRefined, gExplicit);
+  auto costNew = tourTracked.cost()/upscale;
   {
     auto gap = costNew + twoOptOutcome.improvement()/upscale -costInit;
     if (std::abs(gap) > 1/upscale)
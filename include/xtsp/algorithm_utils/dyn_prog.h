@@ -2,16 +2,25 @@
 #define __XTSP_LOCAL_SEARCH_DP_H__
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <functional>
+#include <limits>
+#include <type_traits>
+
+#include "xtsp/core/complete_graph.h"
 
 namespace xtsp::algo
 {
-  template <typename CostTy>
+  /// @tparam IdxTy how the vertex IDs in \p bestNextVertex are stored
+  template <typename CostTy, typename IdxTy = uint32_t>
   struct DynProgArena
   {
-    std::vector<size_t> bestNextVertex;
-    std::vector<CostTy> costToGo;
+    std::vector<IdxTy> bestNextVertex;
+    // (accumulated over many edges, hence the wider type)
+    std::vector<AccumTy<CostTy>> costToGo;
+    // scratch for the edge costs of one backpass step
+    std::vector<CostTy> edgeCostBuf;
 
     /// @brief pre-allocate Dynamic Programming work memory
     ///        instead of global variables!
@@ -44,10 +53,10 @@ namespace xtsp::algo
       std::function<CostTy(size_t,size_t)> edgeCostFnc)
     {
       size_t bestQNextVertex = std::numeric_limits<size_t>::max();
-      CostTy bestQVal = std::numeric_limits<CostTy>::max();
+      AccumTy<CostTy> bestQVal = std::numeric_limits<AccumTy<CostTy>>::max();
       for (const size_t nextVertex : allPossibleNextVertices)
       {
-        CostTy qVal = edgeCostFnc(fromVertex, nextVertex) 
+        AccumTy<CostTy> qVal = edgeCostFnc(fromVertex, nextVertex) 
                       + this->costToGo[nextVertex];
         if (qVal < bestQVal)
         {
@@ -58,6 +67,37 @@ namespace xtsp::algo
       this->costToGo[fromVertex] = bestQVal;
       this->bestNextVertex[fromVertex] = bestQNextVertex;
     }
+
+    /// @brief same as above but query all the edge costs 
+    ///        in one batch, see AbstractCompGraph::getEdgeCosts
+    /// @tparam GraphTy AbstractCompGraph<CostTy> or (better) a concrete graph type
+    template <typename GraphTy, typename = std::enable_if_t<
+      std::is_base_of_v<AbstractCompGraph<CostTy>, GraphTy>>>
+    void backpassStep(
+      size_t fromVertex,
+      const std::vector<size_t>& allPossibleNextVertices,
+      const GraphTy& graph)
+    {
+      const size_t numNext = allPossibleNextVertices.size();
+      edgeCostBuf.resize(numNext);
+      graph.getEdgeCosts(
+        fromVertex, allPossibleNextVertices.data(), numNext, edgeCostBuf.data());
+
+      size_t bestQNextVertex = std::numeric_limits<size_t>::max();
+      AccumTy<CostTy> bestQVal = std::numeric_limits<AccumTy<CostTy>>::max();
+      for (size_t k = 0; k < numNext; ++k)
+      {
+        const size_t nextVertex = allPossibleNextVertices[k];
+        AccumTy<CostTy> qVal = edgeCostBuf[k] + this->costToGo[nextVertex];
+        if (qVal < bestQVal)
+        {
+          bestQNextVertex = nextVertex;
+          bestQVal = qVal;
+        }
+      }
+      this->costToGo[fromVertex] = bestQVal;
+      this->bestNextVertex[fromVertex] = bestQNextVertex;
+    }
   };
 }
 
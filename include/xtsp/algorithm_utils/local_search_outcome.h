@@ -0,0 +1,52 @@
+#ifndef __XTSP_LOCAL_SEARCH_OUTCOME_H__
+#define __XTSP_LOCAL_SEARCH_OUTCOME_H__
+
+#include "xtsp/core/cost_traits.h"
+
+#include <cstddef>
+#include <stdexcept>
+
+namespace xtsp::algo
+{
+  /// @brief the summary of a local search run (e.g., 2-opt, Or-opt)
+  ///
+  /// It is accumulated round by round (or sweep by sweep). 
+  /// A (complete) round without any move confirms that the tour is
+  /// a local optimum w.r.t. the neighborhood.
+  template <typename CostTy>
+  struct LocalSearchOutcome
+  {
+  public:
+    AccumTy<CostTy> improvement() const
+    {
+      return m_improvement;
+    }
+    size_t numMoves() const
+    {
+      return m_numMoves;
+    }
+    bool confirmedLocalOptimum() const
+    {
+      return m_confirmedLocalOptimum;
+    }
+    /// @param interrupted the round was cut short (e.g., by a StopCriterion),
+    ///        so it confirms nothing even without a move
+    void update(AccumTy<CostTy> extraImprovement, size_t extraMoves, bool interrupted = false)
+    {
+      if (extraImprovement < 0 || m_confirmedLocalOptimum)
+        throw std::invalid_argument(
+          "LocalSearchOutcome<CostTy>::update expects an improvement to be +ve, "
+          "and if it's already a local optimum, you shouldn't call this again. "
+          "Check if your code has bugs");
+      m_improvement += extraImprovement;
+      m_numMoves += extraMoves;
+      m_confirmedLocalOptimum = (extraMoves == 0 && !interrupted);
+    }
+  protected: 
+    AccumTy<CostTy> m_improvement = 0;
+    size_t m_numMoves = 0; // not just for book keeping 
+    bool m_confirmedLocalOptimum = false; 
+  };
+}
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef __XTSP_STOP_CRITERION_H__
+#define __XTSP_STOP_CRITERION_H__
+
+#include "xtsp/core/cost_traits.h"
+#include "xtsp/core/tour.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <limits>
+
+namespace xtsp::algo
+{
+  enum StopReason
+  {
+    kNotStopped,
+    kDeadlineReached,
+    kStagnated,
+    kTargetCostReached,
+    kCancelled,
+  };
+
+  /**
+   * @brief when a solver shall stop early (and return the best tour so far)
+   *
+   * Any combination of
+   *  - a wall-clock deadline (or a time budget from now on),
+   *  - a stagnation window, i.e., N rounds in a row, each improving
+   *    the tour by at most a given amount,
+   *  - a target cost,
+   *  - a cancellation flag (e.g., set by another thread).
+   * Nothing is set by default, i.e., the solvers run to completion.
+   *
+   * The solvers (optionally) take a pointer to it in \p solve .
+   * They call \p shouldStop in their inner loops (e.g., per vertex of a
+   * sweep or per cluster of a DP), \p recordImprovement per move, and
+   * \p endRound after each round, i.e., a sweep, a pass of the
+   * don't-look queue, or a DP of the cluster optimization.
+   * \p shouldStop is cheap: a flag load and a counter, the clock is read
+   * only every \p setClockCheckInterval calls.
+   * The tour is always valid when a solver stops, since the moves are
+   * never interrupted.
+   *
+   * The progress callback receives the tour whenever a round ends with
+   * a better tour than the last reported one, e.g., to keep a copy
+   * that can be returned on time.
+   *
+   * A criterion may be reused across solvers (e.g., 2-opt then Or-opt):
+   * \p start resets the per-run state, not the deadline.
+   */
+  template <typename CostTy>
+  class StopCriterion
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using ProgressCallback = std::function<void(
+      const AbstractTour &bestSoFar, AccumTy<CostTy> cost)>;
+
+    StopCriterion& setDeadline(Clock::time_point deadline)
+    {
+      m_deadline = deadline;
+      m_hasDeadline = true;
+      return *this;
+    }
+    /// @brief a deadline \p budget from now on
+    StopCriterion& setTimeBudget(Clock::duration budget)
+    {
+      return setDeadline(Clock::now() + budget);
+    }
+    /// @param numRounds 0 disables it
+    /// @param minImprovement a round counts as stagnant if it improves by at most this much
+    StopCriterion& setStagnationWindow(size_t numRounds, AccumTy<CostTy> minImprovement = 0)
+    {
+      m_stagnationWindow = numRounds;
+      m_minImprovement = minImprovement;
+      return *this;
+    }
+    /// @brief stop as soon as the tour costs at most \p targetCost
+    StopCriterion& setTargetCost(AccumTy<CostTy> targetCost)
+    {
+      m_targetCost = targetCost;
+      m_hasTargetCost = true;
+      return *this;
+    }
+    /// @param flag owned by the caller (nullptr to unset), may be set by any thread
+    StopCriterion& setCancelFlag(const std::atomic<bool> *flag)
+    {
+      m_cancelFlag = flag;
+      return *this;
+    }
+    StopCriterion& setProgressCallback(ProgressCallback callback)
+    {
+      m_callback = std::move(callback);
+      return *this;
+    }
+    /// @brief read the clock only every \p numChecks calls of \p shouldStop
+    StopCriterion& setClockCheckInterval(size_t numChecks)
+    {
+      m_clockCheckInterval = (numChecks == 0) ? 1 : numChecks;
+      return *this;
+    }
+
+    StopReason stopReason() const
+    {
+      return m_reason;
+    }
+    bool stopped() const
+    {
+      return m_reason != kNotStopped;
+    }
+    /// @brief the cost of the current tour (as tracked since \p start )
+    AccumTy<CostTy> cost() const
+    {
+      return m_cost;
+    }
+    bool hasProgressCallback() const
+    {
+      return static_cast<bool>(m_callback);
+    }
+
+    /// @brief (by the solvers) a run begins with a tour of \p initialCost
+    void start(AccumTy<CostTy> initialCost)
+    {
+      m_cost = initialCost;
+      m_reportedCost = initialCost;
+      m_roundImprovement = 0;
+      m_numStagnantRounds = 0;
+      m_reason = kNotStopped;
+      m_numChecks = m_clockCheckInterval; // the first call reads the clock
+      if (m_hasTargetCost && m_cost <= m_targetCost)
+        m_reason = kTargetCostReached;
+    }
+
+    /// @brief (by the solvers) cheap enough for the inner loops
+    bool shouldStop()
+    {
+      if (m_reason != kNotStopped)
+        return true;
+      if (m_cancelFlag != nullptr && m_cancelFlag->load(std::memory_order_relaxed))
+        m_reason = kCancelled;
+      else if (m_hasDeadline && ++m_numChecks >= m_clockCheckInterval)
+      {
+        m_numChecks = 0;
+        if (Clock::now() >= m_deadline)
+          m_reason = kDeadlineReached;
+      }
+      return m_reason != kNotStopped;
+    }
+
+    /// @brief (by the solvers) a move has improved the tour
+    void recordImprovement(AccumTy<CostTy> improvement)
+    {
+      m_cost -= improvement;
+      m_roundImprovement += improvement;
+      if (m_hasTargetCost && m_cost <= m_targetCost && m_reason == kNotStopped)
+        m_reason = kTargetCostReached;
+    }
+
+    /// @brief (by the solvers) a round is over
+    /// @param bestSoFar the tour of cost \p cost() , reported if it's new
+    /// @retval shall the solver stop?
+    bool endRound(const AbstractTour &bestSoFar)
+    {
+      if (m_callback && m_cost < m_reportedCost)
+      {
+        m_reportedCost = m_cost;
+        m_callback(bestSoFar, m_cost);
+      }
+      return endRound();
+    }
+    /// @brief (by the solvers) a round is over, without a tour to report
+    /// (the clock is read regardless of \p setClockCheckInterval )
+    bool endRound()
+    {
+      if (m_stagnationWindow > 0)
+      {
+        m_numStagnantRounds = (m_roundImprovement <= m_minImprovement)
+          ? m_numStagnantRounds + 1 : 0;
+        if (m_numStagnantRounds >= m_stagnationWindow && m_reason == kNotStopped)
+          m_reason = kStagnated;
+      }
+      m_roundImprovement = 0;
+      m_numChecks = m_clockCheckInterval;
+      return shouldStop();
+    }
+
+  protected:
+    // the settings
+    Clock::time_point m_deadline;
+    bool m_hasDeadline = false;
+    size_t m_stagnationWindow = 0;
+    AccumTy<CostTy> m_minImprovement = 0;
+    AccumTy<CostTy> m_targetCost = 0;
+    bool m_hasTargetCost = false;
+    const std::atomic<bool> *m_cancelFlag = nullptr;
+    ProgressCallback m_callback;
+    size_t m_clockCheckInterval = 64;
+
+    // the state of the current run
+    AccumTy<CostTy> m_cost = std::numeric_limits<AccumTy<CostTy>>::max();
+    AccumTy<CostTy> m_reportedCost = std::numeric_limits<AccumTy<CostTy>>::max();
+    AccumTy<CostTy> m_roundImprovement = 0;
+    size_t m_numStagnantRounds = 0;
+    size_t m_numChecks = 0;
+    StopReason m_reason = kNotStopped;
+  };
+}
+
+#endif
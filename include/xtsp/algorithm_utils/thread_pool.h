@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace xtsp::internal
+{
+  /**
+   * A fixed set of worker threads for fork-join loops
+   *
+   * \p parallelFor blocks until all the tasks are done, and the
+   * calling thread works on them too (as thread 0). The tasks are
+   * claimed one by one from an atomic counter, so uneven tasks are
+   * balanced dynamically. The workers sleep between the loops,
+   * i.e., no thread is created per loop.
+   *
+   * Only one \p parallelFor may run at a time (it is not reentrant).
+   */
+  class ThreadPool
+  {
+  public:
+    /// @param numThreads including the calling thread,
+    ///        0 means std::thread::hardware_concurrency()
+    explicit ThreadPool(size_t numThreads = 0)
+    {
+      if (numThreads == 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+      m_workers.reserve(numThreads - 1);
+      for (size_t threadId = 1; threadId < numThreads; ++threadId)
+        m_workers.emplace_back([this, threadId] { workerLoop(threadId); });
+    }
+    ~ThreadPool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+      }
+      m_cvStart.notify_all();
+      for (auto &worker : m_workers)
+        worker.join();
+    }
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool& operator=(const ThreadPool &) = delete;
+
+    size_t numThreads() const
+    {
+      return m_workers.size() + 1;
+    }
+
+    /// @brief call fn(taskId, threadId) for taskId = 0, ..., numTasks - 1
+    /// @param fn must be safe to call concurrently,
+    ///        threadId in {0, ..., numThreads() - 1} indexes per-thread scratch
+    /// @throw the first exception thrown by @a fn (after all threads stop)
+    template <typename Fn>
+    void parallelFor(size_t numTasks, Fn &&fn)
+    {
+      m_nextTask = 0;
+      m_job = [&fn, numTasks, this](size_t threadId)
+      {
+        for (size_t taskId = m_nextTask++; taskId < numTasks; taskId = m_nextTask++)
+          fn(taskId, threadId);
+      };
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+        m_numBusy = m_workers.size();
+        m_error = nullptr;
+      }
+      m_cvStart.notify_all();
+      runJob(0);
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cvDone.wait(lock, [this] { return m_numBusy == 0; });
+      }
+      m_job = nullptr;
+      if (m_error)
+        std::rethrow_exception(m_error);
+    }
+
+  protected:
+    void workerLoop(size_t threadId)
+    {
+      size_t lastGeneration = 0;
+      while (true)
+      {
+        {
+          std::unique_lock<std::mutex> lock(m_mutex);
+          m_cvStart.wait(lock, [&] { return m_stop || m_generation != lastGeneration; });
+          if (m_stop)
+            return;
+          lastGeneration = m_generation;
+        }
+        runJob(threadId);
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          --m_numBusy;
+        }
+        m_cvDone.notify_one();
+      }
+    }
+    void runJob(size_t threadId)
+    {
+      try
+      {
+        m_job(threadId);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_error)
+          m_error = std::current_exception();
+        // let the others run out of tasks
+        m_nextTask = std::numeric_limits<size_t>::max() / 2;
+      }
+    }
+
+    std::vector<std::thread> m_workers;
+    std::function<void(size_t)> m_job;
+    std::atomic<size_t> m_nextTask{0};
+    std::mutex m_mutex;
+    std::condition_variable m_cvStart;
+    std::condition_variable m_cvDone;
+    size_t m_generation = 0;
+    size_t m_numBusy = 0;
+    bool m_stop = false;
+    std::exception_ptr m_error;
+  };
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <deque>
 #include <cstddef>
 
 #include <algorithm>
@@ -75,6 +76,132 @@ namespace xtsp::internal
     std::vector<size_t> m_dat;
   };
 
+  /**
+   * FIFO queue of "active" items, aka. don't-look bits
+   *
+   * An item's don't-look bit is off if and only if it is queued.
+   * Unlike WorkBuffer, finding the next item to process is O(1)
+   * since we never scan over the inactive items.
+   *
+   * Each item is queued at most once, pushing an item which
+   * is already queued is a no-op.
+   */
+  class ActiveQueue
+  {
+  public:
+    // initially nothing is queued
+    ActiveQueue(size_t numItems) : m_queued(numItems, false)
+    {
+    }
+    bool isEmpty() const
+    {
+      return m_fifo.empty();
+    }
+    bool isQueued(size_t item) const
+    {
+      return m_queued[item];
+    }
+    void push(size_t item)
+    {
+      if (!m_queued[item])
+      {
+        m_queued[item] = true;
+        m_fifo.push_back(item);
+      }
+    }
+    /// @pre the queue is not empty
+    size_t pop()
+    {
+      size_t item = m_fifo.front();
+      m_fifo.pop_front();
+      m_queued[item] = false;
+      return item;
+    }
+    void clear()
+    {
+      for (const size_t item : m_fifo)
+        m_queued[item] = false;
+      m_fifo.clear();
+    }
+
+  protected:
+    std::deque<size_t> m_fifo;
+    std::vector<bool> m_queued;
+  };
+
+  /**
+   * Max-heap of tour edges by cost, with lazy deletion
+   *
+   * An edge is stored as (U, V, cost), where U -> V was its direction
+   * when pushed. The caller checks upon \p pop whether it is still
+   * a tour edge (in either direction) and drops it otherwise.
+   * So a move only pushes its new edges, i.e., O(log N) each,
+   * and nothing has to be located in the heap.
+   *
+   * (An indexed heap keyed by vertex, i.e., the edge to next(v),
+   * doesn't work well with 2-opt: reversing a segment changes next(v)
+   * of the whole segment, while only 4 undirected edges change.)
+   */
+  template <typename CostTy, typename IdxTy>
+  class TourEdgeHeap
+  {
+  public:
+    struct Entry
+    {
+      CostTy cost;
+      IdxTy vU;
+      IdxTy vV;
+    };
+
+    bool isEmpty() const
+    {
+      return m_entries.empty();
+    }
+    size_t size() const
+    {
+      return m_entries.size();
+    }
+    void clear()
+    {
+      m_entries.clear();
+    }
+    void reserve(size_t capacity)
+    {
+      m_entries.reserve(capacity);
+    }
+    // O(log N)
+    void push(size_t vU, size_t vV, CostTy cost)
+    {
+      m_entries.push_back({cost, static_cast<IdxTy>(vU), static_cast<IdxTy>(vV)});
+      std::push_heap(m_entries.begin(), m_entries.end(), lessCostly);
+    }
+    // O(1) each, call \p heapify afterwards
+    void pushUnordered(size_t vU, size_t vV, CostTy cost)
+    {
+      m_entries.push_back({cost, static_cast<IdxTy>(vU), static_cast<IdxTy>(vV)});
+    }
+    // O(N)
+    void heapify()
+    {
+      std::make_heap(m_entries.begin(), m_entries.end(), lessCostly);
+    }
+    /// @pre the heap is not empty
+    Entry pop()
+    {
+      std::pop_heap(m_entries.begin(), m_entries.end(), lessCostly);
+      const Entry top = m_entries.back();
+      m_entries.pop_back();
+      return top;
+    }
+
+  protected:
+    static bool lessCostly(const Entry &lhs, const Entry &rhs)
+    {
+      return lhs.cost < rhs.cost;
+    }
+    std::vector<Entry> m_entries;
+  };
+
   // more efficient query than WorkBuffer
   // now the query operation becomes O(1)
   // but does it make sense at all?
@@ -0,0 +1,111 @@
+#ifndef __XTSP_CORE_CANDIDATE_SET_H__
+#define __XTSP_CORE_CANDIDATE_SET_H__
+
+#include "xtsp/core/complete_graph.h"
+
+#include <vector>
+
+namespace xtsp
+{
+  /**
+   * @brief Sparse candidate edges, i.e., the K "best" neighbors of each vertex
+   *
+   * Most improvement heuristics only care about short edges.
+   * So instead of treating the instance as a dense graph
+   * (N^2 edges), we keep only K candidates per vertex: O(NK) memory.
+   *
+   * The candidates are stored in the CSR (compressed sparse row) format.
+   * The edge cost is stored inline with the neighbor's ID
+   * so that iterating over a vertex's candidates reads contiguous
+   * memory instead of calling \p getEdgeCost .
+   *
+   * In each row, the candidates are sorted in ascending edge cost
+   * (tie-break: the lower vertex ID first).
+   * For an asymmetric graph, row v concerns the outgoing edges v -> u,
+   * i.e., the nearest successors.
+   */
+  template <typename CostTy>
+  class CandidateSet
+  {
+  public:
+    struct Entry
+    {
+      size_t vertex;
+      CostTy cost;
+    };
+
+    /// @brief a light-weight view of the candidates of a vertex
+    struct Row
+    {
+      const Entry* first;
+      const Entry* last;
+      const Entry* begin() const
+      {
+        return first;
+      }
+      const Entry* end() const
+      {
+        return last;
+      }
+      size_t size() const
+      {
+        return last - first;
+      }
+      const Entry& operator[](size_t k) const
+      {
+        return first[k];
+      }
+    };
+
+    /// @brief low-level ctor (for custom candidates, e.g., from a tour merging)
+    /// @param offsets of length N+1, row v is entries[offsets[v]], ..., entries[offsets[v+1]-1]
+    /// @param entries each row should be sorted in ascending cost
+    CandidateSet(std::vector<size_t>&& offsets, std::vector<Entry>&& entries);
+
+    /**
+     * @brief the K nearest neighbors of each vertex
+     *
+     * We take the most efficient route available for the graph type:
+     *  * ImplicitCompleteGraph: spatial query (K-d tree), O(N K log N)
+     *  * otherwise: partial sort of each row, O(N^2 log K)
+     *
+     * @param numNeighbors K, which will be capped at N-1.
+     */
+    static CandidateSet<CostTy> fromGraph(
+      const AbstractCompGraph<CostTy>& g, size_t numNeighbors);
+
+    /// @brief partial sort of each row
+    static CandidateSet<CostTy> fromGraph(
+      const CompleteGraph<CostTy>& g, size_t numNeighbors);
+
+    size_t numVertices() const
+    {
+      return m_offsets.size() - 1;
+    }
+    size_t numCandidates(size_t v) const
+    {
+      return m_offsets[v+1] - m_offsets[v];
+    }
+    /// @brief the max. number of candidates per vertex
+    size_t maxNumCandidates() const
+    {
+      return m_maxK;
+    }
+
+    Row getCandidates(size_t v) const
+    {
+      return Row{m_entries.data() + m_offsets[v], m_entries.data() + m_offsets[v+1]};
+    }
+
+  protected:
+    std::vector<size_t> m_offsets;
+    std::vector<Entry> m_entries;
+    size_t m_maxK = 0;
+
+    // brute force by partial sorting each row, works for any graph
+    static CandidateSet<CostTy> fromGraphBruteForce(
+      const AbstractCompGraph<CostTy>& g, size_t numNeighbors);
+  };
+} // namespace xtsp
+
+#endif
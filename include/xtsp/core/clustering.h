@@ -2,6 +2,7 @@
 #define __XTSP_CORE_CLUSTERING_H__
 
 #include <vector>
+#include <cstdint>
 #include <stddef.h> // size_t
 
 namespace xtsp
@@ -9,13 +10,17 @@ namespace xtsp
 
   ///@brief useful for Generalized TSP, 
   ///@note In the simple case, just take a single cluster for all graph vertices
-  class Clustering
+  ///@tparam IdxTy how the vertex and cluster IDs are stored, 
+  ///        see the alias \p Clustering
+  template <typename IdxTy>
+  class BasicClustering
   {
   public:
     /// @brief create a non-trivial clustering
     /// @param numVertices 
     /// @param membership membership[i] is the set of vertices associated to cluster i
-    Clustering(size_t numVertices, const std::vector<std::vector<size_t>>& membership);
+    /// @throw std::invalid_argument if \p numVertices doesn't fit in \p IdxTy
+    BasicClustering(size_t numVertices, const std::vector<std::vector<size_t>>& membership);
 
     /// @brief create a trivial clustering (a single cluster for all vertices)
     /// @param numVertices 
@@ -32,7 +37,7 @@ namespace xtsp
     }
 
     /// @brief return the set of indices of vertices belonging to a cluster
-    const std::vector<size_t>& getMembers(size_t clusterId) const
+    const std::vector<IdxTy>& getMembers(size_t clusterId) const
     {
       return m_c2v[clusterId];
     }
@@ -70,21 +75,24 @@ namespace xtsp
      *    It should not be empty
      * @throw std::invalid_argument when there is no cluster, or a cluster is empty.
      */
-    static Clustering cumsum(const std::vector<size_t>& clustersSizes); 
+    static BasicClustering<IdxTy> cumsum(const std::vector<size_t>& clustersSizes); 
 
   protected:
     // total number of vertices (among all clusters)
     size_t m_n;
     // m_c2v[i] = the list of all its vertices' indices of cluster i
-    std::vector<std::vector<size_t>> m_c2v;
+    std::vector<std::vector<IdxTy>> m_c2v;
     // pre-computed reverse lookup from vertex ID to cluster ID
-    std::vector<size_t> m_v2c;
+    std::vector<IdxTy> m_v2c;
 
     /// @brief populate the reverse LUT `m_v2c` while checking if the "clustering" partitions 0, ..., N-1 
     /// @note meant to be called during the construction
     void postInit();
   };
 
+  /// the default clustering (up to 2^32 - 1 vertices)
+  using Clustering = BasicClustering<uint32_t>;
+
 
 } // namespace
 
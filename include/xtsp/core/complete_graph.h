@@ -2,8 +2,14 @@
 #define __XTSP_CORE_COMPLETE_GRAPH_H__
 
 #include "xtsp/core/clustering.h"
+#include "xtsp/core/cost_traits.h"
+#include "xtsp/core/kdtree.h"
 
 #include <memory>
+#include <vector>
+#include <algorithm>
+#include <variant>
+#include <cstdint>
 #include <Eigen/Core>
 
 // round a fp number to the nearest integer
@@ -25,6 +31,17 @@ namespace xtsp
     virtual CostTy getEdgeCost(size_t from, size_t to) const = 0;
     virtual size_t numVertices() const = 0;
 
+    /// @brief the costs from one vertex to many (batched)
+    ///
+    /// One virtual call for a whole row/cluster instead of one per edge.
+    /// The default implementation simply calls \p getEdgeCost in a loop.
+    /// Derived classes should override it with something more efficient.
+    ///
+    /// @param to the IDs of the target vertices (length \p numTo )
+    /// @param[out] out out[k] = getEdgeCost(from, to[k]) (length \p numTo )
+    virtual void getEdgeCosts(
+      size_t from, const size_t* to, size_t numTo, CostTy* out) const;
+
     virtual size_t numClusters() const final;
     virtual bool isClustered() const final;
     virtual const std::shared_ptr<Clustering> getClusteringInfo() const final
@@ -45,6 +62,14 @@ namespace xtsp
   };
 
   /// @brief Weighted, complete graph with explicit representation of edge costs.
+  ///
+  /// Storage layout
+  ///  * asymmetric: the full NxN matrix (row-major, i.e., the costs from 
+  ///    a vertex are contiguous)
+  ///  * symmetric: only the lower triangle (incl. the diagonal) packed 
+  ///    row by row, i.e., N(N+1)/2 entries. 
+  ///    The cost of edge (i,j) with i >= j is at i(i+1)/2 + j.
+  ///
   /// @see AbstractCompGraph<CostTy>
   template <typename CostTy = int>
   class CompleteGraph : public AbstractCompGraph<CostTy>
@@ -59,23 +84,66 @@ namespace xtsp
       const Eigen::Matrix<CostTy, -1, -1>& edgeCosts, 
       const std::shared_ptr<Clustering> clustering = nullptr);
 
-    virtual bool isSymmetric() const override;
+    /// @brief a symmetric graph without going through a NxN matrix
+    /// @param numVertices N
+    /// @param packedLowerTriangle the N(N+1)/2 costs in the packed layout
+    ///         (see the class description)
+    /// @param clustering 
+    static CompleteGraph<CostTy> fromPackedLowerTriangle(
+      size_t numVertices,
+      std::vector<CostTy>&& packedLowerTriangle,
+      const std::shared_ptr<Clustering> clustering = nullptr);
+
+    virtual bool isSymmetric() const override final;
     
-    virtual CostTy getEdgeCost(size_t from, size_t to) const override
+    virtual CostTy getEdgeCost(size_t from, size_t to) const override final
     {
-      return m_mat(from, to);
+      return m_costs[storageIndex(from, to)];
     }
-    virtual size_t numVertices() const override
+    virtual size_t numVertices() const override final
     {
-      return m_mat.rows();
+      return m_numV;
+    }
+    virtual void getEdgeCosts(
+      size_t from, const size_t* to, size_t numTo, CostTy* out) const override final;
+
+    /// @brief the number of stored costs, i.e., N^2 or N(N+1)/2
+    size_t numStoredCosts() const
+    {
+      return m_costs.size();
     }
 
   protected:
     bool m_symmetric;
-    // edge cost from "row Id" to "column Id"
-    Eigen::Matrix<CostTy, -1, -1> m_mat; 
+    size_t m_numV;
+    // see the class description for the layout
+    std::vector<CostTy> m_costs;
+
+    CompleteGraph(
+      bool isSymmetric, 
+      size_t numVertices,
+      std::vector<CostTy>&& costs, 
+      const std::shared_ptr<Clustering> clustering);
+
+    size_t storageIndex(size_t from, size_t to) const
+    {
+      // both are cheap enough to be evaluated unconditionally 
+      // so that the compiler can emit conditional moves instead of branches
+      const size_t hi = std::max(from, to);
+      const size_t lo = std::min(from, to);
+      const size_t packed = hi*(hi+1)/2 + lo;
+      const size_t dense = from*m_numV + to;
+      return m_symmetric ? packed : dense;
+    }
+
+    void warnNegativeCosts() const;
   };
 
+  /// @brief an explicit graph with the narrowest storage that fits
+  /// @see ImplicitCompleteGraph<CostTy>::explicitizeNarrowest
+  using NarrowCompleteGraph = std::variant<
+    CompleteGraph<uint16_t>, CompleteGraph<uint32_t>>;
+
   /// @brief Implicitly represent the N^2 edges where N is the number of vertices.
   /// For really large point set (say in millions),
   /// Most computers won't have enough RAM to store the whole cost matrix explicitly.
@@ -115,11 +183,11 @@ namespace xtsp
     /// @brief the dimension of each data point (typically 2 or 3)
     size_t nDim() const;
 
-    virtual bool isSymmetric() const override
+    virtual bool isSymmetric() const override final
     {
       return true;
     }
-    virtual CostTy getEdgeCost(size_t from, size_t to) const override
+    virtual CostTy getEdgeCost(size_t from, size_t to) const override final
     {
       switch (m_normType)
       {
@@ -131,13 +199,44 @@ namespace xtsp
           return (m_xy.row(from) - m_xy.row(to)).array().abs().maxCoeff();
       }
     }
-    virtual size_t numVertices() const override
+    virtual size_t numVertices() const override final
     {
       return m_xy.rows();
     }
+    /// @brief SIMD kernels if compiled with AVX2/AVX-512 enabled
+    virtual void getEdgeCosts(
+      size_t from, const size_t* to, size_t numTo, CostTy* out) const override final;
 
+    /// @brief precompute all edge costs, rounded to integers 
+    ///        (after scaling them by \p scale )
+    ///
+    /// The costs are written into the packed storage directly, 
+    /// i.e., N(N+1)/2 entries without an intermediate NxN matrix.
     CompleteGraph<int> explicitize(float scale) const;
 
+    /// @brief same as \p explicitize but stored as \p IntTy
+    ///
+    /// A narrower type means less memory bandwidth per edge cost lookup.
+    /// (The algorithms accumulate in a wider type anyway, see CostTraits.)
+    ///
+    /// @tparam IntTy one of int, uint16_t, int16_t, uint32_t
+    /// @throw std::invalid_argument if a scaled cost doesn't fit in \p IntTy
+    template <typename IntTy>
+    CompleteGraph<IntTy> explicitizeAs(float scale) const;
+
+    /// @brief \p explicitize with the narrowest unsigned integer type 
+    ///        that can hold all scaled costs, i.e., uint16_t or uint32_t.
+    ///
+    /// The choice is based on \p upperBoundEdgeCost , so it is 
+    /// decided before computing any edge cost (hence conservative).
+    ///
+    /// @throw std::invalid_argument if even uint32_t is too narrow
+    NarrowCompleteGraph explicitizeNarrowest(float scale) const;
+
+    /// @brief an upper bound of all edge costs, i.e., the diameter 
+    ///        of the bounding box of the points, O(N)
+    CostTy upperBoundEdgeCost() const;
+
     /// @brief Construct super-graph where 
     /// each vertex corresponds to a cluster of this graph.
     /// Use case: local-global GTSP meta-heuristics.
@@ -149,9 +248,20 @@ namespace xtsp
 
     const Eigen::Matrix<CostTy, -1, -1>& getXy() const;
 
+    /// @brief the spatial index over the points (built once in the ctor)
+    ///
+    /// It is shared among the copies of this graph. 
+    /// If you need to delete points (e.g., to query the nearest 
+    /// unvisited vertex), make your own copy of the tree.
+    const KdTree<CostTy>& getKdTree() const
+    {
+      return *m_kdTree;
+    }
+
   protected:
     Eigen::Matrix<CostTy, -1, -1> m_xy;
     int m_normType;
+    std::shared_ptr<const KdTree<CostTy>> m_kdTree;
   };
 } // namespace
 
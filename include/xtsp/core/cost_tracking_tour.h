@@ -0,0 +1,106 @@
+#pragma once
+
+#include <xtsp/core/tour.h>
+
+namespace xtsp
+{
+  /**
+   * @brief A tour that keeps its cost up to date
+   *
+   * It wraps (without owning) another tour and forwards everything to it.
+   * The only difference is that each \p exchangeTwoEdges also updates
+   * the cached tour cost by the move's delta.
+   * So \p cost is O(1) instead of O(N) with \p evalTour .
+   *
+   * The delta of a flip is O(1) for a symmetric graph (the 4 edges).
+   * For an asymmetric graph, the reversed path also changes direction,
+   * so we always reverse BC (i.e., strict) and walk it for the delta.
+   *
+   * Optionally (for debugging), the cached cost can be audited against
+   * \p evalTour every \p auditPeriod moves.
+   *
+   * @note only modify the tour through this wrapper, or call \p resync
+   *       afterwards. Like any AbstractTour, it supports
+   *       \p checkpoint and \p rollback (which update the cost too).
+   */
+  template <typename CostTy>
+  class CostTrackingTour final : public AbstractTour
+  {
+  public:
+    /// @param tour the tour to wrap, which must outlive this wrapper
+    /// @param g the graph of the tour cost, which must outlive this wrapper
+    /// @param auditPeriod check the cached cost every that many moves,
+    ///        0 means never
+    CostTrackingTour(
+      AbstractTour& tour, const AbstractCompGraph<CostTy>& g,
+      size_t auditPeriod = 0);
+
+    /// the current tour cost, O(1)
+    AccumTy<CostTy> cost() const
+    {
+      return m_cost;
+    }
+
+    /// @brief compare the cached cost with \p evalTour , O(N)
+    /// @throw std::logic_error if they mismatch
+    ///        (up to the rounding error of a floating point CostTy)
+    void audit() const;
+
+    /// @brief re-evaluate the cost, e.g., after modifying the wrapped tour directly
+    void resync();
+
+    const AbstractTour& getTour() const
+    {
+      return m_tour;
+    }
+
+    /////////////////////////////
+    ///  Compulsory functions
+    /////////////////////////////
+    virtual size_t size() const override
+    {
+      return m_tour.size();
+    }
+    virtual size_t maxSize() const override
+    {
+      return m_tour.maxSize();
+    }
+    virtual size_t next(size_t v) const override
+    {
+      return m_tour.next(v);
+    }
+    virtual size_t prev(size_t v) const override
+    {
+      return m_tour.prev(v);
+    }
+    virtual size_t getDepotId() const override
+    {
+      return m_tour.getDepotId();
+    }
+    virtual bool between(size_t vA, size_t vB, size_t vC) const override
+    {
+      return m_tour.between(vA, vB, vC);
+    }
+    virtual size_t evalNumStepsAhead(size_t vStart, size_t vGoal) const override
+    {
+      return m_tour.evalNumStepsAhead(vStart, vGoal);
+    }
+
+    /// See the class description about \p strict
+    virtual void exchangeTwoEdges(size_t vA, size_t vC, bool strict = false) override;
+
+    /// The delta is O(1) unless the segment is reversed in an asymmetric graph
+    virtual void moveSegment(
+      size_t vS1, size_t vS2, size_t vP, bool reversed = false) override;
+
+  protected:
+    // audit if it's time to
+    void countMove();
+
+    AbstractTour& m_tour;
+    const AbstractCompGraph<CostTy>& m_graph;
+    const size_t m_auditPeriod;
+    size_t m_numMovesSinceAudit = 0;
+    AccumTy<CostTy> m_cost = 0;
+  };
+}
@@ -0,0 +1,28 @@
+#ifndef __XTSP_CORE_COST_TRAITS_H__
+#define __XTSP_CORE_COST_TRAITS_H__
+
+#include <cstdint>
+#include <type_traits>
+
+namespace xtsp
+{
+  /// @brief How to do arithmetic on edge costs of type \p CostTy
+  ///
+  /// Edge costs may be stored in a narrow type (e.g., uint16_t) 
+  /// to save memory bandwidth, but their sums (tour costs) and 
+  /// differences (gains of a move) need a wider and signed type.
+  /// All algorithms accumulate in \p AccumTy , not in \p CostTy .
+  template <typename CostTy>
+  struct CostTraits
+  {
+    static_assert(std::is_arithmetic_v<CostTy>, "Edge costs must be numbers");
+    using AccumTy = std::conditional_t<
+      std::is_floating_point_v<CostTy>, CostTy, int64_t>;
+  };
+
+  /// @brief the type for tour costs and cost differences
+  template <typename CostTy>
+  using AccumTy = typename CostTraits<CostTy>::AccumTy;
+} // namespace xtsp
+
+#endif
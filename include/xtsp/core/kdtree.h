@@ -0,0 +1,160 @@
+#ifndef __XTSP_CORE_KDTREE_H__
+#define __XTSP_CORE_KDTREE_H__
+
+#include <vector>
+#include <limits>
+#include <stddef.h> // size_t
+#include <Eigen/Core>
+
+namespace xtsp
+{
+  /**
+   * @brief Static K-d tree over a point set (typically 2D or 3D)
+   *
+   * It answers the typical spatial queries needed to get past the N^2 wall,
+   * each in roughly O(log N) for well-distributed points:
+   *
+   *  * k nearest neighbors (also batched over all points)
+   *  * fixed-radius search
+   *  * the nearest point which is not yet deleted,
+   *    e.g., the nearest unvisited city in a tour construction.
+   *
+   * The tree structure is built once. Afterwards, points can only
+   * be (lazily) deleted and restored, which does not rebalance the tree.
+   * Deleted points only affect \p nearestActive .
+   *
+   * The distance follows the same convention as \p ImplicitCompleteGraph .
+   *
+   * Implementation-wise, the points are stored in the tree's order
+   * (row-major, i.e., interleaved coordinates) so that a leaf
+   * occupies a contiguous chunk of memory.
+   *
+   * @tparam CostTy floating-point type of the coordinates
+   */
+  template <typename CostTy = float>
+  class KdTree
+  {
+  public:
+    /// @param xy the list of points (N x nDim)
+    /// @param normType 2 -- Euclidean, 1 -- Manhattan, 0 -- maxNorm
+    /// @param leafSize max. number of points in a leaf node
+    KdTree(
+      const Eigen::Matrix<CostTy, -1, -1>& xy,
+      int normType = 2,
+      size_t leafSize = 8);
+
+    size_t numPoints() const
+    {
+      return m_idx.size();
+    }
+    size_t nDim() const
+    {
+      return m_nDim;
+    }
+    /// @brief number of points that are not deleted
+    size_t numActive() const
+    {
+      return m_nodes.front().numActive;
+    }
+
+    /// @brief the distance between two points (in the original indexing)
+    CostTy distance(size_t from, size_t to) const;
+
+    /**
+     * @brief k nearest neighbors of point \p v (itself excluded)
+     *
+     * @param[out] out the IDs in ascending distance (tie-break: lower ID first).
+     *     It will have min(k, N-1) entries.
+     */
+    void kNearest(size_t v, size_t k, std::vector<size_t>& out) const;
+
+    /**
+     * @brief k nearest neighbors of every point (batched)
+     *
+     * @param[out] out flattened N x min(k, N-1) (row-major),
+     *     row v corresponds to \p kNearest(v, k)
+     * @return the actual number of neighbors per point, i.e., min(k, N-1)
+     */
+    size_t kNearestAll(size_t k, std::vector<size_t>& out) const;
+
+    /**
+     * @brief all points within the (closed) ball around point \p v
+     *
+     * @param[out] out the IDs (itself excluded) in no particular order
+     */
+    void radiusSearch(size_t v, CostTy radius, std::vector<size_t>& out) const;
+
+    /// @brief the nearest point among those not deleted (itself excluded)
+    /// @return std::numeric_limits<size_t>::max() if nothing is left
+    size_t nearestActive(size_t v) const;
+
+    /// @brief lazily delete point \p v , O(log N)
+    /// (no-op if it's already deleted.)
+    void deletePoint(size_t v);
+
+    /// @brief undo all deletions
+    void restoreAll();
+
+    bool isDeleted(size_t v) const
+    {
+      return m_deleted[m_pos[v]];
+    }
+
+  protected:
+    struct Node
+    {
+      // the range [begin, end) of the points in this subtree
+      size_t begin;
+      size_t end;
+      size_t numActive;
+      size_t parent;
+      // children (only meaningful for an internal node)
+      size_t left = 0;
+      size_t right = 0;
+      size_t splitDim = 0;
+      CostTy splitVal = 0;
+      bool isLeaf() const
+      {
+        return left == 0;
+      }
+    };
+
+    size_t m_nDim;
+    int m_normType;
+    size_t m_leafSize;
+    // coordinates in the tree order (m_nDim entries per point)
+    std::vector<CostTy> m_pts;
+    // tree order -> original point ID
+    std::vector<size_t> m_idx;
+    // original point ID -> tree order
+    std::vector<size_t> m_pos;
+    // original point ID -> the leaf node containing it
+    std::vector<size_t> m_leafOf;
+    // indexed by the tree order
+    std::vector<bool> m_deleted;
+    // m_nodes[0] is the root
+    std::vector<Node> m_nodes;
+
+    size_t build(size_t begin, size_t end, size_t parent, const Eigen::Matrix<CostTy, -1, -1>& xy);
+
+    /// "reduced" distance which has the same ordering as the distance,
+    /// e.g., squared L2-norm (to avoid the sqrt)
+    CostTy reducedDist(const CostTy* p, const CostTy* q) const;
+    /// lower bound of the reduced distance to any point across the split plane
+    CostTy reducedAxisDist(CostTy delta) const;
+    CostTy unreduce(CostTy reduced) const;
+
+    // (reduced distance, original point ID) in a max-heap
+    using Candidate = std::pair<CostTy, size_t>;
+    void searchKNearest(
+      size_t nodeId, const CostTy* q, size_t vExclude, size_t k,
+      std::vector<Candidate>& heap) const;
+    void searchRadius(
+      size_t nodeId, const CostTy* q, size_t vExclude, CostTy reducedRadius,
+      std::vector<size_t>& out) const;
+    void searchNearestActive(
+      size_t nodeId, const CostTy* q, size_t vExclude, Candidate& best) const;
+  };
+} // namespace xtsp
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef __XTSP_CORE_POINT_GRAPH_H__
+#define __XTSP_CORE_POINT_GRAPH_H__
+
+#include "xtsp/core/complete_graph.h"
+
+#include <array>
+#include <cmath>
+#include <variant>
+#include <vector>
+
+namespace xtsp
+{
+  /// @brief the norm of the difference of two points
+  enum NormType
+  {
+    kMaxNorm = 0,
+    kL1Norm = 1, // aka. Manhattan
+    kL2Norm = 2, // aka. Euclidean
+  };
+
+  /**
+   * @brief Same as ImplicitCompleteGraph but the dimension 
+   *        and the norm are fixed at compile time.
+   *
+   * Compared to ImplicitCompleteGraph, 
+   *  * the coordinates of a point are interleaved (array of structs), 
+   *    so an edge cost query touches one or two cache lines 
+   *    instead of one per dimension.
+   *  * the distance computation is fully inlined, 
+   *    i.e., no per-edge branching on the norm or dimension.
+   * 
+   * Each point is padded to a power-of-two number of coordinates
+   * (e.g., 4 floats for 3D) and aligned accordingly.
+   * 
+   * Use \p loadPointGraphFromTsplibFile to pick the right 
+   * specialization for a TSPLIB instance.
+   *
+   * @tparam NDim the dimension of each point (typically 2 or 3)
+   * @tparam Norm see NormType
+   * @tparam CostTy should be a floating-point type
+   */
+  template <size_t NDim, NormType Norm, typename CostTy = float>
+  class PointGraph : public AbstractCompGraph<CostTy>
+  {
+  public:
+    static_assert(NDim > 0, "a point must have at least one coordinate");
+    static_assert(std::is_floating_point_v<CostTy>, "use a floating-point CostTy");
+
+    /// @brief the number of coordinates per point incl. the padding,
+    ///        i.e., NDim rounded up to a power of two
+    static constexpr size_t kStride = []()
+    {
+      size_t stride = 1;
+      while (stride < NDim)
+        stride *= 2;
+      return stride;
+    }();
+
+    struct alignas(sizeof(CostTy)*kStride) Point
+    {
+      std::array<CostTy, kStride> coord;
+    };
+
+    /// @param xy the list of points (N x NDim)
+    /// @param clustering
+    PointGraph(
+      const Eigen::Matrix<CostTy, -1, -1>& xy, 
+      const std::shared_ptr<Clustering> clustering = nullptr);
+
+    virtual bool isSymmetric() const override final
+    {
+      return true;
+    }
+    virtual CostTy getEdgeCost(size_t from, size_t to) const override final
+    {
+      return distance(m_pts[from], m_pts[to]);
+    }
+    virtual size_t numVertices() const override final
+    {
+      return m_pts.size();
+    }
+    virtual void getEdgeCosts(
+      size_t from, const size_t* to, size_t numTo, CostTy* out) const override final
+    {
+      const Point p = m_pts[from];
+      for (size_t k = 0; k < numTo; ++k)
+        out[k] = distance(p, m_pts[to[k]]);
+    }
+
+    static CostTy distance(const Point& p, const Point& q)
+    {
+      CostTy acc = 0;
+      for (size_t d = 0; d < NDim; ++d)
+      {
+        const CostTy diff = p.coord[d] - q.coord[d];
+        if constexpr (Norm == kL2Norm)
+          acc += diff*diff;
+        else if constexpr (Norm == kL1Norm)
+          acc += std::abs(diff);
+        else
+          acc = std::max(acc, std::abs(diff));
+      }
+      if constexpr (Norm == kL2Norm)
+        return std::sqrt(acc);
+      else
+        return acc;
+    }
+
+    const Point& getPoint(size_t v) const
+    {
+      return m_pts[v];
+    }
+
+    /// @brief the points as a N x NDim matrix (a copy), 
+    ///        e.g., to build a KdTree
+    Eigen::Matrix<CostTy, -1, -1> getXy() const;
+
+  protected:
+    std::vector<Point> m_pts;
+  };
+
+  /// @brief all the specializations \p loadPointGraphFromTsplibFile may return
+  using AnyPointGraph = std::variant<
+    PointGraph<2, kL2Norm>, PointGraph<3, kL2Norm>,
+    PointGraph<2, kL1Norm>, PointGraph<3, kL1Norm>>;
+
+  /**
+   * @brief Load a TSP or GTSP instance from a (G)TSPLIB-formatted file
+   * 
+   * The specialization of PointGraph is chosen by EDGE_WEIGHT_TYPE, 
+   * e.g., EUC_2D gives PointGraph<2, kL2Norm>. 
+   * To use the graph, dispatch with std::visit, e.g.,
+   * ```c++
+   * auto anyGraph = loadPointGraphFromTsplibFile(fpath);
+   * std::visit([](const auto& g) { solve(g); }, anyGraph);
+   * ```
+   * 
+   * @param fpath file path
+   */
+  AnyPointGraph loadPointGraphFromTsplibFile(const std::string& fpath);
+} // namespace xtsp
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "xtsp/core/complete_graph.h"
 
+#include <cstdint>
 #include <string_view>
 #include <limits>
 #include <type_traits>
@@ -60,7 +61,7 @@ namespace xtsp
     /// can be quite useful for reinsertion improvement
     ///
     /// call this only if v is already in the tour
-    // virtual size_t prev(size_t v) const = 0;
+    virtual size_t prev(size_t v) const = 0;
 
     virtual bool isHamiltonian() const;
     
@@ -74,6 +75,14 @@ namespace xtsp
     virtual bool isTwoStepsAhead(size_t vStart, size_t vGoal) const;
     virtual bool isTwoPlusStepsAhead(size_t vStart, size_t vGoal) const;
     virtual size_t evalNumStepsAhead(size_t vStart, size_t vGoal) const;
+
+    /// @brief whether \p vB is on the path vA -> ... -> vC 
+    ///        (following the tour direction, both ends inclusive)
+    ///
+    /// Typically used to check the validity of a move (e.g., 3-opt).
+    /// The default implementation walks the tour, i.e., O(N).
+    /// The concrete tour representations override it with O(1) queries.
+    virtual bool between(size_t vA, size_t vB, size_t vC) const;
     
     virtual size_t getDepotId() const = 0;
 
@@ -139,26 +148,118 @@ namespace xtsp
      */
     virtual void exchangeTwoEdges(size_t vA, size_t vC, bool strict = false) = 0;
 
+    /**
+     * Move the segment S1 -> ... -> S2 (following the tour direction)
+     * such that it goes right after vertex P, optionally reversed
+     * 
+     * ```
+     *   O -> S1 -> ... -> S2 -> N -> ... -> P -> Q -> ...
+     *   (becomes)
+     *   O -> N -> ... -> P -> S1 -> ... -> S2 -> Q -> ...  (or P -> S2 -> ... -> S1 -> Q)
+     * ```
+     * 
+     * This is the primitive of Or-opt (usually a segment of 1 to 3 vertices).
+     * If P = O, the segment stays (reversed if requested).
+     * 
+     * The default implementation is a sequence of (up to 3) strict flips.
+     * The concrete tours override it with something cheaper.
+     * 
+     * @param vP must not be on the segment, 
+     *        and the segment must leave at least 2 vertices out.
+     */
+    virtual void moveSegment(size_t vS1, size_t vS2, size_t vP, bool reversed = false);
+
     // virtual void rotateRShift(int v) = 0;
     // virtual void reflectAboutDepot() = 0;
+
+    ///////////////////////////////
+    //   move journal
+    ///////////////////////////////
+
+    /**
+     * @brief start recording the flips and mark the current state
+     * 
+     * Meant for tentative move sequences (e.g., variable-depth search, 
+     * annealing) which may have to be undone:
+     * ```
+     *   size_t cp = tour.checkpoint();
+     *   tour.exchangeTwoEdges(vA, vC); // and so on
+     *   if (!accepted)
+     *     tour.rollback(cp);
+     * ```
+     * Checkpoints can be nested. 
+     * Only \p exchangeTwoEdges and \p moveSegment are recorded, i.e., 
+     * modifications bypassing them (e.g., PermTour::getSeqMutableRef__) are not.
+     * 
+     * @retval the handle to pass to \p rollback
+     */
+    size_t checkpoint()
+    {
+      m_journaling = true;
+      return m_journal.size();
+    }
+
+    /// @brief undo (in reverse order) the flips done since \p checkpoint
+    ///
+    /// Each undone move costs one \p exchangeTwoEdges (or \p moveSegment ), 
+    /// i.e., no O(N) copy of the tour.
+    /// Afterwards, \p next and \p prev are the same as at the checkpoint.
+    /// The newer checkpoints become invalid but this one remains valid.
+    void rollback(size_t checkpoint);
+
+    /// @brief accept the recorded flips and stop recording
+    void clearJournal()
+    {
+      m_journal.clear();
+      m_journaling = false;
+    }
+
+    /// the number of recorded flips
+    size_t journalSize() const
+    {
+      return m_journal.size();
+    }
+
   public:
     // see Wdelete-non-abstract-non-virtual-dtor
     virtual ~AbstractTour() = default;
+
+  protected:
+    // to be called by the implementations of exchangeTwoEdges, 
+    // with the 4 vertices before the flip
+    void recordFlip(size_t vA, size_t vB, size_t vC, size_t vD)
+    {
+      if (m_journaling)
+        m_journal.push_back({{vA, vB, vC, vD}, false, false});
+    }
+    // to be called by the overrides of moveSegment,
+    // with vO = prev(vS1) before the move
+    void recordSegmentMove(size_t vS1, size_t vS2, size_t vO, bool reversed)
+    {
+      if (m_journaling)
+        m_journal.push_back({{vS1, vS2, vO, vO}, true, reversed});
+    }
+
+  private:
+    // either the flip AB, CD -> AC, BD, i.e., {A, B, C, D}
+    // or the segment move, i.e., {S1, S2, O, (unused)}
+    struct Move
+    {
+      size_t v[4];
+      bool isSegmentMove;
+      bool reversed;
+    };
+    std::vector<Move> m_journal;
+    bool m_journaling = false;
   };
 
 
+  /// @brief the total edge cost of the tour
+  ///
+  /// The library's own tour and graph types are dispatched to 
+  /// a loop compiled for the concrete types (no virtual call per edge).
   template <typename CostTy>
-  CostTy evalTour(const AbstractTour& tour, const AbstractCompGraph<CostTy>& g)
-  {
-    size_t vHead = tour.getDepotId();
-    CostTy sum = 0;
-    for (size_t rank = 0; rank < tour.size(); ++rank)
-    {
-      sum += g.getEdgeCost(vHead, tour.next(vHead));
-      vHead = tour.next(vHead);
-    }
-    return sum;
-  }
+  AccumTy<CostTy> evalTour(const AbstractTour& tour, const AbstractCompGraph<CostTy>& g);
 
   /// @brief Permutation representation of a no-revisit tour
   /// 
@@ -169,8 +270,14 @@ namespace xtsp
   ///  This rank-based representation is well-suited for book-keeping,
   ///  crossover operators in Genetic Algorithms 
   ///  
-  class PermTour : public AbstractTour
+  ///  @tparam IdxTy how the vertex IDs and ranks are stored 
+  ///          (the API still speaks size_t). 
+  ///          The 32-bit default halves the memory traffic of a flip 
+  ///          and of a rank look-up, see the alias \p PermTour .
+  template <typename IdxTy>
+  class BasicPermTour : public AbstractTour
   {
+    static_assert(std::is_unsigned_v<IdxTy>, "IdxTy must be an unsigned integer");
   public:
     /// @brief Initialize a tour that has no revisits
     ///         based on the permutation \p sequence .
@@ -179,7 +286,8 @@ namespace xtsp
     /// @param checks check no revisit and no invalid elements in \p sequence .
     ///               Note if all checks are pass 
     ///               AND sequence.size() == maxNumVertices, then the tour is Hamiltonian
-    PermTour(const std::vector<size_t> &sequence, int maxNumVertices = -1, bool checks = true);
+    /// @throw std::invalid_argument if \p maxNumVertices doesn't fit in \p IdxTy
+    BasicPermTour(const std::vector<size_t> &sequence, int maxNumVertices = -1, bool checks = true);
 
     virtual size_t size() const override final
     {
@@ -191,25 +299,61 @@ namespace xtsp
       return m_N;
     }
 
-    // Current implementation O(N) access
-    virtual size_t next(size_t v) const override;
+    // O(1) thanks to the cached rank
+    // (inline and final so that templated solvers can inline it)
+    virtual size_t next(size_t v) const override final
+    {
+      return nextByRank(getRank_(v));
+    }
+    // O(1) thanks to the cached rank
+    virtual size_t prev(size_t v) const override final
+    {
+      return prevByRank(getRank_(v));
+    }
 
-    virtual size_t getDepotId() const override;
+    virtual size_t getDepotId() const override final
+    {
+      return m_HomeId;
+    }
+
+    // O(1) thanks to the cached rank
+    virtual bool between(size_t vA, size_t vB, size_t vC) const override final
+    {
+      const size_t rankA = getRank_(vA);
+      return (getRank_(vB) + size() - rankA)%size() <= (getRank_(vC) + size() - rankA)%size();
+    }
+    // O(1) thanks to the cached rank
+    virtual size_t evalNumStepsAhead(size_t vStart, size_t vGoal) const override final
+    {
+      return (getRank_(vGoal) + size() - getRank_(vStart))%size();
+    }
 
     // O(1) access
     // ID of the vertex after the requested vertex (in rank representation)
     ///
     /// Here, the rank is defined as the position of vertexId in the array.
     /// \p getRank_(depotId) needs not be 0.
-    size_t nextByRank(size_t rank) const;
+    size_t nextByRank(size_t rank) const
+    {
+      return m_seq[(rank+1)%size()];
+    }
+
+    /// @see nextByRank
+    size_t prevByRank(size_t rank) const
+    {
+      return m_seq[(rank+size()-1)%size()];
+    }
 
-    /// @brief O(n) reverse look-up where n = this->size()
+    /// @brief O(1) reverse look-up (cached)
     ///
     /// Here, the rank is defined as the position of vertexId in the array.
     /// \p getRank_(depotId) needs not be 0.
     /// @param vertexId
-    /// @param return -1 if not found, otherwise the tour rank
-    size_t getRank_(size_t vertexId) const;
+    /// @param return the tour rank
+    size_t getRank_(size_t vertexId) const
+    {
+      return m_cache_id2rank_[vertexId];
+    }
 
     /// @brief lower-level access
     ///
@@ -244,11 +388,17 @@ namespace xtsp
     /// guaranteeing no memory allocation if it's not needed.
     /// 
     /// @see \p xtsp::algo::GtspClusterOptimizer<CostTy>::improve
-    virtual std::vector<size_t>& getSeqMutableRef__() final
+    virtual std::vector<IdxTy>& getSeqMutableRef__() final
     {
       return m_seq;
     }
 
+    /// @brief a copy of the sequence (e.g., to construct another tour representation)
+    std::vector<size_t> getSequence() const
+    {
+      return std::vector<size_t>(m_seq.cbegin(), m_seq.cend());
+    }
+
     /**
      * Swap edges AB and CD in a tour with AC and BD
      *  
@@ -261,26 +411,38 @@ namespace xtsp
      * you might want to use exchangeTwoEdges_rankBased instead 
      * @see exchangeTwoEdges_rankBased
      */
-    virtual void exchangeTwoEdges(size_t vA, size_t vC, bool strict = false) override;
-
+    virtual void exchangeTwoEdges(size_t vA, size_t vC, bool strict = false) override final;
 
+    /// Shift the vertices between the segment and its destination
+    /// (whichever side of the ring is shorter) with memmove,
+    /// i.e., O(min(gap, N - gap)).
+    virtual void moveSegment(
+      size_t vS1, size_t vS2, size_t vP, bool reversed = false) override final;
     
   protected:
     /// sequence of vertices, \p m_seq[0] is the "cut" vertex, 
     /// which is NOT duplicated at the end of the sequence.
-    std::vector<size_t> m_seq;
+    std::vector<IdxTy> m_seq;
     // max. number of entries in the tour
     const size_t m_N; 
     size_t m_HomeId;
-    std::vector<size_t> m_cache_id2rank_ 
-      = std::vector<size_t>(m_N, std::numeric_limits<size_t>::max());
+    std::vector<IdxTy> m_cache_id2rank_ 
+      = std::vector<IdxTy>(m_N, std::numeric_limits<IdxTy>::max());
+    // scratch for moveSegment
+    std::vector<IdxTy> m_segBuf;
     // assumption: the tour passes through the same set of vertices.
     // to avoid such overhead, you might want to prefer the 
     // best-improvement instead of first-improvement approach.
     void updateCacheAfterShuffling();
+    /// @brief only update the ranks rankStart, ..., rankStart + numRanks - 1 (wrapped)
+    /// @pre rankStart < size() and numRanks <= size()
+    void updateCacheAfterShuffling(size_t rankStart, size_t numRanks);
     friend class GeneralizedTour;
   };
 
+  /// the default permutation tour (up to 2^32 - 1 vertices)
+  using PermTour = BasicPermTour<uint32_t>;
+
   /// Performance-oriented overload 
   /// 
   /// For array representation, 
@@ -288,13 +450,7 @@ namespace xtsp
   /// We use this for better performance (avoid reverse lookup)
   /// even skipping the modulo operation in \p PermTour::getVertex()
   template <typename CostTy>
-  CostTy evalTour(const PermTour &tour, const AbstractCompGraph<CostTy>& g)
-  {
-    CostTy sum = g.getEdgeCost(tour.getVertex_(tour.size()-1), tour.getVertex_(0));
-    for (size_t rank = 1; rank < tour.size(); ++rank)
-      sum += g.getEdgeCost(tour.getVertex_(rank-1), tour.getVertex_(rank));
-    return sum;
-  }
+  AccumTy<CostTy> evalTour(const PermTour &tour, const AbstractCompGraph<CostTy>& g);
 
   /// @todo use the unified API (e.g., make it a template?)
   /// @todo What about thread-safety???
@@ -2,10 +2,20 @@
 
 #include <xtsp/core/tour.h>
 
+#include <cstdint>
+
 namespace xtsp
 {
   /**
    *  Tour in adjacency table: vertex ID -> (prev vertex , next vertex) 
+   *
+   *  The table is indexed by the vertex ID and stores 32-bit IDs 
+   *  (8 bytes per vertex), hence at most 2^32 - 1 vertices.
+   *
+   *  We also maintain a sequence label for each vertex, i.e., its 
+   *  position along the tour (modulo the tour size, the origin can be any).
+   *  This makes \p between and \p evalNumStepsAhead O(1), and costs
+   *  nothing asymptotically since a flip walks through segment BC anyways.
    */
   class AdjTabTour : public AbstractTour
   {
@@ -19,23 +29,56 @@ namespace xtsp
     /// @see same API as PermTour::PermTour
     AdjTabTour(const std::vector<size_t>& perm, int maxSize = -1, bool checks = true);
 
-    virtual size_t size() const override;
-    virtual size_t maxSize() const override;
-    virtual size_t next(size_t vertex) const override;
-    virtual size_t getDepotId() const override;
+    // (inline and final so that templated solvers can inline them)
+    virtual size_t size() const override final
+    {
+      return m_cache_tourSize;
+    }
+    virtual size_t maxSize() const override final
+    {
+      return m_cache_tourSize;
+    }
+    virtual size_t next(size_t vertex) const override final
+    {
+      return m_links[vertex].next;
+    }
+    virtual size_t prev(size_t vertex) const override final
+    {
+      return m_links[vertex].prev;
+    }
+    virtual size_t getDepotId() const override final
+    {
+      return m_head;
+    }
 
     virtual void exchangeTwoEdges(
-      size_t vA, size_t vC, bool strict = false) override;
+      size_t vA, size_t vC, bool strict = false) override final;
+
+    /// The splice itself is O(segment length), but the sequence labels
+    /// are updated on the shorter side, i.e., O(min(gap, N - gap)).
+    virtual void moveSegment(
+      size_t vS1, size_t vS2, size_t vP, bool reversed = false) override final;
 
-    /// @todo add to Public API
-    // virtual bool isBetween(size_t vA, size_t vB, size_t vC) const override;
+    // O(1) thanks to the sequence labels
+    virtual bool between(size_t vA, size_t vB, size_t vC) const override final
+    {
+      const size_t n = m_cache_tourSize;
+      const size_t labelA = m_label[vA];
+      return (m_label[vB] + n - labelA)%n <= (m_label[vC] + n - labelA)%n;
+    }
+    // O(1) thanks to the sequence labels
+    virtual size_t evalNumStepsAhead(size_t vStart, size_t vGoal) const override final
+    {
+      const size_t n = m_cache_tourSize;
+      return (m_label[vGoal] + n - m_label[vStart])%n;
+    }
 
     //////////////////////////////////////////////
     /// Specialized implementation of public API
     /////////////////////////////////////////////
     virtual bool isOneStepAhead(size_t vStart, size_t vGoal) const override
     {
-      return m_dat[vStart].next == &m_dat[vGoal];
+      return m_links[vStart].next == vGoal;
     }
     virtual bool isTwoPlusStepsAhead(size_t vStart, size_t vGoal) const override
     {
@@ -46,11 +89,6 @@ namespace xtsp
     ///  Non-standard API functions
     ///////////////////////////////
 
-    // size_t prev(size_t vertex) const
-    // {
-    //   return m_dat[vertex].prev->id;
-    // }
-    
     // // manipulate the tour
     // void setDepot(size_t vDepot)
     // {
@@ -58,7 +96,7 @@ namespace xtsp
     // }
     // void reverse() 
     // {
-    //   for (auto& n : m_dat)
+    //   for (auto& n : m_links)
     //   {
     //     std::swap(n.prev, n.next);
     //   }
@@ -68,21 +106,16 @@ namespace xtsp
     
     
   protected:
-    struct Vertex
+    struct Link
     {
-      const size_t id;  // ID of this vertex
-      Vertex* prev = nullptr;
-      Vertex* next = nullptr;
-      // In our case, the ID of this vertex is already 
-      // implied by the address (&this) but it is included 
-      // anyways to simplify the implementation.
-
-      Vertex(size_t v) : id(v)
-      {
-      }
+      uint32_t prev;
+      uint32_t next;
     };
+    static constexpr uint32_t kNotInTour = std::numeric_limits<uint32_t>::max();
     // the adjacency table (which shouldn't get expanded)
-    std::vector<Vertex> m_dat; 
+    std::vector<Link> m_links;
+    // label[next(v)] = label[v] + 1 (modulo the tour size)
+    std::vector<uint32_t> m_label;
     size_t m_head = 0; // used for iterator
     size_t m_cache_tourSize = 0;
     const size_t m_N; // maximum size
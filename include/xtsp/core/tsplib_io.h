@@ -33,6 +33,29 @@ namespace xtsp
   /// @throw if unrecognized/unsupported
   enum TsplibEdgeWeightType tsplibEdgeWeightTypeFromString(const std::string& val);
 
+  /// @brief the content of a geometric TSP or GTSP instance
+  struct TsplibPointSet
+  {
+    std::string name;
+    enum TsplibEdgeWeightType edgeWeightType;
+    // 2 -- Euclidean, 1 -- Manhattan, 0 -- maxNorm
+    int normType;
+    // N x nDim
+    Eigen::Matrix<float, -1, -1> xy;
+    // nullptr unless it's a GTSP instance
+    std::shared_ptr<Clustering> clustering = nullptr;
+  };
+
+  /**
+   * @brief Load a geometric TSP or GTSP instance (NODE_COORD_SECTION)
+   * 
+   * It deduces whether it's a TSP or GTSP instance.
+   * 
+   * @param fpath file path
+   * @throw if the file is malformed or the instance is not supported
+   */
+  TsplibPointSet loadTsplibPointSet(const std::string& fpath);
+
   /**
    * @brief Parser for files in the TSPLIB format.
    *
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <xtsp/core/tour.h>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace xtsp
+{
+  /**
+   * @brief Tour in a two-level doubly-linked list
+   *
+   * The tour is cut into O(sqrt N) segments of consecutive vertices.
+   * The segments form a (cyclic) doubly-linked parent list and each
+   * segment carries a reversal bit. Within a segment, the vertices
+   * form a doubly-linked list and are numbered by a sequence ID.
+   *
+   * A vertex's tour successor is its list successor if the reversal bit
+   * of its segment is off, otherwise its list predecessor.
+   * So reversing a path of whole segments only touches the parent list
+   * (i.e., relink them and toggle their reversal bits).
+   * A path that doesn't start/end at a segment boundary first gets
+   * its end segments split.
+   *
+   * Complexity:
+   *  * \p next, \p prev, \p between : O(1)
+   *  * \p exchangeTwoEdges : O(sqrt N) amortized
+   *    (the segments get rebuilt once too many have been split)
+   *
+   * @ref Fredman, Johnson, McGeoch, & Ostheimer. (1995).
+   *      Data structures for traveling salesmen.
+   *      Journal of Algorithms, 18(3), 432-479.
+   */
+  class TwoLevelListTour : public AbstractTour
+  {
+  public:
+    /////////////////////////////
+    ///  Compulsory functions
+    /////////////////////////////
+
+    /// @brief initialization from a permutation vector
+    /// @param checks no revisit and no invalid index
+    /// @param groupSize the (initial) number of vertices per segment,
+    ///        0 means roughly sqrt(N)
+    /// @see same API as AdjTabTour::AdjTabTour
+    TwoLevelListTour(
+      const std::vector<size_t>& perm, int maxNumVertices = -1,
+      bool checks = true, size_t groupSize = 0);
+
+    // (inline and final so that templated solvers can inline them)
+    virtual size_t size() const override final
+    {
+      return m_tourSize;
+    }
+    virtual size_t maxSize() const override final
+    {
+      return m_N;
+    }
+    virtual size_t next(size_t v) const override final
+    {
+      const Node& node = m_nodes[v];
+      const Segment& seg = m_segs[node.parent];
+      if (v == tail(seg))
+        return head(m_segs[seg.next]);
+      return seg.reversed ? node.prev : node.next;
+    }
+    virtual size_t prev(size_t v) const override final
+    {
+      const Node& node = m_nodes[v];
+      const Segment& seg = m_segs[node.parent];
+      if (v == head(seg))
+        return tail(m_segs[seg.prev]);
+      return seg.reversed ? node.next : node.prev;
+    }
+    virtual size_t getDepotId() const override final
+    {
+      return m_depot;
+    }
+
+    // O(1) via the segment ranks and sequence IDs
+    virtual bool between(size_t vA, size_t vB, size_t vC) const override final
+    {
+      const auto keyA = positionKey(vA);
+      const auto keyB = positionKey(vB);
+      const auto keyC = positionKey(vC);
+      if (keyA <= keyC)
+        return keyA <= keyB && keyB <= keyC;
+      // the path wraps around the origin of the keys
+      return keyA <= keyB || keyB <= keyC;
+    }
+
+    /// If not \p strict , we reverse either BC or DA,
+    /// whichever spans fewer segments.
+    virtual void exchangeTwoEdges(
+      size_t vA, size_t vC, bool strict = false) override final;
+
+    ///////////////////////////////
+    ///  Non-standard API functions
+    ///////////////////////////////
+    size_t numSegments() const
+    {
+      return m_numSegs;
+    }
+
+  protected:
+    static constexpr size_t kNone = std::numeric_limits<size_t>::max();
+
+    struct Node
+    {
+      // the list neighbors within the segment (kNone at the two ends)
+      size_t prev = kNone;
+      size_t next = kNone;
+      size_t parent = kNone; // the segment
+      // increasing along next (within the segment)
+      int64_t seq = 0;
+    };
+
+    struct Segment
+    {
+      size_t prev = kNone;  // (following the tour direction)
+      size_t next = kNone;
+      size_t first = kNone; // the list ends (ignoring the reversal bit)
+      size_t last = kNone;
+      size_t rank = 0;      // the position in the parent list
+      bool reversed = false;
+    };
+
+    size_t head(const Segment& seg) const
+    {
+      return seg.reversed ? seg.last : seg.first;
+    }
+    size_t tail(const Segment& seg) const
+    {
+      return seg.reversed ? seg.first : seg.last;
+    }
+    size_t segmentSize(const Segment& seg) const
+    {
+      return m_nodes[seg.last].seq - m_nodes[seg.first].seq + 1;
+    }
+    // a key that increases along the tour direction
+    // (starting from the first vertex of m_headSeg)
+    std::pair<size_t, int64_t> positionKey(size_t v) const
+    {
+      const Node& node = m_nodes[v];
+      const Segment& seg = m_segs[node.parent];
+      return {seg.rank, seg.reversed ? -node.seq : node.seq};
+    }
+
+    // reverse the path vB -> ... -> vC (which mustn't be the whole tour)
+    void reversePath(size_t vB, size_t vC);
+    // the case where the path lies within a segment
+    void reverseWithinSegment(size_t segId, size_t vB, size_t vC);
+    // split the segment of v such that v becomes a head
+    void splitBefore(size_t v);
+    // reassign the segment ranks, starting from m_headSeg
+    void updateRanks();
+    // cut the tour into segments of m_groupSize again
+    void rebuildSegments(const std::vector<size_t>& seq);
+
+    std::vector<Node> m_nodes;
+    // the slots of the segments (the first m_numSegs are in use)
+    std::vector<Segment> m_segs;
+    size_t m_numSegs = 0;
+    size_t m_headSeg = 0;
+    size_t m_depot = 0;
+    size_t m_tourSize = 0;
+    size_t m_groupSize = 0;
+    const size_t m_N; // maximum size
+    // work buffer for rebuilding the segments
+    std::vector<size_t> m_workSeq;
+  };
+}
@@ -22,8 +22,9 @@ namespace xtsp
     ///        in the error message, e.g., "array".
     /// @param[in] entryName how to call an entry of a permutation 
     ///        in the error message, e.g., "element".
+    template <typename IdxTy>
     void assertNoDuplicate(
-      const std::vector<size_t>& vec,
+      const std::vector<IdxTy>& vec,
       const std::string arrName = "array",
       const std::string entryName = "element");
 
@@ -34,9 +35,10 @@ namespace xtsp
     ///        in the error message, e.g., "array".
     /// @param[in] entryName how to call an entry of a permutation 
     ///        in the error message, e.g., "element".
+    template <typename IdxTy>
     void assertAllValid(
       size_t upperBound,
-      const std::vector<size_t>& vec,
+      const std::vector<IdxTy>& vec,
       const std::string arrName = "array",
       const std::string entryName = "element");
 
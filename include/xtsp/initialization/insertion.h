@@ -6,6 +6,8 @@
 namespace xtsp::algo
 {
   /// @brief construct a valid Hamiltonian tour via farthest insertion
+  ///
+  /// Complexity: O(N^2), with O(N) batched edge-cost queries.
   /// @param vFirstPick ID of the first vertex to be added to the empty tour 
   template <typename CostTy>
   PermTour farthestInsertion(const AbstractCompGraph<CostTy>& g, size_t vFirstPick = 0);
@@ -0,0 +1,25 @@
+#ifndef __XTSP_TOUR_CONSTRUCTION_NEAREST_NEIGHBOR_H__
+#define __XTSP_TOUR_CONSTRUCTION_NEAREST_NEIGHBOR_H__
+
+#include "xtsp/core/tour.h"
+#include "xtsp/core/candidate_set.h"
+
+namespace xtsp::algo
+{
+  /// @brief construct a valid Hamiltonian tour via the nearest-neighbor heuristic
+  ///
+  /// The next vertex is looked up among the current vertex's candidates.
+  /// Only when all of them are already visited, we fall back to
+  /// the K-d tree of an ImplicitCompleteGraph (about O(log N) per query),
+  /// or to a linear scan over the unvisited vertices for the other graphs.
+  /// So the typical runtime is O(NK) instead of O(N^2).
+  ///
+  /// @param candidates of the graph \p g , sorted in ascending edge cost
+  /// @param vFirstPick ID of the first vertex of the tour
+  template <typename CostTy>
+  PermTour nearestNeighborTour(
+    const AbstractCompGraph<CostTy>& g, const CandidateSet<CostTy>& candidates,
+    size_t vFirstPick = 0);
+}
+
+#endif
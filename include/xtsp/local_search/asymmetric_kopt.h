@@ -0,0 +1,270 @@
+#ifndef __XTSP_ASYMMETRIC_KOPT_H__
+#define __XTSP_ASYMMETRIC_KOPT_H__
+
+#include "xtsp/core/tour.h"
+#include "xtsp/core/candidate_set.h"
+#include "xtsp/algorithm_utils/work_buffer.h"
+#include "xtsp/algorithm_utils/local_search_outcome.h"
+#include "xtsp/local_search/kopt.h"
+#include "xtsp/local_search/or_opt.h"
+
+#include <type_traits>
+#include <vector>
+
+namespace xtsp::algo
+{
+  /**
+   * @brief 2-opt and Or-opt for asymmetric graphs (ATSP)
+   *
+   * In an asymmetric graph, reversing the path B -> ... -> C changes
+   * the cost of every edge on it, so the delta of a 2-opt move is no
+   * longer O(1) from the 4 endpoints. We keep the prefix sums of the
+   * forward and backward edge costs along the tour (in rank order),
+   * so that the cost of any path, in either direction,
+   * is the difference of two prefix sums, i.e., O(1).
+   * The same holds for the Or-opt moves that insert a segment reversed.
+   *
+   * The search itself is the same as NeighborListTwoOptFinder and
+   * NeighborListOrOptFinder (with the don't-look bits), except that the
+   * neighbor lists only offer the new outgoing edges
+   * (the nearest successors, see CandidateSet):
+   *  * 2-opt: A -> C for C among the neighbors of A,
+   *    where A ends either the first or the second removed edge.
+   *  * Or-opt: S2 -> Q (or S1 -> Q if reversed) for Q among the
+   *    neighbors of the segment's end.
+   *
+   * The moves are applied with exchangeTwoEdges(..., strict = true)
+   * and moveSegment. The ranks are updated for the touched ranks only,
+   * but the prefix sums from the first touched rank up to N, since all
+   * the later sums shift. So a move costs O(N) in the worst case,
+   * i.e., N - (first touched rank). (Bounding it to the touched ranks
+   * would take a tree of partial sums, i.e., O(log N) per path cost
+   * instead of O(1), and the queries are far more frequent than the moves.)
+   *
+   * It works for symmetric graphs too, but NeighborListTwoOptFinder
+   * is faster there.
+   */
+  template <typename CostTy>
+  class AsymmetricTwoOptFinder
+  {
+  public:
+    /// @brief build the neighbor lists, i.e., K nearest successors per vertex
+    /// @param numNeighbors K, will be capped at N-1.
+    /// @param maxSegmentLength the Or-opt segments have 1, ..., this many vertices,
+    ///        0 means 2-opt only
+    AsymmetricTwoOptFinder(
+      const AbstractCompGraph<CostTy> &g, size_t numNeighbors = 8,
+      size_t maxSegmentLength = 3);
+
+    /// @brief reuse some prebuilt neighbor lists
+    /// @param candidates each row must be sorted in ascending edge cost
+    AsymmetricTwoOptFinder(
+      const CandidateSet<CostTy> &candidates, size_t maxSegmentLength = 3);
+
+    const CandidateSet<CostTy>& getCandidates() const
+    {
+      return m_candidates;
+    }
+    size_t maxSegmentLength() const
+    {
+      return m_maxSegLen;
+    }
+
+    /// @brief process the don't-look-bit queue until it becomes empty
+    /// @param tour must be Hamiltonian
+    /// @param stop (optional) checked per queued vertex,
+    ///        a round is a pass of the queue
+    LocalSearchOutcome<CostTy> solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement = true,
+      StopCriterion<CostTy> *stop = nullptr);
+
+  protected:
+    // (float sums would lose too much precision in the prefix sums)
+    using SumTy = std::conditional_t<std::is_floating_point_v<CostTy>, double, int64_t>;
+
+    template <typename TourTy, typename GraphTy>
+    LocalSearchOutcome<CostTy> solve_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement,
+      StopCriterion<CostTy> *stop);
+
+    // the queries work on the ranks below, i.e., not on the tour
+    template <typename GraphTy>
+    TwoOptQueryResults<CostTy> query2OptGivenA_(
+      size_t vA, const GraphTy &g, bool firstImprovement) const;
+    template <typename GraphTy>
+    OrOptQueryResults<CostTy> queryOrOptGivenX_(
+      size_t vX, const GraphTy &g, bool firstImprovement) const;
+    template <typename GraphTy>
+    bool querySegment_(
+      size_t vS1, size_t vS2, const GraphTy &g,
+      bool firstImprovement, OrOptQueryResults<CostTy> &res) const;
+
+    // i.e., of tour.exchangeTwoEdges(A, C)
+    template <typename GraphTy>
+    SumTy twoOptGain_(size_t vA, size_t vC, const GraphTy &g) const;
+    // recompute the ranks after the sequence has changed in the ranks
+    // start, ..., start + length - 1 (wrapped), and the prefix sums from
+    // there up to N, i.e., O(length) and O(N - start) respectively
+    template <typename GraphTy>
+    void update_(size_t rankStart, size_t length, const GraphTy &g);
+
+    size_t next(size_t v) const
+    {
+      const size_t rank = m_rankOf[v] + 1;
+      return m_seq[rank == m_seq.size() ? 0 : rank];
+    }
+    size_t prev(size_t v) const
+    {
+      const size_t rank = m_rankOf[v];
+      return m_seq[rank == 0 ? m_seq.size() - 1 : rank - 1];
+    }
+    // the cost of vFrom -> ... -> vTo along the tour
+    SumTy pathCost(size_t vFrom, size_t vTo) const
+    {
+      return pathSum(m_fwdSums, vFrom, vTo);
+    }
+    // the cost of vTo -> ... -> vFrom, i.e., the same path reversed
+    SumTy reversedPathCost(size_t vFrom, size_t vTo) const
+    {
+      return pathSum(m_bwdSums, vFrom, vTo);
+    }
+    SumTy pathSum(const std::vector<SumTy> &sums, size_t vFrom, size_t vTo) const
+    {
+      const size_t rankFrom = m_rankOf[vFrom], rankTo = m_rankOf[vTo];
+      if (rankFrom <= rankTo)
+        return sums[rankTo] - sums[rankFrom];
+      return sums.back() - sums[rankFrom] + sums[rankTo];
+    }
+    // only accept improvements above the rounding error of the sums
+    SumTy minGain() const;
+
+    // the neighbor lists (with the edge costs inline)
+    CandidateSet<CostTy> m_candidates;
+    const size_t m_maxSegLen;
+    // the don't-look bits
+    internal::ActiveQueue m_queue;
+
+    // a copy of the tour in rank order (rank 0 is the depot at the beginning)
+    std::vector<size_t> m_seq;
+    std::vector<size_t> m_rankOf;
+    // m_fwdSums[r] is the cost of m_seq[0] -> ... -> m_seq[r],
+    // m_bwdSums[r] that of m_seq[r] -> ... -> m_seq[0], and
+    // the last entries (r = N) include the edge between m_seq[N-1] and m_seq[0]
+    std::vector<SumTy> m_fwdSums;
+    std::vector<SumTy> m_bwdSums;
+    // scratch for the segment moves
+    std::vector<size_t> m_segBuf;
+  };
+
+  template <typename CostTy>
+  struct OrThreeOptQueryResults
+  {
+  public:
+    AccumTy<CostTy> improvement = 0; // this default value is important
+    // A -> A' ... B -> B' ... C -> C' becomes A -> B' ... C -> A' ... B -> C'
+    size_t vA = 0;
+    size_t vB = 0;
+    size_t vC = 0;
+  public:
+    /// @retval is the new improvement accepted?
+    bool updateIfBetter(
+      AccumTy<CostTy> newImprovement, size_t vA_new, size_t vB_new, size_t vC_new)
+    {
+      if (newImprovement > this->improvement)
+      {
+        this->improvement = newImprovement;
+        this->vA = vA_new;
+        this->vB = vB_new;
+        this->vC = vC_new;
+        return true;
+      }
+      return false;
+    }
+    bool isValid() const
+    {
+      return (improvement > 0);
+    }
+  };
+
+  /**
+   * @brief reversal-free 3-opt (or-3opt) for asymmetric graphs
+   *
+   * The only 3-opt reconnection that keeps the direction of every
+   * segment: with the tour edges A -> A', B -> B', C -> C' removed
+   * (in this order along the tour), the segments A' ... B and B' ... C
+   * swap places, i.e., A -> B' ... C -> A' ... B -> C'.
+   * The segment insertion (Or-opt without reversal) is the special
+   * case where one of the two segments is short.
+   * So no path cost changes and the delta is O(1) from the 6 endpoints,
+   * even in an asymmetric graph.
+   *
+   * The search is sequential on the nearest successors (see CandidateSet):
+   * A -> B' for B' among the neighbors of A, then B -> C' for C' among
+   * those of B = prev(B'), and the closing edge C -> A' is implied.
+   * The partial gains must stay positive, as in ThreeOptFinder.
+   * A move is found from any of A, B, C whose new outgoing edge is
+   * a candidate (and the partial gains positive in that rotation),
+   * so every vertex is queried as A only.
+   *
+   * The moves are applied with moveSegment, i.e., no flip is involved.
+   * The don't-look bits work as in NeighborListTwoOptFinder.
+   *
+   * @see AsymmetricTwoOptFinder for the moves that do reverse a path
+   */
+  template <typename CostTy>
+  class OrThreeOptFinder
+  {
+  public:
+    /// @param numNeighbors K, will be capped at N-1.
+    OrThreeOptFinder(const AbstractCompGraph<CostTy> &g, size_t numNeighbors = 8);
+
+    /// @brief reuse some prebuilt neighbor lists
+    /// @param candidates each row must be sorted in ascending edge cost
+    OrThreeOptFinder(const CandidateSet<CostTy> &candidates);
+
+    const CandidateSet<CostTy>& getCandidates() const
+    {
+      return m_candidates;
+    }
+
+    /// @brief For a given vertex A, find a move that removes A -> next(A).
+    ///
+    /// Complexity: O(K^2)
+    OrThreeOptQueryResults<CostTy> queryMoveGivenA(
+      const AbstractTour &tour, size_t vA, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement = true) const;
+
+    /// @brief perform a (valid) move found by \p queryMoveGivenA
+    ///        on the same tour
+    static void applyMove(AbstractTour &tour, const OrThreeOptQueryResults<CostTy> &res);
+
+    /// @brief process the don't-look-bit queue until it becomes empty
+    /// @param tour must be Hamiltonian
+    /// @param stop (optional) checked per queued vertex,
+    ///        a round is a pass of the queue
+    LocalSearchOutcome<CostTy> solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement = true,
+      StopCriterion<CostTy> *stop = nullptr);
+
+  protected:
+    // the actual implementations on the concrete tour and graph types,
+    // see internal::visitConcreteGraph
+    template <typename TourTy, typename GraphTy>
+    OrThreeOptQueryResults<CostTy> queryMoveGivenA_(
+      const TourTy &tour, size_t vA, const GraphTy &g,
+      bool firstImprovement) const;
+    template <typename TourTy, typename GraphTy>
+    LocalSearchOutcome<CostTy> solve_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement,
+      StopCriterion<CostTy> *stop);
+
+    // the neighbor lists (with the edge costs inline)
+    CandidateSet<CostTy> m_candidates;
+    // the don't-look bits
+    internal::ActiveQueue m_queue;
+  };
+}
+
+#endif
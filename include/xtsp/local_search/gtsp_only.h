@@ -4,6 +4,7 @@
 #include "xtsp/core/complete_graph.h"
 #include "xtsp/core/tour.h"
 #include "xtsp/algorithm_utils/dyn_prog.h"
+#include "xtsp/algorithm_utils/stop_criterion.h"
 
 namespace xtsp
 {
@@ -82,14 +83,21 @@ namespace xtsp
        * @param[out] optimalTour The optimized generalized tour,
        *            which follows the same original cluster sequence 
        *             suggested in \p tour .
+       * @param stop (optional) each DP (i.e., each vertex of \p cutCluster )
+       *            is a round, checked per cluster. The first DP, which is
+       *            for the vertex \p tour uses in \p cutCluster , always
+       *            completes, so the result is then the best among the
+       *            DPs done so far (no longer exact, but never worse than
+       *            \p tour ).
        * @retval the new tour cost after the cluster optimization
        * @sa \p xtsp::Clustering::evalWhichHasTheLeastVertices
        */
-      CostTy solve(
+      AccumTy<CostTy> solve(
         const xtsp::GeneralizedTour &tour, 
         const xtsp::AbstractCompGraph<CostTy> &graph, 
         size_t cutCluster,
-        std::vector<size_t>& optimalTour);
+        std::vector<size_t>& optimalTour,
+        StopCriterion<CostTy> *stop = nullptr);
 
       /**
        * @brief Improve the existing g-tour using Cluster Optimization
@@ -105,13 +113,31 @@ namespace xtsp
        *             will generally be changed. 
        * @param[in] graph 
        * @param[in] cutCluster 
+       * @param stop (optional) see \p solve
        * @retval new tour cost after the optimization
        * @see \p solve
        */
-      CostTy improve(
+      AccumTy<CostTy> improve(
         xtsp::GeneralizedTour &tour, 
         const xtsp::AbstractCompGraph<CostTy> &graph, 
-        size_t cutCluster);
+        size_t cutCluster,
+        StopCriterion<CostTy> *stop = nullptr);
+
+    protected:
+      // the actual DP on the concrete graph type 
+      // (\p solve only dispatches, see internal::visitConcreteGraph)
+      // (\p SeqTy also lets \p improve write into the tour's own sequence)
+      template <typename GraphTy, typename SeqTy>
+      AccumTy<CostTy> solve_(
+        const xtsp::GeneralizedTour &tour, 
+        const GraphTy &graph, 
+        size_t cutCluster,
+        SeqTy& optimalTour,
+        StopCriterion<CostTy> *stop);
+
+      // the members of the next cluster as size_t, 
+      // as expected by AbstractCompGraph::getEdgeCosts
+      std::vector<size_t> m_nextClusterBuf;
     };
 
   } // namespace algo  
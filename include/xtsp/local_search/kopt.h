@@ -2,7 +2,12 @@
 #define __XTSP_KOPT_H__
 
 #include "xtsp/core/tour.h"
+#include "xtsp/core/candidate_set.h"
 #include "xtsp/algorithm_utils/work_buffer.h"
+#include "xtsp/algorithm_utils/local_search_outcome.h"
+#include "xtsp/algorithm_utils/stop_criterion.h"
+
+#include <array>
 
 namespace xtsp::algo
 {
@@ -10,7 +15,7 @@ namespace xtsp::algo
   struct TwoOptQueryResults
   {
   public:
-    CostTy improvement = 0; // this default value is important
+    AccumTy<CostTy> improvement = 0; // this default value is important
     const size_t vA;                // index of vertex A
     size_t vC;                      // index of vertex C
   public:
@@ -21,7 +26,7 @@ namespace xtsp::algo
     /// @param newImprovement the corresponding cost reduction
     /// @param vC_new
     /// @retval is the new improvement accepted?
-    bool updateIfBetter(CostTy newImprovement, size_t vC_new)
+    bool updateIfBetter(AccumTy<CostTy> newImprovement, size_t vC_new)
     {
       if (newImprovement > this->improvement)
       {
@@ -53,6 +58,10 @@ namespace xtsp::algo
   /// To query if a (valid) move is found, simply query
   /// the method \p TwoOptQueryResults<CostTy>::isValid() .
   ///
+  /// The library's own graph and tour types (e.g., CompleteGraph, PermTour)
+  /// are dispatched once to an implementation compiled for the concrete types,
+  /// i.e., no virtual call per edge. Other types go through the virtual methods.
+  ///
   /// @param tour while not checked in the implementation, the tour
   ///        shall concern @p g and passes through @p vA exactly once)
   /// @param vA the ID of vertex A
@@ -72,44 +81,34 @@ namespace xtsp::algo
   };
   
   template <typename CostTy>
-  struct TwoOptOutcome
+  struct TwoOptOutcome : public LocalSearchOutcome<CostTy>
   {
   public:
-    CostTy improvement() const
-    {
-      return m_improvement;
-    }
-    size_t numMoves() const
-    {
-      return m_numMoves;
-    }
     bool confirmedTwoOpt() const
     {
-      return m_confirmedTwoOpt;
-    }
-    void update(CostTy extraImprovement, size_t extraMoves)
-    {
-      if (extraImprovement < 0 || m_confirmedTwoOpt)
-        throw std::invalid_argument(
-          "TwoOptOutcome<CostTy>::update expects an improvement to be +ve, "
-          "and if it's already two-opt, you shouldn't call this again. "
-          "Check if your code has bugs");
-      m_improvement += extraImprovement;
-      m_numMoves += extraMoves;
-      m_confirmedTwoOpt = (extraMoves == 0);
+      return this->m_confirmedLocalOptimum;
     }
-  protected: 
-    CostTy m_improvement = 0;
-    size_t m_numMoves = 0; // not just for book keeping 
-    bool m_confirmedTwoOpt = false; 
   };
 
   ///
-  /// @todo allow early termination?
+  /// The sweeps take vertex A in descending cost of its tour edge AB.
+  /// The tour edges are kept in a heap across sweeps: the first sweep
+  /// (after \p reset ) has all of them, the later ones only the edges
+  /// created by the moves of the previous sweep (and those skipped in it),
+  /// i.e., O(M log N) for M moves instead of O(N log N) per sweep.
+  /// If these yield no move, all the tour edges are queued again
+  /// within the same sweep, so a move-free sweep still confirms 2-opt.
+  ///
+  /// @note Between the sweeps (\p tryOneSweep2Opts ), the tour must only be
+  ///       modified by this finder, otherwise call \p reset first.
+  ///       \p solve does that itself.
+  ///       A sweep stopped early by a \p StopCriterion leaves the rest
+  ///       of its edges queued for the next one.
   /// @todo try to avoid re-visit AB-CD and CD-AB twice
   /// @retval total cost improvement after one sweep of vertex A
   // already 2-opt???
-  template <typename CostTy>
+  /// @tparam IdxTy how the vertex IDs of the priority queue are stored
+  template <typename CostTy, typename IdxTy = uint32_t>
   class PriorityTwoOptFinder
   {
   public:
@@ -117,30 +116,278 @@ namespace xtsp::algo
     PriorityTwoOptFinder(const AbstractTour &tour, const AbstractCompGraph<CostTy> &g);
 
     /// @param[out] numMovesDone after the call, this will be the amount of performed 2-opt moves
+    /// @param stop (optional) checked per vertex A, a round is a sweep
     TwoOptOutcome<CostTy> solve(
       AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
       size_t maxNumSweeps = 10,
-      bool firstImprovement = true);
+      bool firstImprovement = true,
+      StopCriterion<CostTy> *stop = nullptr);
 
     /// @param[out] numMovesDone (need not be 0), this function will increment it by the amount of moves
+    /// @param stop (optional) checked per vertex A, see \p StopCriterion::start
     TwoOptOutcome<CostTy> tryOneSweep2Opts(
       AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
-      bool firstImprovement = true);
+      bool firstImprovement = true,
+      StopCriterion<CostTy> *stop = nullptr);
+
+    /// @brief queue all the tour edges for the next sweep, O(N)
+    void reset(const AbstractTour &tour, const AbstractCompGraph<CostTy> &g);
   protected:
-    void updateForNextSweep(
-      const AbstractTour& tour, const AbstractCompGraph<CostTy> &g);
-    
-    // due to how C++ std::vector is typically implemented, 
-    // it is more efficient to pop from back O(1) instead of the front O(N).
-    // So we will arrange them in descending edge cost AB
-    std::vector<std::pair<size_t, CostTy>> m_vAandCostAB;
+    // the actual sweep on the concrete tour and graph types
+    // (the front door above only dispatches, once per sweep)
+    template <typename TourTy, typename GraphTy>
+    TwoOptOutcome<CostTy> tryOneSweep2Opts_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement,
+      StopCriterion<CostTy> *stop);
+    // pop the heap until it is empty (or \p stop says so)
+    template <typename TourTy, typename GraphTy>
+    void processQueuedEdges_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement,
+      StopCriterion<CostTy> *stop, TwoOptOutcome<CostTy> &outcome);
+    template <typename TourTy, typename GraphTy>
+    void reset_(const TourTy &tour, const GraphTy &g);
+
+    // the tour edges to process in this sweep, by descending cost
+    internal::TourEdgeHeap<CostTy, IdxTy> m_heap;
+    // the edges to process in the next sweep 
+    // (their costs are only evaluated then)
+    std::vector<std::pair<IdxTy, IdxTy>> m_deferredEdges;
+    // whether the heap has all the tour edges, i.e., since \p reset
+    bool m_hasAllEdges = false;
+    // the tour size at \p reset (a cheap consistency check)
+    size_t m_tourSize = 0;
 
     // a light-weight O(1) book-keeping to avoid
     // repeating AB-CD and CD-AB which is identical.
-    // After all we do NOT maintain the edge costs values in 
-    // m_vAandCostAB. So likely we will just be wasting resources
-    // if we don't skip vertex C.
-    std::vector<bool> m_skip; 
+    // Vertex v is skipped if m_skipStamp[v] equals the current
+    // sweep's stamp, so nothing is reset between the sweeps.
+    std::vector<uint32_t> m_skipStamp;
+    uint32_t m_sweepStamp = 0;
+  };
+
+  /**
+   * @brief 2-opt restricted to neighbor lists and driven by don't-look bits
+   *
+   * Unlike \p find2OptMoveGivenA , vertex C is not searched 
+   * along the whole tour. Instead, we only try C among the K nearest 
+   * neighbors of vertex A, both for A's outgoing edge (A -> next(A)) 
+   * and its incoming edge (prev(A) -> A). Since every vertex is 
+   * processed w.r.t. both its tour edges, for a tour edge AB, 
+   * we effectively try the neighbors of both A and B.
+   * The search for a given A also stops as soon as the new edge 
+   * incident to A is no shorter than the removed one
+   * (the so-called positive gain criterion).
+   *
+   * About the don't-look bits: Initially all vertices are queued.
+   * A vertex is dequeued once processed, and only requeued when 
+   * one of its tour edges is changed by a move, i.e., 
+   * the four endpoints A, B, C, D.
+   * As a result, the work per sweep is roughly O(N K) instead of O(N^2).
+   * Once the queue runs dry, all vertices are reactivated once 
+   * to confirm that no move is left.
+   * 
+   * Note that the final tour is only 2-opt w.r.t. the neighbor lists.
+   * (It is the same as the usual 2-opt if K = N-1.)
+   * 
+   * @todo use a spatial index to build the neighbor lists
+   */
+  template <typename CostTy>
+  class NeighborListTwoOptFinder
+  {
+  public:
+    /// @brief build the neighbor lists, i.e., K nearest candidates per vertex
+    ///
+    /// This is the only expensive part of the ctor, 
+    /// see CandidateSet<CostTy>::fromGraph .
+    ///
+    /// @param numNeighbors K, will be capped at N-1.
+    NeighborListTwoOptFinder(const AbstractCompGraph<CostTy> &g, size_t numNeighbors = 8);
+
+    /// @brief reuse some prebuilt neighbor lists
+    /// @param candidates each row must be sorted in ascending edge cost
+    NeighborListTwoOptFinder(const CandidateSet<CostTy> &candidates);
+
+    const CandidateSet<CostTy>& getCandidates() const
+    {
+      return m_candidates;
+    }
+    /// @brief K, i.e., the max. number of neighbors per vertex
+    size_t numNeighbors() const
+    {
+      return m_candidates.maxNumCandidates();
+    }
+
+    /// @brief For a given vertex A, find a 2-opt move that 
+    ///        removes one of A's tour edges.
+    ///
+    /// The move is expressed in the same way as \p find2OptMoveGivenA , 
+    /// i.e., to apply it, call tour.exchangeTwoEdges(res.vA, res.vC).
+    /// Note that res.vA is either A or prev(A).
+    ///
+    /// Complexity: O(K)
+    TwoOptQueryResults<CostTy> queryMoveGivenA(
+      const AbstractTour &tour, size_t vA, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement = true) const;
+
+    /// @brief process the don't-look-bit queue until it becomes empty
+    /// @param tour must be Hamiltonian
+    /// @param stop (optional) checked per queued vertex,
+    ///        a round is a pass of the queue
+    TwoOptOutcome<CostTy> solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement = true,
+      StopCriterion<CostTy> *stop = nullptr);
+
+  protected:
+    // the actual implementations on the concrete tour and graph types,
+    // see internal::visitConcreteGraph
+    template <typename TourTy, typename GraphTy>
+    TwoOptQueryResults<CostTy> queryMoveGivenA_(
+      const TourTy &tour, size_t vA, const GraphTy &g,
+      bool firstImprovement) const;
+    template <typename TourTy, typename GraphTy>
+    TwoOptOutcome<CostTy> solve_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement,
+      StopCriterion<CostTy> *stop);
+
+    // the neighbor lists (with the edge costs inline)
+    CandidateSet<CostTy> m_candidates;
+    // the don't-look bits
+    internal::ActiveQueue m_queue;
+  };
+
+  /// @brief how the 3 removed edges of a sequential 3-opt move are reconnected
+  ///
+  /// With t1 -> t2 ... in the tour and the edges t1-t2, t3-t4, t5-t6 removed
+  /// (t2-t3, t4-t5 and t6-t1 added), see ThreeOptFinder.
+  enum ThreeOptReconnection
+  {
+    kPure2Opt,        // only t1-t2 and t3-t4 are exchanged (t5, t6 unused)
+    kSegmentReversal, // two overlapping flips, i.e., beyond one 2-opt move
+    kOr3Opt,          // the segment t2 -> ... -> t5 is moved between t3 and t4
+    kBothReversed,    // t2 -> ... -> t6 and t5 -> ... -> t3 are both reversed in place
+  };
+
+  template <typename CostTy>
+  struct ThreeOptQueryResults
+  {
+  public:
+    AccumTy<CostTy> improvement = 0; // this default value is important
+    ThreeOptReconnection type = kPure2Opt;
+    std::array<size_t, 6> t{};       // t1, ..., t6
+    // whether t1 -> t2 refers to the reversed tour, i.e., t2 = prev(t1)
+    bool mirrored = false;
+  public:
+    /// @retval is the new improvement accepted?
+    bool updateIfBetter(
+      AccumTy<CostTy> newImprovement, ThreeOptReconnection type_new,
+      const std::array<size_t, 6> &t_new, bool mirrored_new)
+    {
+      if (newImprovement > this->improvement)
+      {
+        this->improvement = newImprovement;
+        this->type = type_new;
+        this->t = t_new;
+        this->mirrored = mirrored_new;
+        return true;
+      }
+      return false;
+    }
+    bool isValid() const
+    {
+      return (improvement > 0);
+    }
+  };
+
+  /**
+   * @brief sequential 3-opt restricted to neighbor lists
+   *
+   * Given t1 and one of its tour edges t1-t2, we add t2-t3 for
+   * t3 among the K nearest neighbors of t2, and remove one of the tour
+   * edges of t3, t3-t4. Then either we close the tour with t4-t1
+   * (a 2-opt move) or go one level deeper, adding t4-t5 for t5 among
+   * the neighbors of t4, removing t5-t6 and closing with t6-t1.
+   * Every partial sum must stay positive (the positive gain criterion),
+   * so each list is scanned only until the new edge is too long.
+   *
+   * Besides 2-opt moves, this covers the sequential 3-opt reconnections
+   * that are not a single 2-opt move, see ThreeOptReconnection,
+   * including the Or-opt moves of any segment length.
+   * The query for t1 is O(K^2), i.e., a sweep is O(N K^2) instead
+   * of the O(N^3) of the full 3-opt neighborhood.
+   *
+   * The sweeps follow \p SweepMethod : with \p kPriorityTwoOptSweep ,
+   * t1 is taken in descending cost of its outgoing tour edge,
+   * as in PriorityTwoOptFinder; with \p kBitfieldTwoOptSweep ,
+   * in the tour order. Either way, each t1 is queried once per sweep.
+   *
+   * Note that the final tour is only 3-opt w.r.t. the neighbor lists.
+   *
+   * @ref Johnson, D. S., & McGeoch, L. A. (1997). The traveling salesman
+   *      problem: A case study in local optimization.
+   * @see NeighborListTwoOptFinder, NeighborListOrOptFinder
+   */
+  template <typename CostTy>
+  class ThreeOptFinder
+  {
+  public:
+    /// @param numNeighbors K, will be capped at N-1.
+    ThreeOptFinder(const AbstractCompGraph<CostTy> &g, size_t numNeighbors = 8);
+
+    /// @brief reuse some prebuilt neighbor lists
+    /// @param candidates each row must be sorted in ascending edge cost
+    ThreeOptFinder(const CandidateSet<CostTy> &candidates);
+
+    const CandidateSet<CostTy>& getCandidates() const
+    {
+      return m_candidates;
+    }
+
+    /// @brief For a given vertex t1, find a move that 
+    ///        removes one of t1's tour edges.
+    ///
+    /// Complexity: O(K^2)
+    ThreeOptQueryResults<CostTy> queryMoveGivenT1(
+      const AbstractTour &tour, size_t vT1, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement = true) const;
+
+    /// @brief perform a (valid) move found by \p queryMoveGivenT1
+    ///        on the same tour
+    static void applyMove(AbstractTour &tour, const ThreeOptQueryResults<CostTy> &res);
+
+    /// @brief sweep until no move is found or \p maxNumSweeps is reached
+    /// @param tour must be Hamiltonian
+    /// @param stop (optional) checked per vertex t1, a round is a sweep
+    LocalSearchOutcome<CostTy> solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      size_t maxNumSweeps = 10, bool firstImprovement = true,
+      SweepMethod method = kPriorityTwoOptSweep,
+      StopCriterion<CostTy> *stop = nullptr);
+
+  protected:
+    // the actual implementations on the concrete tour and graph types,
+    // see internal::visitConcreteGraph
+    template <typename TourTy, typename GraphTy>
+    ThreeOptQueryResults<CostTy> queryMoveGivenT1_(
+      const TourTy &tour, size_t vT1, const GraphTy &g,
+      bool firstImprovement) const;
+    // the search for t2 = next(t1) in the given (possibly mirrored) view
+    // @retval whether to stop (i.e., a first improvement is found)
+    template <typename ViewTy, typename GraphTy>
+    bool queryDirection_(
+      const ViewTy &view, size_t vT1, const GraphTy &g, bool firstImprovement,
+      bool mirrored, ThreeOptQueryResults<CostTy> &res) const;
+    template <typename ViewTy>
+    static void applyMove_(ViewTy &view, const ThreeOptQueryResults<CostTy> &res);
+    template <typename TourTy, typename GraphTy>
+    LocalSearchOutcome<CostTy> tryOneSweep_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement, SweepMethod method,
+      StopCriterion<CostTy> *stop);
+
+    // the neighbor lists (with the edge costs inline)
+    CandidateSet<CostTy> m_candidates;
+    // the order of t1 in a sweep (see PriorityTwoOptFinder)
+    std::vector<std::pair<uint32_t, CostTy>> m_vAandCostAB;
   };
 }
 
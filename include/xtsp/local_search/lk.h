@@ -0,0 +1,135 @@
+#ifndef __XTSP_LK_H__
+#define __XTSP_LK_H__
+
+#include "xtsp/core/tour.h"
+#include "xtsp/core/candidate_set.h"
+#include "xtsp/algorithm_utils/work_buffer.h"
+#include "xtsp/algorithm_utils/local_search_outcome.h"
+#include "xtsp/algorithm_utils/stop_criterion.h"
+
+#include <array>
+#include <utility>
+#include <vector>
+
+namespace xtsp::algo
+{
+  /**
+   * @brief Lin-Kernighan style variable-depth search [LK73]
+   *
+   * A move is built step by step. Given the tour edge t1-t2, each step
+   * adds t2-t3 for t3 among the K nearest neighbors of t2, removes the
+   * tour edge t3-t4 that lets t4-t1 close the tour (i.e., a flip),
+   * and continues from t4 as the new t2. The partial gain, i.e.,
+   * the removed minus the added costs without the closing edge,
+   * must stay positive (the gain criterion). An edge added by the move
+   * is never removed again by the same move.
+   *
+   * The steps are performed on the tour right away and recorded in
+   * its journal (see AbstractTour::checkpoint), so the move is
+   * rolled back to the step with the best closed tour, or completely
+   * if it doesn't improve. The first two levels try all t3
+   * (in descending c(t3,t4) - c(t2,t3)) before giving up,
+   * the deeper levels take the best t3 only. If no flip works
+   * at the first level, we try the alternate first step of [LK73],
+   * i.e., the 3-opt moves that are not preceded by a 2-opt move.
+   * So the result is at least 3-opt w.r.t. the neighbor lists.
+   *
+   * The don't-look bits work as in NeighborListTwoOptFinder.
+   *
+   * @note \p solve uses (and clears) the journal of the tour.
+   *
+   * @ref [LK73] Lin, S., & Kernighan, B. W. (1973). An effective heuristic
+   *      algorithm for the traveling-salesman problem.
+   *      Operations Research, 21(2), 498-516.
+   * @see Johnson, D. S., & McGeoch, L. A. (1997). The traveling salesman
+   *      problem: A case study in local optimization.
+   */
+  template <typename CostTy>
+  class LinKernighan
+  {
+  public:
+    /// @param numNeighbors K, will be capped at N-1.
+    /// @param maxDepth the max. number of steps (i.e., flips) per move
+    LinKernighan(
+      const AbstractCompGraph<CostTy> &g, size_t numNeighbors = 8,
+      size_t maxDepth = 50);
+
+    /// @brief reuse some prebuilt neighbor lists
+    /// @param candidates each row must be sorted in ascending edge cost
+    LinKernighan(const CandidateSet<CostTy> &candidates, size_t maxDepth = 50);
+
+    const CandidateSet<CostTy>& getCandidates() const
+    {
+      return m_candidates;
+    }
+    size_t maxDepth() const
+    {
+      return m_maxDepth;
+    }
+
+    /// @brief process the don't-look-bit queue until it becomes empty
+    /// @param tour must be Hamiltonian
+    /// @param stop (optional) checked per queued vertex,
+    ///        a round is a pass of the queue
+    LocalSearchOutcome<CostTy> solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      StopCriterion<CostTy> *stop = nullptr);
+
+    /// @brief try to improve the tour by one move that removes t1-t2
+    /// @param vT2 either next(t1) or prev(t1)
+    /// @retval the improvement, the tour is unchanged if it's 0
+    AccumTy<CostTy> improveFrom(
+      AbstractTour &tour, size_t vT1, size_t vT2, const AbstractCompGraph<CostTy> &g);
+
+  protected:
+    // the actual implementations on the concrete tour and graph types,
+    // see internal::visitConcreteGraph
+    template <typename TourTy, typename GraphTy>
+    LocalSearchOutcome<CostTy> solve_(TourTy &tour, const GraphTy &g, StopCriterion<CostTy> *stop);
+    template <typename TourTy, typename GraphTy>
+    AccumTy<CostTy> improveFrom_(TourTy &tour, size_t vT1, size_t vT2, const GraphTy &g);
+    // one step (and recursively the deeper ones),
+    // with the closing edge t1-t2 and the partial gain gOpen
+    // @retval whether an improvement is found
+    //         (i.e., m_bestGain > 0 and the tour continues from there)
+    template <typename TourTy, typename GraphTy>
+    bool step_(
+      TourTy &tour, size_t vT1, size_t vT2, AccumTy<CostTy> gOpen,
+      size_t depth, const GraphTy &g);
+    // the alternate first step of [LK73] if the flips don't improve:
+    // t4 = the other neighbor of t3, i.e., t4-t1 can't close the tour,
+    // then t5-t6 is chosen such that t6-t1 can (a 3-opt move
+    // without a 2-opt one in between, see ThreeOptFinder)
+    // @param view the tour in the direction of t1 -> t2
+    template <typename TourTy, typename ViewTy, typename GraphTy>
+    bool alternateFirstStep_(
+      TourTy &tour, ViewTy &view, size_t vT1, size_t vT2, const GraphTy &g);
+    // whether t3-t4 has been added by the current move
+    bool isAdded(size_t vT3, size_t vT4) const;
+
+    // a candidate of a step, i.e., (t3, t4), or (t5, t6) in the alternate one
+    struct Alternative
+    {
+      AccumTy<CostTy> gOpen; // after the step
+      size_t vX;
+      size_t vY;
+    };
+    // the alternatives of the first two levels (to avoid allocations)
+    std::array<std::vector<Alternative>, 2> m_alternatives;
+
+    // the neighbor lists (with the edge costs inline)
+    CandidateSet<CostTy> m_candidates;
+    const size_t m_maxDepth;
+    // the don't-look bits
+    internal::ActiveQueue m_queue;
+
+    // the state of the current move
+    AccumTy<CostTy> m_bestGain = 0;
+    size_t m_bestJournalSize = 0;
+    std::vector<std::pair<size_t, size_t>> m_added;
+    // the endpoints of the flips (to requeue)
+    std::vector<size_t> m_touched;
+  };
+}
+
+#endif
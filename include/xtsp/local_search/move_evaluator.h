@@ -0,0 +1,169 @@
+#ifndef __XTSP_MOVE_EVALUATOR_H__
+#define __XTSP_MOVE_EVALUATOR_H__
+
+#include "xtsp/core/tour.h"
+#include "xtsp/core/candidate_set.h"
+#include "xtsp/algorithm_utils/work_buffer.h"
+#include "xtsp/algorithm_utils/local_search_outcome.h"
+#include "xtsp/algorithm_utils/stop_criterion.h"
+
+#include <array>
+#include <vector>
+
+namespace xtsp::algo
+{
+  /// @brief the neighborhoods of MoveEvaluator, all w.r.t. the neighbor lists
+  enum NeighborhoodOperator
+  {
+    kTwoOptOperator,       // {A, B}, {C, D} -> {A, C}, {B, D}
+    kTwoHOptOperator,      // 2-opt, or one of A, B, C, D relocated along A-C
+    kNodeSwapOperator,     // X and Y trade places, Y next to a neighbor of X
+    kNodeInsertionOperator // X goes next to one of its neighbors
+  };
+
+  /// @brief the tour modification that a proposal boils down to
+  enum ElementaryMove
+  {
+    kExchangeEdges,  // v = {A, B, C, D}, see NeighborhoodOperator
+    kRelocateVertex, // v = {X, P}, i.e., X goes right after P
+    kSwapVertices    // v = {X, Y}
+  };
+
+  template <typename CostTy>
+  struct MoveProposal
+  {
+  public:
+    AccumTy<CostTy> improvement = 0; // this default value is important
+    ElementaryMove type = kExchangeEdges;
+    std::array<size_t, 4> v{};
+  public:
+    /// @retval is the new improvement accepted?
+    bool updateIfBetter(
+      AccumTy<CostTy> newImprovement, ElementaryMove type_new,
+      const std::array<size_t, 4> &v_new)
+    {
+      if (newImprovement > this->improvement)
+      {
+        this->improvement = newImprovement;
+        this->type = type_new;
+        this->v = v_new;
+        return true;
+      }
+      return false;
+    }
+    bool isValid() const
+    {
+      return (improvement > 0);
+    }
+  };
+
+  /**
+   * @brief the simple neighborhoods behind one neighbor-list search
+   *
+   * Each NeighborhoodOperator only evaluates the moves that add
+   * the edge X-C for C among the K nearest neighbors of X.
+   * Everything else is shared:
+   *  * the scan of the neighbor list, which stops as soon as X-C
+   *    is too long for the operator (e.g., longer than both
+   *    tour edges of X for 2-opt),
+   *  * the don't-look bits (as in NeighborListTwoOptFinder),
+   *  * the application of a proposal, i.e., an ElementaryMove
+   *    via \p exchangeTwoEdges or \p moveSegment . So a move can be undone
+   *    with the journal of the tour (see AbstractTour::checkpoint).
+   *
+   * The operators are compile-time policies (see
+   * src/toolbox/move_operators.h), so each one gets its own
+   * inlined, allocation-free copy of the search loop.
+   *
+   * \p variableNeighborhoodDescent chains them: the next operator
+   * is tried only when the current one is exhausted, and any improvement
+   * restarts from the first one (so list the cheap ones first).
+   *
+   * Symmetric graphs only, see AsymmetricTwoOptFinder otherwise.
+   *
+   * @ref Mladenović, N., & Hansen, P. (1997). Variable neighborhood search.
+   *      Computers & Operations Research, 24(11), 1097-1100.
+   * @ref Bentley, J. J. (1992). Fast algorithms for geometric traveling
+   *      salesman problems. ORSA Journal on Computing, 4(4), 387-411.
+   *      (2h-opt)
+   */
+  template <typename CostTy>
+  class MoveEvaluator
+  {
+  public:
+    /// @param numNeighbors K, will be capped at N-1.
+    MoveEvaluator(const AbstractCompGraph<CostTy> &g, size_t numNeighbors = 8);
+
+    /// @brief reuse some prebuilt neighbor lists
+    /// @param candidates each row must be sorted in ascending edge cost
+    MoveEvaluator(const CandidateSet<CostTy> &candidates);
+
+    const CandidateSet<CostTy>& getCandidates() const
+    {
+      return m_candidates;
+    }
+
+    /// @brief For a given vertex X, find a move of the operator
+    ///        that adds an edge X-C.
+    ///
+    /// Complexity: O(K)
+    MoveProposal<CostTy> queryMoveGivenX(
+      const AbstractTour &tour, size_t vX, NeighborhoodOperator op,
+      const AbstractCompGraph<CostTy> &g, bool firstImprovement = true) const;
+
+    /// @brief perform a (valid) move found by \p queryMoveGivenX
+    ///        on the same tour
+    static void applyMove(AbstractTour &tour, const MoveProposal<CostTy> &move);
+
+    /// @brief process the don't-look-bit queue with one operator
+    ///        until it becomes empty
+    /// @param tour must be Hamiltonian
+    /// @param stop (optional) checked per queued vertex,
+    ///        a round is a pass of the queue
+    LocalSearchOutcome<CostTy> solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      NeighborhoodOperator op, bool firstImprovement = true,
+      StopCriterion<CostTy> *stop = nullptr);
+
+    /// @brief \p solve with each operator in turn, restarting from
+    ///        the first one after any improvement
+    /// @param stop (optional) one run across all the operators, i.e.,
+    ///        a round is a pass of the queue of any operator, so a
+    ///        stagnation window and the reported costs span the operators
+    /// @retval the confirmed local optimum w.r.t. all the operators
+    ///         (unless \p stop stopped it early)
+    LocalSearchOutcome<CostTy> variableNeighborhoodDescent(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      const std::vector<NeighborhoodOperator> &ops, bool firstImprovement = true,
+      StopCriterion<CostTy> *stop = nullptr);
+
+  protected:
+    // throws std::invalid_argument if the tour or the graph doesn't fit
+    void checkInputs_(const AbstractTour &tour, const AbstractCompGraph<CostTy> &g) const;
+    // \p solve without (re)starting the run of \p stop
+    LocalSearchOutcome<CostTy> solveFromHere_(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      NeighborhoodOperator op, bool firstImprovement,
+      StopCriterion<CostTy> *stop);
+
+    // the actual implementations on the concrete operator, tour and graph types,
+    // see internal::visitConcreteGraph
+    template <typename OperatorTy, typename TourTy, typename GraphTy>
+    MoveProposal<CostTy> queryMoveGivenX_(
+      const TourTy &tour, size_t vX, const GraphTy &g,
+      bool firstImprovement) const;
+    template <typename TourTy>
+    static void applyMove_(TourTy &tour, const MoveProposal<CostTy> &move);
+    template <typename OperatorTy, typename TourTy, typename GraphTy>
+    LocalSearchOutcome<CostTy> solve_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement,
+      StopCriterion<CostTy> *stop);
+
+    // the neighbor lists (with the edge costs inline)
+    CandidateSet<CostTy> m_candidates;
+    // the don't-look bits
+    internal::ActiveQueue m_queue;
+  };
+}
+
+#endif
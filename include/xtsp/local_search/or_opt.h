@@ -0,0 +1,138 @@
+#ifndef __XTSP_OR_OPT_H__
+#define __XTSP_OR_OPT_H__
+
+#include "xtsp/core/tour.h"
+#include "xtsp/core/candidate_set.h"
+#include "xtsp/algorithm_utils/work_buffer.h"
+#include "xtsp/algorithm_utils/local_search_outcome.h"
+#include "xtsp/algorithm_utils/stop_criterion.h"
+
+namespace xtsp::algo
+{
+  /// @brief an Or-opt move, i.e., the arguments of AbstractTour::moveSegment
+  template <typename CostTy>
+  struct OrOptQueryResults
+  {
+  public:
+    AccumTy<CostTy> improvement = 0; // this default value is important
+    size_t vS1 = 0; // the segment S1 -> ... -> S2
+    size_t vS2 = 0;
+    size_t vP = 0;  // to be moved after P
+    bool reversed = false;
+  public:
+    /// @retval is the new improvement accepted?
+    bool updateIfBetter(
+      AccumTy<CostTy> newImprovement,
+      size_t vS1_new, size_t vS2_new, size_t vP_new, bool reversed_new)
+    {
+      if (newImprovement > this->improvement)
+      {
+        this->improvement = newImprovement;
+        this->vS1 = vS1_new;
+        this->vS2 = vS2_new;
+        this->vP = vP_new;
+        this->reversed = reversed_new;
+        return true;
+      }
+      return false;
+    }
+    bool isValid() const
+    {
+      return (improvement > 0);
+    }
+  };
+
+  /**
+   * @brief Or-opt restricted to neighbor lists and driven by don't-look bits
+   *
+   * An Or-opt move relocates a segment of (typically) 1 to 3 consecutive
+   * vertices elsewhere in the tour, possibly reversed [Or76].
+   * It is a special case of 3-opt, with only O(N) moves per segment
+   * length instead of O(N^2).
+   *
+   * Given a segment S1 -> ... -> S2 between O and N, we only try
+   * the insertions that make S1 or S2 adjacent to one of its K nearest
+   * neighbors, and stop as soon as that new edge is no shorter than
+   * the gain of removing the segment, i.e.,
+   * cost(O,S1) + cost(S2,N) - cost(O,N) (the positive gain criterion).
+   *
+   * The don't-look bits work as in NeighborListTwoOptFinder:
+   * a vertex is requeued only if one of its tour edges changes,
+   * and all vertices are reactivated once the queue runs dry.
+   *
+   * @ref [Or76] Or, I. (1976). Traveling salesman-type combinatorial
+   *      problems and their relation to the logistics of regional
+   *      blood banking. PhD thesis, Northwestern University.
+   * @see NeighborListTwoOptFinder
+   */
+  template <typename CostTy>
+  class NeighborListOrOptFinder
+  {
+  public:
+    /// @param numNeighbors K, will be capped at N-1.
+    /// @param maxSegmentLength the segments have 1, ..., this many vertices
+    NeighborListOrOptFinder(
+      const AbstractCompGraph<CostTy> &g, size_t numNeighbors = 8,
+      size_t maxSegmentLength = 3);
+
+    /// @brief reuse some prebuilt neighbor lists
+    /// @param candidates each row must be sorted in ascending edge cost
+    NeighborListOrOptFinder(
+      const CandidateSet<CostTy> &candidates, size_t maxSegmentLength = 3);
+
+    const CandidateSet<CostTy>& getCandidates() const
+    {
+      return m_candidates;
+    }
+    size_t maxSegmentLength() const
+    {
+      return m_maxSegLen;
+    }
+
+    /// @brief For a given vertex X, find an Or-opt move of
+    ///        a segment that begins or ends at X.
+    ///
+    /// To apply it, call
+    /// tour.moveSegment(res.vS1, res.vS2, res.vP, res.reversed).
+    ///
+    /// Complexity: O(K L) where L is the max. segment length
+    OrOptQueryResults<CostTy> queryMoveGivenX(
+      const AbstractTour &tour, size_t vX, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement = true) const;
+
+    /// @brief process the don't-look-bit queue until it becomes empty
+    /// @param tour must be Hamiltonian
+    /// @param stop (optional) checked per queued vertex,
+    ///        a round is a pass of the queue
+    LocalSearchOutcome<CostTy> solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement = true,
+      StopCriterion<CostTy> *stop = nullptr);
+
+  protected:
+    // the actual implementations on the concrete tour and graph types,
+    // see internal::visitConcreteGraph
+    template <typename TourTy, typename GraphTy>
+    OrOptQueryResults<CostTy> queryMoveGivenX_(
+      const TourTy &tour, size_t vX, const GraphTy &g,
+      bool firstImprovement) const;
+    // try all the insertions of the segment S1 -> ... -> S2 near
+    // the neighbors of S1 and S2
+    template <typename TourTy, typename GraphTy>
+    bool querySegment_(
+      const TourTy &tour, size_t vS1, size_t vS2, const GraphTy &g,
+      bool firstImprovement, OrOptQueryResults<CostTy> &res) const;
+    template <typename TourTy, typename GraphTy>
+    LocalSearchOutcome<CostTy> solve_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement,
+      StopCriterion<CostTy> *stop);
+
+    // the neighbor lists (with the edge costs inline)
+    CandidateSet<CostTy> m_candidates;
+    const size_t m_maxSegLen;
+    // the don't-look bits
+    internal::ActiveQueue m_queue;
+  };
+}
+
+#endif
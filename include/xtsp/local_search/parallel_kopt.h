@@ -0,0 +1,89 @@
+#ifndef __XTSP_PARALLEL_KOPT_H__
+#define __XTSP_PARALLEL_KOPT_H__
+
+#include "xtsp/core/tour.h"
+#include "xtsp/algorithm_utils/thread_pool.h"
+#include "xtsp/local_search/kopt.h"
+
+#include <map>
+#include <vector>
+
+namespace xtsp::algo
+{
+  /**
+   * @brief best-improvement 2-opt, evaluated on a thread pool
+   *
+   * Each sweep works in three steps:
+   *  1. take a snapshot of the tour in rank order (with its edge costs);
+   *  2. for each tour edge, find its best improving 2-opt partner
+   *     among the later edges of the snapshot, i.e., the full O(N^2)
+   *     neighborhood (as \p find2OptMoveGivenA ), split across the threads;
+   *  3. select the moves greedily by descending improvement, such that
+   *     their rank ranges (from the first removed edge to the second)
+   *     don't overlap, and apply them in one batch.
+   *
+   * The moves of a batch don't interfere with each other,
+   * so the improvement of the batch is the sum of theirs.
+   * Step 2 dominates for large instances, and it has no shared
+   * writes, so it scales with the number of threads. Steps 1 and 3
+   * are O(N log N) on the calling thread.
+   *
+   * A move-free sweep confirms 2-opt (w.r.t. the full neighborhood).
+   *
+   * @see PriorityTwoOptFinder for the sequential counterpart
+   */
+  template <typename CostTy>
+  class ParallelTwoOptFinder
+  {
+  public:
+    /// @param numThreads including the calling thread,
+    ///        0 means std::thread::hardware_concurrency()
+    explicit ParallelTwoOptFinder(size_t numThreads = 0);
+
+    size_t numThreads() const
+    {
+      return m_pool.numThreads();
+    }
+
+    /// @brief sweep until no move is found or \p maxNumSweeps is reached
+    /// @param tour all its vertices are considered, i.e., it may be partial
+    /// @param stop (optional) checked between the sweeps (a sweep is a round)
+    TwoOptOutcome<CostTy> solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      size_t maxNumSweeps = 1000,
+      StopCriterion<CostTy> *stop = nullptr);
+
+    /// @brief one snapshot, evaluation, and batch of moves
+    TwoOptOutcome<CostTy> tryOneSweep(AbstractTour &tour, const AbstractCompGraph<CostTy> &g);
+
+  protected:
+    // the best move removing the edges at rankA and rankC,
+    // i.e., seq[rankA] -> seq[rankA + 1] and seq[rankC] -> seq[rankC + 1]
+    struct RankedMove
+    {
+      AccumTy<CostTy> improvement = 0;
+      size_t rankA = 0;
+      size_t rankC = 0;
+    };
+
+    template <typename TourTy, typename GraphTy>
+    TwoOptOutcome<CostTy> tryOneSweep_(TourTy &tour, const GraphTy &g);
+    // step 2 for the edge at rankA (run by the threads)
+    template <typename GraphTy>
+    RankedMove findBestPartner_(size_t rankA, const GraphTy &g) const;
+    // step 3, the selected moves end up in m_batch
+    void selectNonOverlappingMoves_();
+
+    internal::ThreadPool m_pool;
+    // the snapshot, m_seq[N] = m_seq[0] to close the tour
+    std::vector<size_t> m_seq;
+    std::vector<CostTy> m_edgeCosts;
+    // indexed by rankA (written by the threads, one entry each)
+    std::vector<RankedMove> m_bestMoves;
+    std::vector<RankedMove> m_batch;
+    // the rank ranges taken by the batch, i.e., rankA -> rankC
+    std::map<size_t, size_t> m_takenRanges;
+  };
+}
+
+#endif
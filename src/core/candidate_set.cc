@@ -0,0 +1,106 @@
+#include "xtsp/core/candidate_set.h"
+
+#include <algorithm>
+#include <exception>
+#include <type_traits>
+#include <spdlog/spdlog.h>
+
+namespace xtsp
+{
+  template <typename CostTy>
+  CandidateSet<CostTy>::CandidateSet(
+    std::vector<size_t>&& offsets, std::vector<Entry>&& entries)
+    : m_offsets(std::move(offsets)), m_entries(std::move(entries))
+  {
+    if (m_offsets.size() < 2)
+      throw std::invalid_argument("CandidateSet ctor: there must be at least one vertex");
+    if (m_offsets.front() != 0 || m_offsets.back() != m_entries.size())
+      throw std::invalid_argument("CandidateSet ctor: the offsets don't match the entries");
+    for (size_t v = 0; v < numVertices(); ++v)
+    {
+      if (m_offsets[v+1] < m_offsets[v])
+        throw std::invalid_argument("CandidateSet ctor: the offsets must be non-decreasing");
+      m_maxK = std::max(m_maxK, numCandidates(v));
+    }
+  }
+
+  template <typename CostTy>
+  CandidateSet<CostTy> CandidateSet<CostTy>::fromGraphBruteForce(
+    const AbstractCompGraph<CostTy>& g, size_t numNeighbors)
+  {
+    const size_t numV = g.numVertices();
+    const size_t K = std::min(numNeighbors, numV - 1);
+
+    std::vector<size_t> offsets(numV + 1);
+    std::vector<Entry> entries;
+    entries.reserve(numV*K);
+    // work buffer: (cost, vertex ID) of all other vertices
+    std::vector<std::pair<CostTy, size_t>> row;
+    row.reserve(numV);
+    for (size_t v = 0; v < numV; ++v)
+    {
+      row.clear();
+      for (size_t u = 0; u < numV; ++u)
+      {
+        if (u != v)
+          row.emplace_back(g.getEdgeCost(v, u), u);
+      }
+      // ties are broken by the vertex ID
+      std::partial_sort(row.begin(), row.begin() + K, row.end());
+      for (size_t k = 0; k < K; ++k)
+        entries.emplace_back(Entry{row[k].second, row[k].first});
+      offsets[v+1] = entries.size();
+    }
+    return CandidateSet<CostTy>(std::move(offsets), std::move(entries));
+  }
+
+  template <typename CostTy>
+  CandidateSet<CostTy> CandidateSet<CostTy>::fromGraph(
+    const CompleteGraph<CostTy>& g, size_t numNeighbors)
+  {
+    return fromGraphBruteForce(g, numNeighbors);
+  }
+
+  template <typename CostTy>
+  CandidateSet<CostTy> CandidateSet<CostTy>::fromGraph(
+    const AbstractCompGraph<CostTy>& g, size_t numNeighbors)
+  {
+    if (g.numVertices() < 2)
+      throw std::invalid_argument("CandidateSet::fromGraph: the graph is too small");
+    if (numNeighbors == 0)
+      throw std::invalid_argument("CandidateSet::fromGraph: numNeighbors must be positive");
+
+    // the K-d tree only exists for a floating-point point set
+    if constexpr (std::is_floating_point_v<CostTy>)
+    {
+      auto gPts = dynamic_cast<const ImplicitCompleteGraph<CostTy>*>(&g);
+      if (gPts != nullptr)
+      {
+        const size_t numV = g.numVertices();
+        std::vector<size_t> nnIds;
+        const size_t K = gPts->getKdTree().kNearestAll(numNeighbors, nnIds);
+        std::vector<size_t> offsets(numV + 1);
+        std::vector<Entry> entries(numV*K);
+        for (size_t v = 0; v < numV; ++v)
+        {
+          for (size_t k = 0; k < K; ++k)
+          {
+            const size_t u = nnIds[v*K + k];
+            entries[v*K + k] = Entry{u, g.getEdgeCost(v, u)};
+          }
+          offsets[v+1] = (v+1)*K;
+        }
+        SPDLOG_DEBUG("Built {:d} candidates per vertex via the K-d tree", K);
+        return CandidateSet<CostTy>(std::move(offsets), std::move(entries));
+      }
+    }
+    return fromGraphBruteForce(g, numNeighbors);
+  }
+
+  // explicit instantiation
+  template class CandidateSet<float>;
+  template class CandidateSet<int>;
+  template class CandidateSet<uint16_t>;
+  template class CandidateSet<int16_t>;
+  template class CandidateSet<uint32_t>;
+} // namespace xtsp
@@ -8,13 +8,23 @@
 
 namespace xtsp
 {
-  Clustering::Clustering(size_t numVertices, const std::vector<std::vector<size_t>>& membership) 
-    : m_n(numVertices), m_c2v(membership) 
+  template <typename IdxTy>
+  BasicClustering<IdxTy>::BasicClustering(
+    size_t numVertices, const std::vector<std::vector<size_t>>& membership) 
+    : m_n(numVertices)
   {
     if (numVertices == 0)
     {
       throw std::invalid_argument("It makes no sense to partition an empty graph");
     }
+    // (the max. value is reserved as "unassigned")
+    if (numVertices >= std::numeric_limits<IdxTy>::max())
+    {
+      throw std::invalid_argument("Too many vertices for the index type of the clustering");
+    }
+    m_c2v.reserve(membership.size());
+    for (const auto& members : membership)
+      m_c2v.emplace_back(members.cbegin(), members.cend());
     postInit();
   };
 
@@ -30,11 +40,12 @@ namespace xtsp
   //   postInit();
   // }
 
-  void Clustering::postInit()
+  template <typename IdxTy>
+  void BasicClustering<IdxTy>::postInit()
   {
     // we need random access so we need to initialize it now
-    size_t uninitializedVal = std::numeric_limits<size_t>::max();
-    m_v2c = std::vector<size_t> (this->m_n, uninitializedVal);
+    const IdxTy uninitializedVal = std::numeric_limits<IdxTy>::max();
+    m_v2c = std::vector<IdxTy> (this->m_n, uninitializedVal);
 
     // ii = cluster index
     for (size_t ii = 0; ii < this->numClusters(); ++ii)
@@ -57,7 +68,7 @@ namespace xtsp
             globalVertexId);
           throw std::invalid_argument(errMsg);
         }
-        size_t& v2cEntry = m_v2c[globalVertexId];
+        IdxTy& v2cEntry = m_v2c[globalVertexId];
         if (v2cEntry != uninitializedVal)
         {
           std::string errMsg = spdlog::fmt_lib::format(
@@ -83,12 +94,14 @@ namespace xtsp
     }
   }
 
-  size_t Clustering::getClusterSize(size_t clusterId) const
+  template <typename IdxTy>
+  size_t BasicClustering<IdxTy>::getClusterSize(size_t clusterId) const
   {
     return m_c2v[clusterId].size();
   }
 
-  size_t Clustering::evalWhichHasTheLeastVertices() const
+  template <typename IdxTy>
+  size_t BasicClustering<IdxTy>::evalWhichHasTheLeastVertices() const
   {
     size_t minSoFar = std::numeric_limits<size_t>::max();
     for (size_t i = 0; i < numClusters(); ++i)
@@ -104,7 +117,8 @@ namespace xtsp
     return minSoFar;
   }
 
-  Clustering Clustering::cumsum(const std::vector<size_t>& clustersSizes)
+  template <typename IdxTy>
+  BasicClustering<IdxTy> BasicClustering<IdxTy>::cumsum(const std::vector<size_t>& clustersSizes)
   {
     if (clustersSizes.empty())
       throw std::invalid_argument("clustersSizes should be non-empty");
@@ -128,6 +142,10 @@ namespace xtsp
       membership.emplace_back(members);
     }
     
-    return Clustering(head, std::move(membership));
+    return BasicClustering<IdxTy>(head, std::move(membership));
   }
+
+  // explicit template instantiation
+  template class BasicClustering<uint32_t>;
+  template class BasicClustering<size_t>;
 } // namespace xtsp
\ No newline at end of file
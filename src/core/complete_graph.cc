@@ -1,11 +1,15 @@
 #include "xtsp/core/complete_graph.h"
 
 #include <Eigen/Dense> // array ops
+#include <algorithm>
 #include <exception>
+#include <cmath>
+#include <limits>
 #include <spdlog/spdlog.h>
 #include <spdlog/fmt/bundled/format.h>
 
 #include "xtsp/core/tsplib_io.h"
+#include "../toolbox/cost_kernels.h"
 
 namespace xtsp
 {
@@ -27,6 +31,14 @@ namespace xtsp
     return !(m_clustering == nullptr);
   }
 
+  template <typename CostTy>
+  void AbstractCompGraph<CostTy>::getEdgeCosts(
+    size_t from, const size_t* to, size_t numTo, CostTy* out) const
+  {
+    for (size_t k = 0; k < numTo; ++k)
+      out[k] = getEdgeCost(from, to[k]);
+  }
+
   template <typename CostTy>
   CompleteGraph<CostTy>::CompleteGraph(
     bool isSymmetric, 
@@ -34,31 +46,74 @@ namespace xtsp
     const std::shared_ptr<Clustering> clustering)
     : AbstractCompGraph<CostTy>(clustering), 
       m_symmetric(isSymmetric),
-      m_mat(edgeCosts)
+      m_numV(edgeCosts.rows())
   {
-    if (m_mat.rows() != m_mat.cols())
+    if (edgeCosts.rows() != edgeCosts.cols())
     {
       throw std::invalid_argument("The edge cost matrix must be square!");
     }
 
-    // https://stackoverflow.com/questions/13403982/eigen-efficient-type-for-dense-symmetric-matrix
-    // somehow fail to compile
-    // m_mat = (m_symmetric) ? edgeCosts.selfadjointView<Eigen::Lower>() : edgeCosts;
     if (isSymmetric)
     {
-      // enforce symmetry 
-      // (by copying from the lower triangle to the upper triangle)
-      for (size_t i = 0; i < static_cast<size_t>(m_mat.rows()) - 1; ++i)
-        for (size_t j = i+1; j < static_cast<size_t>(m_mat.cols()); ++j)
-          m_mat(i,j) = m_mat(j,i);
+      // only keep the lower triangle
+      m_costs.reserve(m_numV*(m_numV+1)/2);
+      for (size_t i = 0; i < m_numV; ++i)
+        for (size_t j = 0; j <= i; ++j)
+          m_costs.emplace_back(edgeCosts(i,j));
+    }
+    else
+    {
+      m_costs.reserve(m_numV*m_numV);
+      for (size_t i = 0; i < m_numV; ++i)
+        for (size_t j = 0; j < m_numV; ++j)
+          m_costs.emplace_back(edgeCosts(i,j));
+    }
+    warnNegativeCosts();
+  }
+
+  template <typename CostTy>
+  CompleteGraph<CostTy>::CompleteGraph(
+    bool isSymmetric, 
+    size_t numVertices,
+    std::vector<CostTy>&& costs, 
+    const std::shared_ptr<Clustering> clustering)
+    : AbstractCompGraph<CostTy>(clustering), 
+      m_symmetric(isSymmetric),
+      m_numV(numVertices),
+      m_costs(std::move(costs))
+  {
+    const size_t expectedSize = isSymmetric 
+      ? numVertices*(numVertices+1)/2 : numVertices*numVertices;
+    if (m_costs.size() != expectedSize)
+    {
+      throw std::invalid_argument(fmt::format(
+        "Expect {:d} edge costs for N = {:d} but got {:d}", 
+        expectedSize, numVertices, m_costs.size()));
     }
+    warnNegativeCosts();
+  }
 
+  template <typename CostTy>
+  CompleteGraph<CostTy> CompleteGraph<CostTy>::fromPackedLowerTriangle(
+    size_t numVertices,
+    std::vector<CostTy>&& packedLowerTriangle,
+    const std::shared_ptr<Clustering> clustering)
+  {
+    return CompleteGraph<CostTy>(
+      true, numVertices, std::move(packedLowerTriangle), clustering);
+  }
+
+  template <typename CostTy>
+  void CompleteGraph<CostTy>::warnNegativeCosts() const
+  {
     /// check also if >= 0 ?
-    for (size_t i = 0; i < static_cast<size_t>(m_mat.rows()); ++i)
+    for (size_t i = 0; i < m_numV; ++i)
     {
-      for (size_t j = 0; j < static_cast<size_t>(m_mat.cols()); ++j)
+      // (only the lower triangle is stored if symmetric)
+      const size_t jEnd = m_symmetric ? i+1 : m_numV;
+      for (size_t j = 0; j < jEnd; ++j)
       {
-        if (m_mat(i,j) < static_cast<CostTy>(0))
+        if (getEdgeCost(i,j) < static_cast<CostTy>(0))
         {
           spdlog::warn(
             "The cost for edge {:d}->{:d} is negative. "
@@ -70,6 +125,26 @@ namespace xtsp
     }
   }
 
+  template <typename CostTy>
+  void CompleteGraph<CostTy>::getEdgeCosts(
+    size_t from, const size_t* to, size_t numTo, CostTy* out) const
+  {
+    if (m_symmetric)
+    {
+      // row "from" of the packed triangle covers all targets up to "from",
+      // beyond which we have to go down the column
+      const CostTy* row = m_costs.data() + from*(from+1)/2;
+      for (size_t k = 0; k < numTo; ++k)
+        out[k] = (to[k] <= from) ? row[to[k]] : m_costs[to[k]*(to[k]+1)/2 + from];
+    }
+    else
+    {
+      const CostTy* row = m_costs.data() + from*m_numV;
+      for (size_t k = 0; k < numTo; ++k)
+        out[k] = row[to[k]];
+    }
+  }
+
   template <typename CostTy>
   bool CompleteGraph<CostTy>::isSymmetric() const
   {
@@ -87,92 +162,27 @@ namespace xtsp
   {
     if (xy.cols() == 0)
       throw std::invalid_argument("xy data cannot be empty (e.g., having no column)");
-    if (normTy > 3 || normTy < 0)
+    if (normTy > 2 || normTy < 0)
       throw std::invalid_argument("norm type must be 0 or 1 or 2.");
     /// @todo perhaps preevaluate the cost for small-instance problems?
-    /// @todo precompute K-d tree
+    m_kdTree = std::make_shared<const KdTree<CostTy>>(m_xy, m_normType);
+  }
+
+  template <typename CostTy>
+  void ImplicitCompleteGraph<CostTy>::getEdgeCosts(
+    size_t from, const size_t* to, size_t numTo, CostTy* out) const
+  {
+    internal::pointDistances(
+      m_xy.data(), m_xy.rows(), m_xy.cols(), m_normType, from, to, numTo, out);
   }
 
   template <typename CostTy>
   ImplicitCompleteGraph<CostTy> ImplicitCompleteGraph<CostTy>::loadFromTsplibFile(
       const std::string& fpath)
   {
-    TsplibParser parser(fpath);
-    std::string errMsg;
-    std::string problemName = parser.seekLineAsString("NAME");
-    SPDLOG_INFO("Parsing tsplib file: NAME = {}", problemName);
-    std::string tspTypeStr = parser.seekLineAsString("TYPE");
-    SPDLOG_INFO("Parsing tsplib file: TYPE = {}", tspTypeStr);
-    enum TsplibFileType tspType = tsplibFileTypeFromString(tspTypeStr);
-    bool isGeneralized = false;
-    switch (tspType)
-    {
-      case TsplibFileType::kGTSP:
-        isGeneralized = true;
-        break;
-      case TsplibFileType::kTSP:
-        isGeneralized = false;
-        break;
-      default:
-        errMsg = fmt::format(
-          "TYPE {} is recognized but not compatible here.", tspTypeStr);
-        SPDLOG_ERROR(errMsg);
-        throw std::invalid_argument(errMsg);
-    }
-
-    int numVertices = parser.seekLineAsInt("DIMENSION");
-    SPDLOG_INFO("Parsing tsplib file: DIMENSION = {}", numVertices);
-    if (numVertices <= 0)
-      throw std::invalid_argument("Bad DIMENSION: should be a positive number");
-
-    int numClusters = 0;
-    if (isGeneralized)
-    {
-      numClusters = parser.seekLineAsInt("GTSP_SETS");
-      SPDLOG_INFO("Parsing tsplib file: GTSP_SETS = {}", numClusters);
-      if (numClusters < 2)
-        throw std::invalid_argument("Bad GTSP_SETS: should be at least 2");
-    }
-
-    size_t nDim = 0;
-    int normType = -100;
-    std::string edgeWeightTypeStr = parser.seekLineAsString("EDGE_WEIGHT_TYPE");
-    enum TsplibEdgeWeightType edgeWeightType 
-      = tsplibEdgeWeightTypeFromString(edgeWeightTypeStr);
-    switch (edgeWeightType)
-    {
-      case TsplibEdgeWeightType::kEUC_2D:
-        nDim = 2;
-        normType = 2;
-        break;
-      case TsplibEdgeWeightType::kEUC_3D:
-        nDim = 3;
-        normType = 2;
-        break;
-      case TsplibEdgeWeightType::kMAN_2D:
-        nDim = 2;
-        normType = 1;
-        break;
-      case TsplibEdgeWeightType::kMAN_3D:
-        nDim = 3;
-        normType = 1;
-        break;
-      default:
-        errMsg = fmt::format(
-          "EDGE_WEIGHT_TYPE {} is recognized but not compatible here.", edgeWeightTypeStr);
-        throw std::invalid_argument(errMsg);
-    }
-
-    Eigen::Matrix<CostTy,-1,-1> xy = parser.seekSectionAsFloat(
-      "NODE_COORD_SECTION", numVertices, nDim, true);
-    SPDLOG_INFO("Parsing tsplib file: successfully parsed the NODE_COORD_SECTION.");
-
-    std::shared_ptr<Clustering> clustering = nullptr;
-    if (isGeneralized)
-      clustering = parser.seekGtspSetSection(numClusters, numVertices);
-    
-    parser.expectReachedEof();
-    return ImplicitCompleteGraph(xy, clustering, normType);
+    TsplibPointSet pts = loadTsplibPointSet(fpath);
+    return ImplicitCompleteGraph(
+      pts.xy.template cast<CostTy>(), pts.clustering, pts.normType);
   }
 
   template <typename CostTy>
@@ -190,26 +200,105 @@ namespace xtsp
   template <typename CostTy>
   CompleteGraph<int> ImplicitCompleteGraph<CostTy>::explicitize(float scale) const
   {
-    if (numVertices() > 10000)
+    return explicitizeAs<int>(scale);
+  }
+
+  template <typename CostTy>
+  template <typename IntTy>
+  CompleteGraph<IntTy> ImplicitCompleteGraph<CostTy>::explicitizeAs(float scale) const
+  {
+    const size_t numV = numVertices();
+    const size_t numStored = numV*(numV+1)/2;
+    if (numV > 50000)
       SPDLOG_WARN(
-        "You are trying to create a N x N matrix with large N > 10000. "
-        "The conversion may fail due to limited memory.");
+        "You are trying to precompute {:d} edge costs ({:.1f} GiB) for N = {:d}. "
+        "The conversion may fail due to limited memory.",
+        numStored, numStored*sizeof(IntTy)/(1024.*1024.*1024.), numV);
     if (scale < 1)
       SPDLOG_WARN(
-        "you choose scale = {:.f} but you probably want e.g., scale >= 100", scale);
+        "you choose scale = {:f} but you probably want e.g., scale >= 100", scale);
 
-    Eigen::Matrix<int, -1, -1> costMat(numVertices(), numVertices());
-    costMat.diagonal().setZero();
-    for (int i = 0; i < (int)numVertices(); ++i)
-      for (int j = 0; j < i; ++j)
+    // rounding as in nint but without going through int
+    const double maxVal = std::numeric_limits<IntTy>::max();
+    const double minVal = std::numeric_limits<IntTy>::lowest();
+    auto roundAndCheck = [&](size_t i, size_t j)
+    {
+      const double rounded = std::floor(scale * getEdgeCost(i,j) + 0.5);
+      if (rounded > maxVal || rounded < minVal)
       {
-        int e = nint(scale * getEdgeCost(i,j));
-        costMat(i,j) = e; // the lower triangle
-        costMat(j,i) = e; // the upper triangle
+        std::string errMsg = fmt::format(
+          "explicitize: the cost of edge {:d}-{:d} is {} after scaling, "
+          "which doesn't fit in the chosen integer type (range: [{}, {}])",
+          i, j, rounded, minVal, maxVal);
+        SPDLOG_ERROR(errMsg);
+        throw std::invalid_argument(errMsg);
       }
-    return CompleteGraph<int>(true, costMat, this->m_clustering);    
+      return static_cast<IntTy>(rounded);
+    };
+
+    // the packed lower triangle, row by row
+    std::vector<IntTy> costs(numStored);
+    size_t idx = 0;
+    for (size_t i = 0; i < numV; ++i)
+    {
+      for (size_t j = 0; j < i; ++j)
+        costs[idx++] = roundAndCheck(i, j);
+      costs[idx++] = 0; // the diagonal
+    }
+    return CompleteGraph<IntTy>::fromPackedLowerTriangle(
+      numV, std::move(costs), this->m_clustering);
+  }
+
+  template <typename CostTy>
+  NarrowCompleteGraph ImplicitCompleteGraph<CostTy>::explicitizeNarrowest(float scale) const
+  {
+    const double maxScaledCost = std::floor(scale*(double)upperBoundEdgeCost() + 0.5);
+    if (maxScaledCost <= std::numeric_limits<uint16_t>::max())
+    {
+      SPDLOG_INFO("explicitize: using uint16_t (max. scaled cost <= {})", maxScaledCost);
+      return explicitizeAs<uint16_t>(scale);
+    }
+    if (maxScaledCost <= std::numeric_limits<uint32_t>::max())
+    {
+      SPDLOG_INFO("explicitize: using uint32_t (max. scaled cost <= {})", maxScaledCost);
+      return explicitizeAs<uint32_t>(scale);
+    }
+    std::string errMsg = fmt::format(
+      "explicitize: the scaled costs can be up to {}, too large even for uint32_t. "
+      "Consider a smaller scale than {}.", maxScaledCost, scale);
+    SPDLOG_ERROR(errMsg);
+    throw std::invalid_argument(errMsg);
   }
 
+  template <typename CostTy>
+  CostTy ImplicitCompleteGraph<CostTy>::upperBoundEdgeCost() const
+  {
+    // the extent of the bounding box, coordinate by coordinate
+    // (Eigen's min/max reductions trip a false -Wmaybe-uninitialized
+    // in GCC's AVX-512 intrinsics with -march=native)
+    CostTy sumSq = 0, sum = 0, maxExtent = 0;
+    for (Eigen::Index d = 0; d < m_xy.cols(); ++d)
+    {
+      CostTy lo = m_xy(0, d), hi = m_xy(0, d);
+      for (Eigen::Index i = 1; i < m_xy.rows(); ++i)
+      {
+        lo = std::min(lo, m_xy(i, d));
+        hi = std::max(hi, m_xy(i, d));
+      }
+      sumSq += (hi - lo)*(hi - lo);
+      sum += hi - lo;
+      maxExtent = std::max(maxExtent, hi - lo);
+    }
+    switch (m_normType)
+    {
+      case 2:
+        return std::sqrt(sumSq);
+      case 1:
+        return sum;
+      default: // maxNorm, aka. L_infinty
+        return maxExtent;
+    }
+  }
 
   template <typename CostTy>
   ImplicitCompleteGraph<CostTy> ImplicitCompleteGraph<CostTy>::buildClusterMeans() const
@@ -243,7 +332,20 @@ namespace xtsp
 
 
   // explicit instantiation
+  // (the base too, since other graphs such as PointGraph derive from it)
+  template class AbstractCompGraph<float>;
+  template class AbstractCompGraph<int>;
+  template class AbstractCompGraph<uint16_t>;
+  template class AbstractCompGraph<int16_t>;
+  template class AbstractCompGraph<uint32_t>;
   template class CompleteGraph<float>;
   template class CompleteGraph<int>;
+  template class CompleteGraph<uint16_t>;
+  template class CompleteGraph<int16_t>;
+  template class CompleteGraph<uint32_t>;
   template class ImplicitCompleteGraph<float>;
+  template CompleteGraph<int> ImplicitCompleteGraph<float>::explicitizeAs<int>(float) const;
+  template CompleteGraph<uint16_t> ImplicitCompleteGraph<float>::explicitizeAs<uint16_t>(float) const;
+  template CompleteGraph<int16_t> ImplicitCompleteGraph<float>::explicitizeAs<int16_t>(float) const;
+  template CompleteGraph<uint32_t> ImplicitCompleteGraph<float>::explicitizeAs<uint32_t>(float) const;
 } // namespace xtsp
\ No newline at end of file
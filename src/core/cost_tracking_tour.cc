@@ -0,0 +1,124 @@
+#include "xtsp/core/cost_tracking_tour.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+
+namespace xtsp
+{
+  template <typename CostTy>
+  CostTrackingTour<CostTy>::CostTrackingTour(
+    AbstractTour& tour, const AbstractCompGraph<CostTy>& g, size_t auditPeriod)
+    : m_tour(tour), m_graph(g), m_auditPeriod(auditPeriod)
+  {
+    if (tour.maxSize() != g.numVertices())
+      throw std::invalid_argument(
+        "[constructing a CostTrackingTour] tour is inconsistent with the graph");
+    m_cost = evalTour(tour, g);
+  }
+
+  template <typename CostTy>
+  void CostTrackingTour<CostTy>::exchangeTwoEdges(size_t vA, size_t vC, bool strict)
+  {
+    const size_t vB = m_tour.next(vA);
+    const size_t vD = m_tour.next(vC);
+    const auto& g = m_graph;
+    AccumTy<CostTy> delta =
+        static_cast<AccumTy<CostTy>>(g.getEdgeCost(vA, vC)) + g.getEdgeCost(vB, vD)
+      - g.getEdgeCost(vA, vB) - g.getEdgeCost(vC, vD);
+    if (!g.isSymmetric())
+    {
+      // the path B -> ... -> C becomes C -> ... -> B
+      for (size_t v = vB; v != vC; v = m_tour.next(v))
+      {
+        const size_t vNext = m_tour.next(v);
+        delta += static_cast<AccumTy<CostTy>>(g.getEdgeCost(vNext, v)) - g.getEdgeCost(v, vNext);
+      }
+      strict = true;
+    }
+    recordFlip(vA, vB, vC, vD);
+    m_tour.exchangeTwoEdges(vA, vC, strict);
+    m_cost += delta;
+    countMove();
+  }
+
+  template <typename CostTy>
+  void CostTrackingTour<CostTy>::moveSegment(
+    size_t vS1, size_t vS2, size_t vP, bool reversed)
+  {
+    const size_t vO = m_tour.prev(vS1);
+    if (vP == vO)
+    {
+      // a flip in place (through this->exchangeTwoEdges)
+      AbstractTour::moveSegment(vS1, vS2, vP, reversed);
+      return;
+    }
+    const size_t vN = m_tour.next(vS2);
+    const size_t vQ = m_tour.next(vP);
+    const auto& g = m_graph;
+    const size_t vFirst = reversed ? vS2 : vS1;
+    const size_t vLast = reversed ? vS1 : vS2;
+    AccumTy<CostTy> delta =
+        static_cast<AccumTy<CostTy>>(g.getEdgeCost(vO, vN)) 
+      + g.getEdgeCost(vP, vFirst) + g.getEdgeCost(vLast, vQ)
+      - g.getEdgeCost(vO, vS1) - g.getEdgeCost(vS2, vN) - g.getEdgeCost(vP, vQ);
+    if (reversed && !g.isSymmetric())
+    {
+      for (size_t v = vS1; v != vS2; v = m_tour.next(v))
+      {
+        const size_t vNext = m_tour.next(v);
+        delta += static_cast<AccumTy<CostTy>>(g.getEdgeCost(vNext, v)) - g.getEdgeCost(v, vNext);
+      }
+    }
+    m_tour.moveSegment(vS1, vS2, vP, reversed);
+    recordSegmentMove(vS1, vS2, vO, reversed);
+    m_cost += delta;
+    countMove();
+  }
+
+  template <typename CostTy>
+  void CostTrackingTour<CostTy>::countMove()
+  {
+    if (m_auditPeriod > 0 && ++m_numMovesSinceAudit >= m_auditPeriod)
+    {
+      m_numMovesSinceAudit = 0;
+      audit();
+    }
+  }
+
+  template <typename CostTy>
+  void CostTrackingTour<CostTy>::audit() const
+  {
+    const AccumTy<CostTy> reference = evalTour(m_tour, m_graph);
+    bool consistent = (reference == m_cost);
+    if constexpr (std::is_floating_point_v<CostTy>)
+    {
+      // the deltas accumulate rounding errors
+      const AccumTy<CostTy> tol = 1e-4*std::max<AccumTy<CostTy>>(1, std::abs(reference));
+      consistent = std::abs(reference - m_cost) <= tol;
+    }
+    if (!consistent)
+    {
+      SPDLOG_ERROR("CostTrackingTour: cached cost = {}, actual cost = {}", m_cost, reference);
+      throw std::logic_error(
+        "CostTrackingTour: the cached cost is inconsistent with the tour");
+    }
+  }
+
+  template <typename CostTy>
+  void CostTrackingTour<CostTy>::resync()
+  {
+    m_cost = evalTour(m_tour, m_graph);
+    m_numMovesSinceAudit = 0;
+  }
+
+  // explicit template instantiation
+  template class CostTrackingTour<float>;
+  template class CostTrackingTour<int>;
+  template class CostTrackingTour<uint16_t>;
+  template class CostTrackingTour<int16_t>;
+  template class CostTrackingTour<uint32_t>;
+}
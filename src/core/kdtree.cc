@@ -0,0 +1,337 @@
+#include "xtsp/core/kdtree.h"
+
+#include <algorithm>
+#include <numeric> // std::iota
+#include <cmath>
+#include <exception>
+#include <spdlog/spdlog.h>
+
+namespace xtsp
+{
+  template <typename CostTy>
+  KdTree<CostTy>::KdTree(
+    const Eigen::Matrix<CostTy, -1, -1>& xy,
+    int normType,
+    size_t leafSize)
+    : m_nDim(xy.cols()),
+      m_normType(normType),
+      m_leafSize(leafSize)
+  {
+    if (xy.rows() == 0 || xy.cols() == 0)
+      throw std::invalid_argument("KdTree ctor: the point set cannot be empty");
+    if (normType > 2 || normType < 0)
+      throw std::invalid_argument("norm type must be 0 or 1 or 2.");
+    if (leafSize == 0)
+      throw std::invalid_argument("KdTree ctor: leafSize must be positive");
+
+    const size_t numPts = xy.rows();
+    m_idx.resize(numPts);
+    std::iota(m_idx.begin(), m_idx.end(), 0);
+    m_leafOf.resize(numPts);
+    m_deleted = std::vector<bool>(numPts, false);
+    // a balanced tree has about 2N/leafSize nodes
+    m_nodes.reserve(2*(numPts/leafSize + 1));
+    build(0, numPts, 0, xy);
+
+    // copy the coordinates in the tree order
+    m_pts.resize(numPts*m_nDim);
+    m_pos.resize(numPts);
+    for (size_t rank = 0; rank < numPts; ++rank)
+    {
+      m_pos[m_idx[rank]] = rank;
+      for (size_t d = 0; d < m_nDim; ++d)
+        m_pts[rank*m_nDim + d] = xy(m_idx[rank], d);
+    }
+    SPDLOG_DEBUG("Built a K-d tree with {:d} nodes over {:d} points", m_nodes.size(), numPts);
+  }
+
+  template <typename CostTy>
+  size_t KdTree<CostTy>::build(
+    size_t begin, size_t end, size_t parent, const Eigen::Matrix<CostTy, -1, -1>& xy)
+  {
+    const size_t nodeId = m_nodes.size();
+    Node node;
+    node.begin = begin;
+    node.end = end;
+    node.numActive = end - begin;
+    node.parent = parent;
+    m_nodes.emplace_back(node);
+
+    if (end - begin <= m_leafSize)
+    {
+      for (size_t rank = begin; rank < end; ++rank)
+        m_leafOf[m_idx[rank]] = nodeId;
+      return nodeId;
+    }
+
+    // split along the dimension with the largest spread
+    size_t splitDim = 0;
+    CostTy maxSpread = -1;
+    for (size_t d = 0; d < m_nDim; ++d)
+    {
+      CostTy lo = std::numeric_limits<CostTy>::max();
+      CostTy hi = std::numeric_limits<CostTy>::lowest();
+      for (size_t rank = begin; rank < end; ++rank)
+      {
+        lo = std::min(lo, xy(m_idx[rank], d));
+        hi = std::max(hi, xy(m_idx[rank], d));
+      }
+      if (hi - lo > maxSpread)
+      {
+        maxSpread = hi - lo;
+        splitDim = d;
+      }
+    }
+
+    // split at the median
+    const size_t mid = begin + (end - begin)/2;
+    std::nth_element(
+      m_idx.begin() + begin, m_idx.begin() + mid, m_idx.begin() + end,
+      [&xy, splitDim](size_t lhs, size_t rhs)
+      {
+        return xy(lhs, splitDim) < xy(rhs, splitDim);
+      });
+
+    // (before the recursion reorders the points again)
+    const CostTy splitVal = xy(m_idx[mid], splitDim);
+
+    // the node might get relocated during the recursion
+    const size_t left = build(begin, mid, nodeId, xy);
+    const size_t right = build(mid, end, nodeId, xy);
+    m_nodes[nodeId].left = left;
+    m_nodes[nodeId].right = right;
+    m_nodes[nodeId].splitDim = splitDim;
+    m_nodes[nodeId].splitVal = splitVal;
+    return nodeId;
+  }
+
+  template <typename CostTy>
+  CostTy KdTree<CostTy>::reducedDist(const CostTy* p, const CostTy* q) const
+  {
+    CostTy acc = 0;
+    switch (m_normType)
+    {
+      case 2:
+        for (size_t d = 0; d < m_nDim; ++d)
+          acc += (p[d] - q[d])*(p[d] - q[d]);
+        break;
+      case 1:
+        for (size_t d = 0; d < m_nDim; ++d)
+          acc += std::abs(p[d] - q[d]);
+        break;
+      default: // maxNorm, aka. L_infinty
+        for (size_t d = 0; d < m_nDim; ++d)
+          acc = std::max(acc, std::abs(p[d] - q[d]));
+    }
+    return acc;
+  }
+
+  template <typename CostTy>
+  CostTy KdTree<CostTy>::reducedAxisDist(CostTy delta) const
+  {
+    return (m_normType == 2) ? delta*delta : std::abs(delta);
+  }
+
+  template <typename CostTy>
+  CostTy KdTree<CostTy>::unreduce(CostTy reduced) const
+  {
+    return (m_normType == 2) ? std::sqrt(reduced) : reduced;
+  }
+
+  template <typename CostTy>
+  CostTy KdTree<CostTy>::distance(size_t from, size_t to) const
+  {
+    return unreduce(reducedDist(
+      m_pts.data() + m_pos[from]*m_nDim, m_pts.data() + m_pos[to]*m_nDim));
+  }
+
+  ///////////////////////////////
+  //   k nearest neighbors
+  ///////////////////////////////
+
+  template <typename CostTy>
+  void KdTree<CostTy>::searchKNearest(
+    size_t nodeId, const CostTy* q, size_t vExclude, size_t k,
+    std::vector<Candidate>& heap) const
+  {
+    const Node& node = m_nodes[nodeId];
+    if (node.isLeaf())
+    {
+      for (size_t rank = node.begin; rank < node.end; ++rank)
+      {
+        if (m_idx[rank] == vExclude)
+          continue;
+        Candidate c(reducedDist(q, m_pts.data() + rank*m_nDim), m_idx[rank]);
+        if (heap.size() < k)
+        {
+          heap.emplace_back(c);
+          std::push_heap(heap.begin(), heap.end());
+        }
+        else if (c < heap.front())
+        {
+          std::pop_heap(heap.begin(), heap.end());
+          heap.back() = c;
+          std::push_heap(heap.begin(), heap.end());
+        }
+      }
+      return;
+    }
+    const CostTy delta = q[node.splitDim] - node.splitVal;
+    const size_t nearChild = (delta < 0) ? node.left : node.right;
+    const size_t farChild = (delta < 0) ? node.right : node.left;
+    searchKNearest(nearChild, q, vExclude, k, heap);
+    // "<=" so that ties are resolved by the point ID as promised
+    if (heap.size() < k || reducedAxisDist(delta) <= heap.front().first)
+      searchKNearest(farChild, q, vExclude, k, heap);
+  }
+
+  template <typename CostTy>
+  void KdTree<CostTy>::kNearest(size_t v, size_t k, std::vector<size_t>& out) const
+  {
+    out.clear();
+    k = std::min(k, numPoints() - 1);
+    if (k == 0)
+      return;
+    std::vector<Candidate> heap;
+    heap.reserve(k);
+    searchKNearest(0, m_pts.data() + m_pos[v]*m_nDim, v, k, heap);
+    std::sort_heap(heap.begin(), heap.end());
+    for (const auto& [dist, u] : heap)
+      out.emplace_back(u);
+  }
+
+  template <typename CostTy>
+  size_t KdTree<CostTy>::kNearestAll(size_t k, std::vector<size_t>& out) const
+  {
+    const size_t numPts = numPoints();
+    k = std::min(k, numPts - 1);
+    out.resize(numPts*k);
+    if (k == 0)
+      return 0;
+    std::vector<Candidate> heap;
+    heap.reserve(k);
+    // iterate in the tree order for better cache locality
+    for (size_t rank = 0; rank < numPts; ++rank)
+    {
+      const size_t v = m_idx[rank];
+      heap.clear();
+      searchKNearest(0, m_pts.data() + rank*m_nDim, v, k, heap);
+      std::sort_heap(heap.begin(), heap.end());
+      for (size_t i = 0; i < k; ++i)
+        out[v*k + i] = heap[i].second;
+    }
+    return k;
+  }
+
+  ///////////////////////////////
+  //   fixed-radius search
+  ///////////////////////////////
+
+  template <typename CostTy>
+  void KdTree<CostTy>::searchRadius(
+    size_t nodeId, const CostTy* q, size_t vExclude, CostTy reducedRadius,
+    std::vector<size_t>& out) const
+  {
+    const Node& node = m_nodes[nodeId];
+    if (node.isLeaf())
+    {
+      for (size_t rank = node.begin; rank < node.end; ++rank)
+      {
+        if (m_idx[rank] != vExclude
+            && reducedDist(q, m_pts.data() + rank*m_nDim) <= reducedRadius)
+          out.emplace_back(m_idx[rank]);
+      }
+      return;
+    }
+    const CostTy delta = q[node.splitDim] - node.splitVal;
+    const size_t nearChild = (delta < 0) ? node.left : node.right;
+    const size_t farChild = (delta < 0) ? node.right : node.left;
+    searchRadius(nearChild, q, vExclude, reducedRadius, out);
+    if (reducedAxisDist(delta) <= reducedRadius)
+      searchRadius(farChild, q, vExclude, reducedRadius, out);
+  }
+
+  template <typename CostTy>
+  void KdTree<CostTy>::radiusSearch(size_t v, CostTy radius, std::vector<size_t>& out) const
+  {
+    out.clear();
+    if (radius < 0)
+      return;
+    searchRadius(0, m_pts.data() + m_pos[v]*m_nDim, v, reducedAxisDist(radius), out);
+  }
+
+  ///////////////////////////////
+  //   nearest active point
+  ///////////////////////////////
+
+  template <typename CostTy>
+  void KdTree<CostTy>::searchNearestActive(
+    size_t nodeId, const CostTy* q, size_t vExclude, Candidate& best) const
+  {
+    const Node& node = m_nodes[nodeId];
+    // prune a subtree whose points are all deleted
+    if (node.numActive == 0)
+      return;
+    if (node.isLeaf())
+    {
+      for (size_t rank = node.begin; rank < node.end; ++rank)
+      {
+        if (m_deleted[rank] || m_idx[rank] == vExclude)
+          continue;
+        Candidate c(reducedDist(q, m_pts.data() + rank*m_nDim), m_idx[rank]);
+        if (c < best)
+          best = c;
+      }
+      return;
+    }
+    const CostTy delta = q[node.splitDim] - node.splitVal;
+    const size_t nearChild = (delta < 0) ? node.left : node.right;
+    const size_t farChild = (delta < 0) ? node.right : node.left;
+    searchNearestActive(nearChild, q, vExclude, best);
+    if (reducedAxisDist(delta) <= best.first)
+      searchNearestActive(farChild, q, vExclude, best);
+  }
+
+  template <typename CostTy>
+  size_t KdTree<CostTy>::nearestActive(size_t v) const
+  {
+    Candidate best(
+      std::numeric_limits<CostTy>::max(), std::numeric_limits<size_t>::max());
+    searchNearestActive(0, m_pts.data() + m_pos[v]*m_nDim, v, best);
+    return best.second;
+  }
+
+  ///////////////////////////////
+  //   deletion
+  ///////////////////////////////
+
+  template <typename CostTy>
+  void KdTree<CostTy>::deletePoint(size_t v)
+  {
+    const size_t rank = m_pos[v];
+    if (m_deleted[rank])
+      return;
+    m_deleted[rank] = true;
+    // update the counters from the leaf up to the root
+    size_t nodeId = m_leafOf[v];
+    while (true)
+    {
+      --m_nodes[nodeId].numActive;
+      if (nodeId == 0)
+        break;
+      nodeId = m_nodes[nodeId].parent;
+    }
+  }
+
+  template <typename CostTy>
+  void KdTree<CostTy>::restoreAll()
+  {
+    m_deleted.assign(m_deleted.size(), false);
+    for (Node& node : m_nodes)
+      node.numActive = node.end - node.begin;
+  }
+
+  // explicit instantiation
+  template class KdTree<float>;
+  template class KdTree<double>;
+} // namespace xtsp
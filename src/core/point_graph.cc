@@ -0,0 +1,68 @@
+#include "xtsp/core/point_graph.h"
+#include "xtsp/core/tsplib_io.h"
+
+#include <exception>
+#include <spdlog/spdlog.h>
+#include <spdlog/fmt/bundled/format.h>
+
+namespace xtsp
+{
+  template <size_t NDim, NormType Norm, typename CostTy>
+  PointGraph<NDim, Norm, CostTy>::PointGraph(
+    const Eigen::Matrix<CostTy, -1, -1>& xy, 
+    const std::shared_ptr<Clustering> clustering)
+    : AbstractCompGraph<CostTy>(clustering)
+  {
+    if (static_cast<size_t>(xy.cols()) != NDim)
+    {
+      std::string errMsg = fmt::format(
+        "PointGraph ctor: expect {:d} coordinates per point but got {:d}", 
+        NDim, xy.cols());
+      throw std::invalid_argument(errMsg);
+    }
+    m_pts.resize(xy.rows());
+    for (size_t i = 0; i < m_pts.size(); ++i)
+    {
+      m_pts[i].coord.fill(0); // incl. the padding
+      for (size_t d = 0; d < NDim; ++d)
+        m_pts[i].coord[d] = xy(i, d);
+    }
+  }
+
+  template <size_t NDim, NormType Norm, typename CostTy>
+  Eigen::Matrix<CostTy, -1, -1> PointGraph<NDim, Norm, CostTy>::getXy() const
+  {
+    Eigen::Matrix<CostTy, -1, -1> xy(m_pts.size(), NDim);
+    for (size_t i = 0; i < m_pts.size(); ++i)
+      for (size_t d = 0; d < NDim; ++d)
+        xy(i, d) = m_pts[i].coord[d];
+    return xy;
+  }
+
+  AnyPointGraph loadPointGraphFromTsplibFile(const std::string& fpath)
+  {
+    TsplibPointSet pts = loadTsplibPointSet(fpath);
+    switch (pts.edgeWeightType)
+    {
+      case TsplibEdgeWeightType::kEUC_2D:
+        return PointGraph<2, kL2Norm>(pts.xy, pts.clustering);
+      case TsplibEdgeWeightType::kEUC_3D:
+        return PointGraph<3, kL2Norm>(pts.xy, pts.clustering);
+      case TsplibEdgeWeightType::kMAN_2D:
+        return PointGraph<2, kL1Norm>(pts.xy, pts.clustering);
+      case TsplibEdgeWeightType::kMAN_3D:
+        return PointGraph<3, kL1Norm>(pts.xy, pts.clustering);
+      default:
+        // loadTsplibPointSet should have rejected it already
+        throw std::invalid_argument("Unsupported EDGE_WEIGHT_TYPE for a PointGraph");
+    }
+  }
+
+  // explicit instantiation
+  template class PointGraph<2, kL2Norm>;
+  template class PointGraph<3, kL2Norm>;
+  template class PointGraph<2, kL1Norm>;
+  template class PointGraph<3, kL1Norm>;
+  template class PointGraph<2, kMaxNorm>;
+  template class PointGraph<3, kMaxNorm>;
+} // namespace xtsp
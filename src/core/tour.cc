@@ -4,6 +4,7 @@
 #include "xtsp/core/utils.h"
 #include "xtsp/algorithm_utils/work_buffer.h"
 #include "../toolbox/ring_ops.h"
+#include "../toolbox/devirtualize.h"
 
 #include <spdlog/spdlog.h>
 #include <spdlog/fmt/bundled/format.h>
@@ -56,6 +57,96 @@ namespace xtsp
     return count;
   }
 
+  bool AbstractTour::between(size_t vA, size_t vB, size_t vC) const
+  {
+    for (size_t vHead = vA; ; vHead = next(vHead))
+    {
+      if (vHead == vB)
+        return true;
+      if (vHead == vC)
+        return false;
+    }
+  }
+
+  void AbstractTour::moveSegment(size_t vS1, size_t vS2, size_t vP, bool reversed)
+  {
+    const size_t vO = prev(vS1);
+    const size_t vN = next(vS2);
+    const size_t vQ = next(vP);
+    if (between(vS1, vP, vS2))
+      throw std::invalid_argument("AbstractTour::moveSegment: P must not be on the segment");
+    if (vN == vO)
+      throw std::invalid_argument("AbstractTour::moveSegment: the segment is too long");
+
+    // Below, X denotes the segment and Y the path N -> ... -> P
+    if (vP == vO)
+    {
+      if (reversed && vS1 != vS2)
+        exchangeTwoEdges(vO, vS2, true);
+      return;
+    }
+    if (vQ == vO && vN == vP)
+    {
+      // the tour is O X P, which becomes O P X, 
+      // i.e., swap O and P (as a cycle)
+      if (vS1 == vS2)
+        throw std::invalid_argument("AbstractTour::moveSegment: the tour is too short");
+      exchangeTwoEdges(vS2, vO, true);
+    }
+    else if (vQ == vO)
+    {
+      // the tour is O X Y, which becomes O Y X, 
+      // i.e., the same as moving O after S2 (as a cycle)
+      moveSegment(vO, vO, vS2, false);
+    }
+    else
+    {
+      // O X Y Q -> O Y^r X^r Q -> O Y X^r Q
+      exchangeTwoEdges(vO, vP, true);
+      if (vN != vP)
+        exchangeTwoEdges(vO, vN, true);
+      if (!reversed && vS1 != vS2)
+        exchangeTwoEdges(vP, vS1, true);
+      return;
+    }
+    // now the tour is O -> Y -> X, reverse X if requested
+    if (reversed && vS1 != vS2)
+      exchangeTwoEdges(vP, vS2, true);
+  }
+
+  void AbstractTour::rollback(size_t checkpoint)
+  {
+    if (checkpoint > m_journal.size())
+      throw std::invalid_argument(
+        "AbstractTour::rollback: the checkpoint is newer than the journal");
+    // the undo flips themselves are not recorded
+    const bool journaling = m_journaling;
+    m_journaling = false;
+    while (m_journal.size() > checkpoint)
+    {
+      const Move m = m_journal.back();
+      m_journal.pop_back();
+      if (m.isSegmentMove)
+      {
+        // move it back after O (in the original orientation)
+        const size_t vS1 = m.v[0], vS2 = m.v[1], vO = m.v[2];
+        if (m.reversed)
+          moveSegment(vS2, vS1, vO, true);
+        else
+          moveSegment(vS1, vS2, vO, false);
+        continue;
+      }
+      // either BC was reversed (A -> C ... B -> D)
+      // or DA was (C -> A ... D -> B), so reverse it back strictly
+      const auto [vA, vB, vC, vD] = m.v;
+      if (next(vA) == vC)
+        exchangeTwoEdges(vA, vB, true);
+      else
+        exchangeTwoEdges(vC, vD, true);
+    }
+    m_journaling = journaling;
+  }
+
   bool AbstractTour::isHamiltonian() const
   {
     // Note: a partial tour is not Hamiltonian
@@ -102,11 +193,17 @@ namespace xtsp
   ///   PermTour : ctor & key interfaces
   ////////////////////////////////////////
 
-  PermTour::PermTour(const std::vector<size_t> &sequence, int maxNumVertices, bool checks)
-    : m_seq(sequence)
+  template <typename IdxTy>
+  BasicPermTour<IdxTy>::BasicPermTour(
+    const std::vector<size_t> &sequence, int maxNumVertices, bool checks)
+    : m_seq(sequence.cbegin(), sequence.cend())
     , m_N((maxNumVertices < 0) ? sequence.size() : maxNumVertices)
     , m_HomeId(sequence[0])
   {
+    // (the max. value is reserved as "not in the tour")
+    if (m_N >= std::numeric_limits<IdxTy>::max())
+      throw std::invalid_argument(
+        "[constructing a PermTour] too many vertices for the index type");
     if (sequence.size() > m_N)
       throw std::invalid_argument(
         "[constructing a PermTour] maxNumVertices should >= sequence.size()");
@@ -119,28 +216,23 @@ namespace xtsp
     updateCacheAfterShuffling();
   }
 
-  size_t PermTour::next(size_t v) const
-  {
-    return nextByRank(getRank_(v));
-  }
-
-  size_t PermTour::getDepotId() const
-  {
-    return m_HomeId;
-  }
-
-  void PermTour::exchangeTwoEdges_rankBased(size_t rankA, size_t rankC, bool strict)
+  template <typename IdxTy>
+  void BasicPermTour<IdxTy>::exchangeTwoEdges_rankBased(size_t rankA, size_t rankC, bool strict)
   {
     if (rankA + 1 >= rankC)
       throw std::invalid_argument("expect rankA + 1 < rankC");
     size_t rankB = rankA + 1;
-    if (strict)
-      xtsp::internal::reverseRingSegment_strict(m_seq, rankB, rankC);
-    else
-      xtsp::internal::reverseRingSegment_smart(m_seq, rankB, rankC);
-    updateCacheAfterShuffling();
-  }
-  void PermTour::exchangeTwoEdges(size_t vA, size_t vC, bool strict)
+    this->recordFlip(m_seq[rankA%size()], m_seq[rankB%size()], 
+                     m_seq[rankC%size()], m_seq[(rankC+1)%size()]);
+    // only the reversed ranks need a cache update, 
+    // i.e., O(segment length) instead of O(N)
+    const auto touched = strict
+      ? xtsp::internal::reverseRingSegment_strict(m_seq, rankB, rankC)
+      : xtsp::internal::reverseRingSegment_smart(m_seq, rankB, rankC);
+    updateCacheAfterShuffling(touched.start, touched.length);
+  }
+  template <typename IdxTy>
+  void BasicPermTour<IdxTy>::exchangeTwoEdges(size_t vA, size_t vC, bool strict)
   {
     if (vA == vC)
     {
@@ -156,7 +248,23 @@ namespace xtsp
     exchangeTwoEdges_rankBased(rankA, rankC, strict);
   }
 
-  void PermTour::updateCacheAfterShuffling()
+  template <typename IdxTy>
+  void BasicPermTour<IdxTy>::moveSegment(size_t vS1, size_t vS2, size_t vP, bool reversed)
+  {
+    const size_t rankS1 = getRank_(vS1);
+    const size_t segLen = evalNumStepsAhead(vS1, vS2) + 1;
+    if (evalNumStepsAhead(vS1, vP) < segLen)
+      throw std::invalid_argument("PermTour::moveSegment: P must not be on the segment");
+    if (segLen + 2 > size())
+      throw std::invalid_argument("PermTour::moveSegment: the segment is too long");
+    this->recordSegmentMove(vS1, vS2, prev(vS1), reversed);
+    const auto touched = xtsp::internal::moveRingSegment(
+      m_seq, rankS1, segLen, getRank_(vP), reversed, m_segBuf);
+    updateCacheAfterShuffling(touched.start, touched.length);
+  }
+
+  template <typename IdxTy>
+  void BasicPermTour<IdxTy>::updateCacheAfterShuffling()
   {
     for (size_t rank = 0; rank < size(); ++rank)
     {
@@ -164,25 +272,21 @@ namespace xtsp
     }
   }
 
-
-  ////////////////////////////////////////////////////
-  ///   Some native getters of PermTour
-  ////////////////////////////////////////////////////
-
-  size_t PermTour::getRank_(size_t vertexId) const
+  template <typename IdxTy>
+  void BasicPermTour<IdxTy>::updateCacheAfterShuffling(size_t rankStart, size_t numRanks)
   {
-    // auto ite = std::find(m_seq.cbegin(), m_seq.cend(), vertexId);
-    // if (ite == m_seq.cend())
-    //   throw ("Cannot find the requested vertex ID in the tour");
-    // return std::distance(m_seq.cbegin(), ite);
-    return m_cache_id2rank_[vertexId];
+    // the part before the wrap-around, then the part after
+    const size_t rankStop = rankStart + numRanks;
+    for (size_t rank = rankStart; rank < std::min(rankStop, size()); ++rank)
+      m_cache_id2rank_[m_seq[rank]] = rank;
+    for (size_t rank = 0; rank + size() < rankStop; ++rank)
+      m_cache_id2rank_[m_seq[rank]] = rank;
   }
 
 
-  size_t PermTour::nextByRank(size_t rank) const
-  {
-    return m_seq[(rank+1)%size()];
-  }
+  // explicit template instantiation
+  template class BasicPermTour<uint32_t>;
+  template class BasicPermTour<size_t>;
 
   ////////////////////////////////////////////
   ///  Adjacency table representation
@@ -197,6 +301,9 @@ namespace xtsp
     if (perm.size() > m_N)
       throw std::invalid_argument(
         "[constructing a PermTour] maxNumVertices should >= sequence.size()");
+    if (m_N >= kNotInTour)
+      throw std::invalid_argument(
+        "[constructing a AdjTabTour] too many vertices for 32-bit vertex IDs");
     if (checks)
     {
       xtsp::utils::assertNoDuplicate(perm, "tour", "city");
@@ -204,42 +311,19 @@ namespace xtsp
     }
 
     m_cache_tourSize = perm.size();
-    m_dat.reserve(m_N);
-    // a simple implementation that ensures that 
-    // those not yet in the tour also get properly initialized
-    for (size_t v = 0; v < m_N; ++v)
-    {
-      m_dat.emplace_back(v);
-    }
+    m_label.resize(m_N, 0);
+    // those not yet in the tour are marked as such
+    m_links.resize(m_N, Link{kNotInTour, kNotInTour});
     for (size_t rank = 0; rank < m_cache_tourSize; ++rank)
     {
       size_t vertexId = perm[rank];
       auto rankPrevWrapped = (rank + m_cache_tourSize - 1)%m_cache_tourSize;
       auto rankNextWrapped = (rank + m_cache_tourSize + 1)%m_cache_tourSize;
-      m_dat[vertexId].prev = m_dat.data() + perm[rankPrevWrapped];
-      m_dat[vertexId].next = m_dat.data() + perm[rankNextWrapped];
+      m_links[vertexId].prev = perm[rankPrevWrapped];
+      m_links[vertexId].next = perm[rankNextWrapped];
+      m_label[vertexId] = rank;
     }
-    
   }
-  size_t AdjTabTour::size() const
-  {
-    return m_cache_tourSize;
-  }
-  size_t AdjTabTour::maxSize() const
-  {
-    return m_cache_tourSize;
-  }
-
-  size_t AdjTabTour::next(size_t vertex) const
-  {
-    return m_dat[vertex].next->id;
-  }
-
-  size_t AdjTabTour::getDepotId() const
-  {
-    return m_head;
-  }
-
   void AdjTabTour::exchangeTwoEdges(
       size_t vA, size_t vC, bool strict)
   {
@@ -250,29 +334,97 @@ namespace xtsp
 
     const size_t vB = next(vA);
     const size_t vD = next(vC);
+    recordFlip(vA, vB, vC, vD);
 
     /// currently we always reverse BC
     /// i.e., ignoring the strict-flag
 
+    // the k-th vertex of segment BC (B being the 0-th) 
+    // will become the (lenBC-1-k)-th one
+    const size_t n = m_cache_tourSize;
+    const size_t labelB = m_label[vB];
+    const size_t lenBC = (m_label[vC] + n - labelB)%n + 1;
+    m_label[vB] = (labelB + lenBC - 1)%n;
+    m_label[vC] = labelB;
+
     // if the segment BC has some node(s) in between, then ...
     // modify the underlying data while traversing along 
     // the (original) tour direction.
     size_t vHead = next(vB);
-    while (vHead != vC) 
+    for (size_t k = 1; vHead != vC; ++k)
     {
-      std::swap(m_dat[vHead].prev, m_dat[vHead].next);
-      vHead = m_dat[vHead].prev->id; // i.e., next before the flip
+      Link& link = m_links[vHead];
+      std::swap(link.prev, link.next);
+      m_label[vHead] = (labelB + lenBC - 1 - k)%n;
+      vHead = link.prev; // i.e., next before the flip
     }
 
-    m_dat[vA].next = &m_dat[vC]; // was vB
-    m_dat[vD].prev = &m_dat[vB]; // was vC
+    m_links[vA].next = vC; // was vB
+    m_links[vD].prev = vB; // was vC
 
     // change vB, ..., vC
-    m_dat[vB].prev = m_dat[vB].next;
-    m_dat[vB].next = &m_dat[vD];
+    m_links[vB].prev = m_links[vB].next;
+    m_links[vB].next = vD;
 
-    m_dat[vC].next = m_dat[vC].prev;
-    m_dat[vC].prev = &m_dat[vA];
+    m_links[vC].next = m_links[vC].prev;
+    m_links[vC].prev = vA;
+  }
+
+  void AdjTabTour::moveSegment(size_t vS1, size_t vS2, size_t vP, bool reversed)
+  {
+    const size_t n = m_cache_tourSize;
+    const size_t labelS1 = m_label[vS1];
+    const size_t segLen = evalNumStepsAhead(vS1, vS2) + 1;
+    if (evalNumStepsAhead(vS1, vP) < segLen)
+      throw std::invalid_argument("AdjTabTour::moveSegment: P must not be on the segment");
+    if (segLen + 2 > n)
+      throw std::invalid_argument("AdjTabTour::moveSegment: the segment is too long");
+    const size_t vO = prev(vS1);
+    if (vP == vO)
+    {
+      // it stays, i.e., a flip (if at all)
+      if (reversed && vS1 != vS2)
+        exchangeTwoEdges(vO, vS2, true);
+      return;
+    }
+    recordSegmentMove(vS1, vS2, vO, reversed);
+    const size_t vN = next(vS2);
+    const size_t vQ = next(vP);
+    // the path N -> ... -> P (forward) and Q -> ... -> O (backward)
+    const size_t gapFwd = evalNumStepsAhead(vN, vP) + 1;
+    const size_t gapBwd = n - segLen - gapFwd;
+    const size_t labelQ = m_label[vQ];
+
+    // unlink the segment
+    m_links[vO].next = vN;
+    m_links[vN].prev = vO;
+    if (reversed)
+    {
+      for (size_t v = vS1; ; )
+      {
+        Link& link = m_links[v];
+        const size_t vNext = link.next;
+        std::swap(link.prev, link.next);
+        if (v == vS2)
+          break;
+        v = vNext;
+      }
+    }
+    const size_t vFirst = reversed ? vS2 : vS1;
+    const size_t vLast = reversed ? vS1 : vS2;
+    // link it between P and Q
+    m_links[vP].next = vFirst;
+    m_links[vFirst].prev = vP;
+    m_links[vLast].next = vQ;
+    m_links[vQ].prev = vLast;
+
+    // the labels of the shorter side 
+    // (together with the segment) get rotated
+    size_t v = (gapFwd <= gapBwd) ? vN : vFirst;
+    const size_t labelStart = (gapFwd <= gapBwd) ? labelS1 : labelQ;
+    const size_t numRelabel = segLen + std::min(gapFwd, gapBwd);
+    for (size_t k = 0; k < numRelabel; ++k, v = next(v))
+      m_label[v] = (labelStart + k)%n;
   }
 
   
@@ -372,4 +524,61 @@ namespace xtsp
     return this->m_tour->m_seq[clusterRank];
   }
 
+  ////////////////////////////////////////////
+  ///  Tour evaluation
+  ////////////////////////////////////////////
+  template <typename CostTy, typename TourTy, typename GraphTy>
+  static AccumTy<CostTy> evalTour_(const TourTy& tour, const GraphTy& g)
+  {
+    if constexpr (std::is_same_v<TourTy, PermTour>)
+    {
+      // follow the ranks (avoid reverse lookup and the modulo)
+      AccumTy<CostTy> sum = g.getEdgeCost(tour.getVertex_(tour.size()-1), tour.getVertex_(0));
+      for (size_t rank = 1; rank < tour.size(); ++rank)
+        sum += g.getEdgeCost(tour.getVertex_(rank-1), tour.getVertex_(rank));
+      return sum;
+    }
+    else
+    {
+      size_t vHead = tour.getDepotId();
+      AccumTy<CostTy> sum = 0;
+      for (size_t rank = 0; rank < tour.size(); ++rank)
+      {
+        sum += g.getEdgeCost(vHead, tour.next(vHead));
+        vHead = tour.next(vHead);
+      }
+      return sum;
+    }
+  }
+
+  template <typename CostTy>
+  AccumTy<CostTy> evalTour(const AbstractTour& tour, const AbstractCompGraph<CostTy>& g)
+  {
+    return internal::visitConcreteTour(tour, [&](const auto& t) {
+      return internal::visitConcreteGraph(g, [&](const auto& gConcrete) {
+        return evalTour_<CostTy>(t, gConcrete);
+      });
+    });
+  }
+
+  template <typename CostTy>
+  AccumTy<CostTy> evalTour(const PermTour &tour, const AbstractCompGraph<CostTy>& g)
+  {
+    return internal::visitConcreteGraph(g, [&](const auto& gConcrete) {
+      return evalTour_<CostTy>(tour, gConcrete);
+    });
+  }
+
+  // explicit template instantiation
+  template AccumTy<float> evalTour(const AbstractTour&, const AbstractCompGraph<float>&);
+  template AccumTy<int> evalTour(const AbstractTour&, const AbstractCompGraph<int>&);
+  template AccumTy<uint16_t> evalTour(const AbstractTour&, const AbstractCompGraph<uint16_t>&);
+  template AccumTy<int16_t> evalTour(const AbstractTour&, const AbstractCompGraph<int16_t>&);
+  template AccumTy<uint32_t> evalTour(const AbstractTour&, const AbstractCompGraph<uint32_t>&);
+  template AccumTy<float> evalTour(const PermTour&, const AbstractCompGraph<float>&);
+  template AccumTy<int> evalTour(const PermTour&, const AbstractCompGraph<int>&);
+  template AccumTy<uint16_t> evalTour(const PermTour&, const AbstractCompGraph<uint16_t>&);
+  template AccumTy<int16_t> evalTour(const PermTour&, const AbstractCompGraph<int16_t>&);
+  template AccumTy<uint32_t> evalTour(const PermTour&, const AbstractCompGraph<uint32_t>&);
+
 } // namespace xtsp
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include "xtsp/core/two_level_list_tour.h"
+#include "xtsp/core/utils.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+namespace xtsp
+{
+  TwoLevelListTour::TwoLevelListTour(
+    const std::vector<size_t>& perm, int maxNumVertices, bool checks, size_t groupSize)
+    : m_N((maxNumVertices < 0) ? perm.size() : maxNumVertices)
+  {
+    if (perm.size() == 0)
+      throw std::invalid_argument(
+        "[constructing a TwoLevelListTour] the input permutation vector is empty");
+    if (perm.size() > m_N)
+      throw std::invalid_argument(
+        "[constructing a TwoLevelListTour] maxNumVertices should >= sequence.size()");
+    if (checks)
+    {
+      xtsp::utils::assertNoDuplicate(perm, "tour", "city");
+      xtsp::utils::assertAllValid(m_N, perm, "tour", "city ID");
+    }
+    m_depot = perm[0];
+    m_tourSize = perm.size();
+    m_groupSize = (groupSize > 0) ? groupSize
+      : std::max<size_t>(8, std::sqrt(static_cast<double>(m_tourSize)));
+    // those not in the tour keep parent = kNone
+    m_nodes.resize(m_N);
+    rebuildSegments(perm);
+  }
+
+  void TwoLevelListTour::rebuildSegments(const std::vector<size_t>& seq)
+  {
+    const size_t len = seq.size();
+    m_numSegs = (len + m_groupSize - 1)/m_groupSize;
+    m_segs.assign(m_numSegs, Segment());
+    for (size_t s = 0; s < m_numSegs; ++s)
+    {
+      Segment& seg = m_segs[s];
+      const size_t rankBegin = s*m_groupSize;
+      const size_t rankEnd = std::min(len, rankBegin + m_groupSize);
+      for (size_t rank = rankBegin; rank < rankEnd; ++rank)
+      {
+        Node& node = m_nodes[seq[rank]];
+        node.parent = s;
+        node.seq = rank - rankBegin;
+        node.prev = (rank == rankBegin) ? kNone : seq[rank-1];
+        node.next = (rank + 1 == rankEnd) ? kNone : seq[rank+1];
+      }
+      seg.first = seq[rankBegin];
+      seg.last = seq[rankEnd-1];
+      seg.prev = (s + m_numSegs - 1)%m_numSegs;
+      seg.next = (s + 1)%m_numSegs;
+      seg.rank = s;
+    }
+    m_headSeg = 0;
+  }
+
+  void TwoLevelListTour::updateRanks()
+  {
+    size_t s = m_headSeg;
+    for (size_t rank = 0; rank < m_numSegs; ++rank)
+    {
+      m_segs[s].rank = rank;
+      s = m_segs[s].next;
+    }
+  }
+
+  void TwoLevelListTour::splitBefore(size_t v)
+  {
+    const size_t s = m_nodes[v].parent;
+    if (v == head(m_segs[s]))
+      return;
+    // the cut is between x and y = x.next (ignoring the reversal bit)
+    const size_t x = m_segs[s].reversed ? v : m_nodes[v].prev;
+    const size_t y = m_nodes[x].next;
+    const bool moveFirstPart =
+      (m_nodes[x].seq - m_nodes[m_segs[s].first].seq)
+        < (m_nodes[m_segs[s].last].seq - m_nodes[y].seq);
+
+    // move the smaller part to a new segment t
+    const size_t t = m_numSegs++;
+    if (m_segs.size() < m_numSegs)
+      m_segs.emplace_back();
+    Segment& segS = m_segs[s];
+    Segment& segT = m_segs[t];
+    segT.reversed = segS.reversed;
+    if (moveFirstPart)
+    {
+      segT.first = segS.first;
+      segT.last = x;
+      segS.first = y;
+    }
+    else
+    {
+      segT.first = y;
+      segT.last = segS.last;
+      segS.last = x;
+    }
+    m_nodes[x].next = kNone;
+    m_nodes[y].prev = kNone;
+    for (size_t u = segT.first; u != kNone; u = m_nodes[u].next)
+      m_nodes[u].parent = t;
+
+    // the first part (of the list) precedes the second part
+    // along the tour unless the segment is reversed
+    const bool insertBefore = (moveFirstPart != segS.reversed);
+    if (insertBefore)
+    {
+      segT.prev = segS.prev;
+      segT.next = s;
+      m_segs[segS.prev].next = t;
+      segS.prev = t;
+    }
+    else
+    {
+      segT.next = segS.next;
+      segT.prev = s;
+      m_segs[segS.next].prev = t;
+      segS.next = t;
+    }
+  }
+
+  void TwoLevelListTour::reverseWithinSegment(size_t segId, size_t vB, size_t vC)
+  {
+    Segment& seg = m_segs[segId];
+    // x -> ... -> y ignoring the reversal bit
+    const size_t x = seg.reversed ? vC : vB;
+    const size_t y = seg.reversed ? vB : vC;
+    const size_t xPrev = m_nodes[x].prev;
+    const size_t yNext = m_nodes[y].next;
+    const int64_t seqSum = m_nodes[x].seq + m_nodes[y].seq;
+    for (size_t u = x; ; )
+    {
+      Node& node = m_nodes[u];
+      const size_t uNext = node.next;
+      std::swap(node.prev, node.next);
+      node.seq = seqSum - node.seq;
+      if (u == y)
+        break;
+      u = uNext;
+    }
+    m_nodes[y].prev = xPrev;
+    m_nodes[x].next = yNext;
+    if (xPrev == kNone)
+      seg.first = y;
+    else
+      m_nodes[xPrev].next = y;
+    if (yNext == kNone)
+      seg.last = x;
+    else
+      m_nodes[yNext].prev = x;
+  }
+
+  void TwoLevelListTour::reversePath(size_t vB, size_t vC)
+  {
+    if (m_nodes[vB].parent == m_nodes[vC].parent && positionKey(vB) <= positionKey(vC))
+    {
+      reverseWithinSegment(m_nodes[vB].parent, vB, vC);
+      return;
+    }
+
+    // make the path consist of whole segments sB -> ... -> sC
+    splitBefore(vB);
+    splitBefore(next(vC));
+    const size_t sB = m_nodes[vB].parent;
+    const size_t sC = m_nodes[vC].parent;
+    const size_t sPrev = m_segs[sB].prev;
+    const size_t sNext = m_segs[sC].next;
+    assert(sPrev != sC);
+
+    // reverse the order of the segments and toggle their reversal bits
+    for (size_t s = sB; ; )
+    {
+      Segment& seg = m_segs[s];
+      const size_t sNextOld = seg.next;
+      std::swap(seg.prev, seg.next);
+      seg.reversed = !seg.reversed;
+      if (s == sC)
+        break;
+      s = sNextOld;
+    }
+    m_segs[sPrev].next = sC;
+    m_segs[sC].prev = sPrev;
+    m_segs[sB].next = sNext;
+    m_segs[sNext].prev = sB;
+
+    // amortize the splits by rebuilding every O(sqrt N) moves
+    const size_t numSegsNominal = (m_tourSize + m_groupSize - 1)/m_groupSize;
+    if (m_numSegs > 2*numSegsNominal + 2)
+    {
+      SPDLOG_DEBUG("TwoLevelListTour: rebuilding {:d} segments", m_numSegs);
+      m_workSeq.resize(m_tourSize);
+      m_workSeq[0] = m_depot;
+      for (size_t rank = 1; rank < m_tourSize; ++rank)
+        m_workSeq[rank] = next(m_workSeq[rank-1]);
+      rebuildSegments(m_workSeq);
+    }
+    else
+    {
+      updateRanks();
+    }
+  }
+
+  void TwoLevelListTour::exchangeTwoEdges(size_t vA, size_t vC, bool strict)
+  {
+    const size_t vB = next(vA);
+    const size_t vD = next(vC);
+    if (vA == vC || vB == vC || vD == vA)
+      throw std::invalid_argument(
+        "TwoLevelListTour::exchangeTwoEdges: "
+        "C must be at least two steps away from A and vice versa");
+    recordFlip(vA, vB, vC, vD);
+
+    if (!strict)
+    {
+      // the number of segments spanned by the path
+      auto numSegsOnPath = [this](size_t vFrom, size_t vTo) -> size_t
+      {
+        const size_t rankFrom = m_segs[m_nodes[vFrom].parent].rank;
+        const size_t rankTo = m_segs[m_nodes[vTo].parent].rank;
+        if (rankFrom == rankTo)
+          return (positionKey(vFrom) <= positionKey(vTo)) ? 0 : m_numSegs + 1;
+        return (rankTo + m_numSegs - rankFrom)%m_numSegs + 1;
+      };
+      if (numSegsOnPath(vD, vA) < numSegsOnPath(vB, vC))
+      {
+        reversePath(vD, vA);
+        return;
+      }
+    }
+    reversePath(vB, vC);
+  }
+}
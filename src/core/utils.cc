@@ -1,5 +1,6 @@
 #include "xtsp/core/utils.h"
 
+#include <cstdint>
 #include <limits>
 #include <exception>
 #include <set>
@@ -14,8 +15,9 @@ namespace xtsp
   namespace utils
   {
 
+    template <typename IdxTy>
     void assertNoDuplicate(
-      const std::vector<size_t>& vec,
+      const std::vector<IdxTy>& vec,
       const std::string arrName,
       const std::string entryName)
     {
@@ -40,9 +42,10 @@ namespace xtsp
       // }
     }
 
+    template <typename IdxTy>
     void assertAllValid(
       size_t upperBound,
-      const std::vector<size_t>& vec,
+      const std::vector<IdxTy>& vec,
       const std::string arrName,
       const std::string entryName)
     {
@@ -130,5 +133,15 @@ namespace xtsp
         out.emplace_back(i);
       std::shuffle(out.begin(), out.end(), rng);
     }
+
+    // explicit template instantiation
+    template void assertNoDuplicate(
+      const std::vector<size_t>&, const std::string, const std::string);
+    template void assertNoDuplicate(
+      const std::vector<uint32_t>&, const std::string, const std::string);
+    template void assertAllValid(
+      size_t, const std::vector<size_t>&, const std::string, const std::string);
+    template void assertAllValid(
+      size_t, const std::vector<uint32_t>&, const std::string, const std::string);
   } // namespace utils
 } // namespace xtsp
@@ -4,14 +4,14 @@
 #include <spdlog/spdlog.h>
 #include <spdlog/fmt/bundled/ranges.h>
 
-#include "xtsp/algorithm_utils/work_buffer.h"
+#include <algorithm>
 
 namespace xtsp::algo
 {
   template <typename CostTy>
   PermTour farthestInsertion(const AbstractCompGraph<CostTy> &g, size_t vFirstPick)
   {
-    // a straight-forward implementation
+    // O(N^2) overall thanks to the incremental bookkeeping below
 
     if (vFirstPick >= g.numVertices())
     {
@@ -22,66 +22,77 @@ namespace xtsp::algo
       throw std::invalid_argument(errMsg);
     }
 
-    // initialize a partial Hamiltonian tour of length 2
+    // initialize a partial Hamiltonian tour of length 1
     const size_t numV = g.numVertices(); // aka N
     assert(numV >= 2);
     std::vector<size_t> pTour; // partial Hamiltonian tour: rank --> vertex ID
-    pTour.emplace_back(vFirstPick);
-
-    xtsp::internal::WorkBuffer verticesToAdd(numV);
-    for (auto i : pTour)
-    {
-      verticesToAdd.markDone(i);
-    }
     pTour.reserve(numV);
+    pTour.emplace_back(vFirstPick);
     SPDLOG_DEBUG("Initialized a partial tour: {}", fmt::join(pTour, " "));
 
+    // the vertices yet to be added (in no particular order)
+    std::vector<size_t> verticesToAdd;
+    verticesToAdd.reserve(numV - 1);
+    for (size_t vX = 0; vX < numV; ++vX)
+      if (vX != vFirstPick)
+        verticesToAdd.emplace_back(vX);
+
+    // the distance of each vertex from the partial tour, 
+    // i.e., min. over the tour vertices. It is updated incrementally 
+    // whenever a vertex joins the tour (one batched query per insertion), 
+    // which brings the selection down from O(N^3) to O(N^2) overall.
+    std::vector<CostTy> distFromTour(numV);
+    std::vector<CostTy> costBuf(numV);
+    g.getEdgeCosts(vFirstPick, verticesToAdd.data(), verticesToAdd.size(), costBuf.data());
+    for (size_t k = 0; k < verticesToAdd.size(); ++k)
+      distFromTour[verticesToAdd[k]] = costBuf[k];
+
+    // costs to and from the picked vertex (indexed by the tour rank)
+    std::vector<CostTy> costFromPicked(numV);
+    std::vector<CostTy> costToPicked(numV);
+    // the cost of each tour edge, i.e., from pTour[i] to pTour[i+1]
+    // (kept in sync with pTour)
+    std::vector<CostTy> tourEdgeCost(1, g.getEdgeCost(vFirstPick, vFirstPick));
+    tourEdgeCost.reserve(numV);
+
     // iterate for N-1 times
-    size_t vPicked;
-    while (!verticesToAdd.isEmpty())
+    while (!verticesToAdd.empty())
     {
       // which one to insert? (farthest from the pTour)
-      CostTy maxDistFromTour = std::numeric_limits<CostTy>::min();
-      /// @todo if we are obessessed with runtime,
-      ///     consider looping over the min and max of verticesToAdd instead
-      for (size_t vX = verticesToAdd.estimateTodoIdMin();
-           vX <= verticesToAdd.estimateTodoIdMax(); ++vX)
+      // (tie-break: the lower vertex ID)
+      size_t kPicked = 0;
+      for (size_t k = 1; k < verticesToAdd.size(); ++k)
       {
-        if (!verticesToAdd.isDone(vX))
-          continue;
-        // compute the distance of X from the partial tour
-        CostTy distTour2X = std::numeric_limits<CostTy>::max();
-        for (const auto vExisting : pTour)
-        {
-          CostTy d = g.getEdgeCost(vExisting, vX);
-          if (d < distTour2X)
-          {
-            distTour2X = d;
-          }
-        }
-
-        // update vPicked and maxDistFromTour
-        if (distTour2X > maxDistFromTour)
-        {
-          maxDistFromTour = distTour2X;
-          vPicked = vX;
-        }
+        const CostTy dCandidate = distFromTour[verticesToAdd[k]];
+        const CostTy dBest = distFromTour[verticesToAdd[kPicked]];
+        if (dCandidate > dBest 
+            || (dCandidate == dBest && verticesToAdd[k] < verticesToAdd[kPicked]))
+          kPicked = k;
       }
+      const size_t vPicked = verticesToAdd[kPicked];
+      verticesToAdd[kPicked] = verticesToAdd.back();
+      verticesToAdd.pop_back();
 
       // where to insert? (greedy: minimize insertion cost)
       size_t whereToInsert; // note: vPicked will be inserted before whereToInsert
+      g.getEdgeCosts(vPicked, pTour.data(), pTour.size(), costFromPicked.data());
+      if (g.isSymmetric())
+        std::copy_n(costFromPicked.cbegin(), pTour.size(), costToPicked.begin());
+      else
+        for (size_t i = 0; i < pTour.size(); ++i)
+          costToPicked[i] = g.getEdgeCost(pTour[i], vPicked);
       if (pTour.size() == 1)
       {
         whereToInsert = 1; // or 0
       }
       else
       {
-        CostTy minInsertionCost = std::numeric_limits<CostTy>::max();
+        AccumTy<CostTy> minInsertionCost = std::numeric_limits<AccumTy<CostTy>>::max();
         for (size_t i = 0; i < pTour.size(); ++i)
         {
-          size_t vWhere = pTour[i];
-          size_t vPrev = (i == 0) ? pTour.back() : pTour[i - 1];
-          CostTy insertionCost = g.getEdgeCost(vPrev, vPicked) + g.getEdgeCost(vPicked, vWhere) - g.getEdgeCost(vPrev, vWhere);
+          size_t iPrev = (i == 0) ? pTour.size() - 1 : i - 1;
+          AccumTy<CostTy> insertionCost = AccumTy<CostTy>(costToPicked[iPrev]) 
+            + costFromPicked[i] - tourEdgeCost[iPrev];
           if (insertionCost < minInsertionCost)
           {
             minInsertionCost = insertionCost;
@@ -92,8 +103,18 @@ namespace xtsp::algo
 
       // do the insertion
       SPDLOG_DEBUG("Inserting vertex {:d} at rank {:d}", vPicked, whereToInsert);
+      {
+        const size_t iPrev = (whereToInsert == 0) ? pTour.size() - 1 : whereToInsert - 1;
+        const size_t iNext = whereToInsert % pTour.size();
+        tourEdgeCost[iPrev] = costToPicked[iPrev];
+        tourEdgeCost.insert(tourEdgeCost.begin() + whereToInsert, costFromPicked[iNext]);
+      }
       pTour.insert(pTour.begin() + whereToInsert, vPicked);
-      verticesToAdd.markDone(vPicked);
+
+      // the remaining vertices might be closer to vPicked than to the old pTour
+      g.getEdgeCosts(vPicked, verticesToAdd.data(), verticesToAdd.size(), costBuf.data());
+      for (size_t k = 0; k < verticesToAdd.size(); ++k)
+        distFromTour[verticesToAdd[k]] = std::min(distFromTour[verticesToAdd[k]], costBuf[k]);
     }
 
     PermTour tour(pTour, numV);
@@ -103,4 +124,7 @@ namespace xtsp::algo
 
   template PermTour farthestInsertion<float>(const AbstractCompGraph<float> &, size_t);
   template PermTour farthestInsertion<int>(const AbstractCompGraph<int> &, size_t);
+  template PermTour farthestInsertion<uint16_t>(const AbstractCompGraph<uint16_t> &, size_t);
+  template PermTour farthestInsertion<int16_t>(const AbstractCompGraph<int16_t> &, size_t);
+  template PermTour farthestInsertion<uint32_t>(const AbstractCompGraph<uint32_t> &, size_t);
 }
\ No newline at end of file
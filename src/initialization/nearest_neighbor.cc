@@ -0,0 +1,117 @@
+#include "xtsp/initialization/nearest_neighbor.h"
+#include "xtsp/core/kdtree.h"
+
+#include <memory>
+#include <type_traits>
+
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_WARN
+#include <spdlog/spdlog.h>
+
+namespace xtsp::algo
+{
+  template <typename CostTy>
+  PermTour nearestNeighborTour(
+    const AbstractCompGraph<CostTy>& g, const CandidateSet<CostTy>& candidates,
+    size_t vFirstPick)
+  {
+    const size_t numV = g.numVertices(); // aka N
+    if (vFirstPick >= numV)
+    {
+      std::string errMsg = fmt::format(
+          "Invalid first pick ID {:d} (should be 0 <= pick < N = {:d})",
+          vFirstPick, numV);
+      SPDLOG_ERROR(errMsg);
+      throw std::invalid_argument(errMsg);
+    }
+    if (candidates.numVertices() != numV)
+      throw std::invalid_argument(
+          "nearestNeighborTour: the candidates don't match the graph");
+
+    // the unvisited vertices, removal by swapping with the last one
+    std::vector<size_t> unvisited(numV);
+    std::vector<size_t> posUnvisited(numV);
+    for (size_t v = 0; v < numV; ++v)
+    {
+      unvisited[v] = v;
+      posUnvisited[v] = v;
+    }
+    constexpr size_t visited = std::numeric_limits<size_t>::max();
+
+    // a point set answers the fallback via its K-d tree instead,
+    // i.e., our own copy with the visited vertices deleted
+    std::unique_ptr<KdTree<float>> unvisitedTree;
+    if constexpr (std::is_same_v<CostTy, float>)
+    {
+      auto gPts = dynamic_cast<const ImplicitCompleteGraph<float>*>(&g);
+      if (gPts != nullptr)
+        unvisitedTree = std::make_unique<KdTree<float>>(gPts->getKdTree());
+    }
+
+    auto markVisited = [&](size_t v)
+    {
+      const size_t pos = posUnvisited[v];
+      const size_t vLast = unvisited.back();
+      unvisited[pos] = vLast;
+      posUnvisited[vLast] = pos;
+      unvisited.pop_back();
+      posUnvisited[v] = visited;
+      if (unvisitedTree)
+        unvisitedTree->deletePoint(v);
+    };
+
+    std::vector<size_t> seq;
+    seq.reserve(numV);
+    seq.emplace_back(vFirstPick);
+    markVisited(vFirstPick);
+    size_t numFallbacks = 0;
+    while (!unvisited.empty())
+    {
+      const size_t vCurr = seq.back();
+      size_t vNext = visited;
+      for (const auto& [vC, cost] : candidates.getCandidates(vCurr))
+      {
+        if (posUnvisited[vC] != visited)
+        {
+          vNext = vC;
+          break;
+        }
+      }
+      if (vNext == visited && unvisitedTree)
+      {
+        ++numFallbacks;
+        vNext = unvisitedTree->nearestActive(vCurr);
+      }
+      else if (vNext == visited)
+      {
+        ++numFallbacks;
+        CostTy minCost = std::numeric_limits<CostTy>::max();
+        for (const size_t vX : unvisited)
+        {
+          const CostTy cost = g.getEdgeCost(vCurr, vX);
+          if (cost < minCost || (cost == minCost && vX < vNext))
+          {
+            minCost = cost;
+            vNext = vX;
+          }
+        }
+      }
+      seq.emplace_back(vNext);
+      markVisited(vNext);
+    }
+    SPDLOG_DEBUG(
+        "nearest-neighbor tour: {:d} of {:d} steps fell back to a linear scan",
+        numFallbacks, numV - 1);
+    return PermTour(seq, numV);
+  }
+
+  template PermTour nearestNeighborTour<float>(
+    const AbstractCompGraph<float> &, const CandidateSet<float> &, size_t);
+  template PermTour nearestNeighborTour<int>(
+    const AbstractCompGraph<int> &, const CandidateSet<int> &, size_t);
+  template PermTour nearestNeighborTour<uint16_t>(
+    const AbstractCompGraph<uint16_t> &, const CandidateSet<uint16_t> &, size_t);
+  template PermTour nearestNeighborTour<int16_t>(
+    const AbstractCompGraph<int16_t> &, const CandidateSet<int16_t> &, size_t);
+  template PermTour nearestNeighborTour<uint32_t>(
+    const AbstractCompGraph<uint32_t> &, const CandidateSet<uint32_t> &, size_t);
+}
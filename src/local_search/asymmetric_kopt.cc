@@ -0,0 +1,467 @@
+// #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_DEBUG
+#include <spdlog/spdlog.h>
+
+#include "xtsp/local_search/asymmetric_kopt.h"
+#include "../toolbox/devirtualize.h"
+#include "../toolbox/ring_ops.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace xtsp::algo
+{
+  template <typename CostTy>
+  AsymmetricTwoOptFinder<CostTy>::AsymmetricTwoOptFinder(
+      const AbstractCompGraph<CostTy> &g, size_t numNeighbors, size_t maxSegmentLength)
+    : m_candidates(CandidateSet<CostTy>::fromGraph(g, numNeighbors)),
+      m_maxSegLen(maxSegmentLength),
+      m_queue(g.numVertices())
+  {
+    if (g.numVertices() < 5)
+      throw std::invalid_argument("AsymmetricTwoOptFinder ctor: the graph is too small");
+  }
+
+  template <typename CostTy>
+  AsymmetricTwoOptFinder<CostTy>::AsymmetricTwoOptFinder(
+      const CandidateSet<CostTy> &candidates, size_t maxSegmentLength)
+    : m_candidates(candidates),
+      m_maxSegLen(maxSegmentLength),
+      m_queue(candidates.numVertices())
+  {
+    if (candidates.numVertices() < 5)
+      throw std::invalid_argument("AsymmetricTwoOptFinder ctor: the graph is too small");
+  }
+
+  template <typename CostTy>
+  typename AsymmetricTwoOptFinder<CostTy>::SumTy AsymmetricTwoOptFinder<CostTy>::minGain() const
+  {
+    if constexpr (std::is_floating_point_v<CostTy>)
+      return 1e-9 * std::max(1.0, std::abs(m_fwdSums.back()));
+    else
+      return 0;
+  }
+
+  template <typename CostTy>
+  template <typename GraphTy>
+  void AsymmetricTwoOptFinder<CostTy>::update_(
+      size_t rankStart, size_t length, const GraphTy &g)
+  {
+    const size_t n = m_seq.size();
+    if (rankStart + length > n) // i.e., wrapped
+    {
+      rankStart = 0;
+      length = n;
+    }
+    for (size_t rank = rankStart; rank < rankStart + length; ++rank)
+      m_rankOf[m_seq[rank]] = rank;
+    // the edge into rankStart has changed too
+    for (size_t rank = (rankStart == 0 ? 0 : rankStart - 1); rank < n; ++rank)
+    {
+      const size_t vFrom = m_seq[rank];
+      const size_t vTo = m_seq[rank + 1 == n ? 0 : rank + 1];
+      m_fwdSums[rank + 1] = m_fwdSums[rank] + g.getEdgeCost(vFrom, vTo);
+      m_bwdSums[rank + 1] = m_bwdSums[rank] + g.getEdgeCost(vTo, vFrom);
+    }
+  }
+
+  template <typename CostTy>
+  template <typename GraphTy>
+  typename AsymmetricTwoOptFinder<CostTy>::SumTy AsymmetricTwoOptFinder<CostTy>::twoOptGain_(
+      size_t vA, size_t vC, const GraphTy &g) const
+  {
+    // A -> B ... C -> D becomes A -> C ... B -> D
+    const size_t vB = next(vA);
+    const size_t vD = next(vC);
+    return SumTy(g.getEdgeCost(vA, vB)) + g.getEdgeCost(vC, vD) + pathCost(vB, vC)
+      - g.getEdgeCost(vA, vC) - g.getEdgeCost(vB, vD) - reversedPathCost(vB, vC);
+  }
+
+  template <typename CostTy>
+  template <typename GraphTy>
+  TwoOptQueryResults<CostTy> AsymmetricTwoOptFinder<CostTy>::query2OptGivenA_(
+      size_t vA, const GraphTy &g, bool firstImprovement) const
+  {
+    const SumTy gainMin = minGain();
+    const auto neighbors = m_candidates.getCandidates(vA);
+
+    // Case 1: remove A -> B and C -> D, add A -> C and B -> D
+    //         i.e., tour.exchangeTwoEdges(A, C)
+    TwoOptQueryResults<CostTy> resOut(vA);
+    const size_t vB = next(vA);
+    const CostTy cAB = g.getEdgeCost(vA, vB);
+    for (const auto& [vC, cAC] : neighbors)
+    {
+      if (cAC >= cAB) // the remaining neighbors are even farther away
+        break;
+      if (vC == vB || next(vC) == vA)
+        continue;
+      const SumTy gain = twoOptGain_(vA, vC, g);
+      if (gain > gainMin && resOut.updateIfBetter(gain, vC) && firstImprovement)
+        return resOut;
+    }
+
+    // Case 2: remove P -> A and Q -> C, add P -> Q and A -> C
+    //         where P = prev(A), Q = prev(C)
+    //         i.e., tour.exchangeTwoEdges(P, Q)
+    const size_t vP = prev(vA);
+    TwoOptQueryResults<CostTy> resIn(vP);
+    const CostTy cPA = g.getEdgeCost(vP, vA);
+    for (const auto& [vC, cAC] : neighbors)
+    {
+      if (cAC >= cPA)
+        break;
+      const size_t vQ = prev(vC);
+      if (vC == vP || vQ == vA)
+        continue;
+      const SumTy gain = twoOptGain_(vP, vQ, g);
+      if (gain > gainMin && resIn.updateIfBetter(gain, vQ) && firstImprovement)
+        return resIn;
+    }
+    return (resIn.improvement > resOut.improvement) ? resIn : resOut;
+  }
+
+  template <typename CostTy>
+  template <typename GraphTy>
+  bool AsymmetricTwoOptFinder<CostTy>::querySegment_(
+      size_t vS1, size_t vS2, const GraphTy &g,
+      bool firstImprovement, OrOptQueryResults<CostTy> &res) const
+  {
+    const size_t n = m_seq.size();
+    const size_t vO = prev(vS1);
+    const size_t vN = next(vS2);
+    // the gain of taking the segment out (O -> N instead)
+    const SumTy gainOut = SumTy(g.getEdgeCost(vO, vS1))
+      + g.getEdgeCost(vS2, vN) - g.getEdgeCost(vO, vN);
+    if (gainOut <= 0)
+      return false;
+    const SumTy gainMin = minGain();
+    const size_t segLen = (m_rankOf[vS2] + n - m_rankOf[vS1])%n + 1;
+    auto isOnSegment = [&](size_t v)
+    {
+      return (m_rankOf[v] + n - m_rankOf[vS1])%n < segLen;
+    };
+    // what the segment gains by being reversed
+    const SumTy gainReversal = pathCost(vS1, vS2) - reversedPathCost(vS1, vS2);
+
+    // insert it between P and Q = next(P), as P -> first ... last -> Q
+    // where last -> Q is a candidate edge
+    for (const bool reversed : {false, true})
+    {
+      const size_t vFirst = reversed ? vS2 : vS1;
+      const size_t vLast = reversed ? vS1 : vS2;
+      const SumTy gainMax = gainOut + (reversed ? std::max(gainReversal, SumTy(0)) : 0);
+      for (const auto& [vQ, cLastQ] : m_candidates.getCandidates(vLast))
+      {
+        if (cLastQ >= gainMax) // the remaining neighbors are even farther away
+          break;
+        const size_t vP = prev(vQ);
+        if (isOnSegment(vP) || isOnSegment(vQ))
+          continue;
+        SumTy gain = gainOut - g.getEdgeCost(vP, vFirst) - cLastQ + g.getEdgeCost(vP, vQ);
+        if (reversed)
+          gain += gainReversal;
+        if (gain > gainMin && res.updateIfBetter(gain, vS1, vS2, vP, reversed)
+            && firstImprovement)
+          return true;
+      }
+    }
+    return false;
+  }
+
+  template <typename CostTy>
+  template <typename GraphTy>
+  OrOptQueryResults<CostTy> AsymmetricTwoOptFinder<CostTy>::queryOrOptGivenX_(
+      size_t vX, const GraphTy &g, bool firstImprovement) const
+  {
+    OrOptQueryResults<CostTy> res;
+    // leave at least 3 vertices out of the segment
+    const size_t maxLen = std::min(m_maxSegLen, m_seq.size() - 3);
+    // the segments X -> ... (i.e., starting at X)
+    for (size_t len = 1, vEnd = vX; len <= maxLen; ++len, vEnd = next(vEnd))
+    {
+      if (querySegment_(vX, vEnd, g, firstImprovement, res))
+        return res;
+    }
+    // the segments ... -> X (i.e., ending at X)
+    for (size_t len = 2, vBegin = prev(vX); len <= maxLen; ++len, vBegin = prev(vBegin))
+    {
+      if (querySegment_(vBegin, vX, g, firstImprovement, res))
+        return res;
+    }
+    return res;
+  }
+
+  template <typename CostTy>
+  LocalSearchOutcome<CostTy> AsymmetricTwoOptFinder<CostTy>::solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement, StopCriterion<CostTy> *stop)
+  {
+    return internal::visitConcreteTour(tour, [&](auto &t) {
+      return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+        return solve_(t, gConcrete, firstImprovement, stop);
+      });
+    });
+  }
+
+  template <typename CostTy>
+  template <typename TourTy, typename GraphTy>
+  LocalSearchOutcome<CostTy> AsymmetricTwoOptFinder<CostTy>::solve_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement,
+      StopCriterion<CostTy> *stop)
+  {
+    if (tour.maxSize() != g.numVertices() || !tour.isHamiltonian())
+      throw std::invalid_argument(
+          "AsymmetricTwoOptFinder::solve expects a Hamiltonian tour of the graph");
+    if (m_candidates.numVertices() != g.numVertices())
+      throw std::invalid_argument(
+          "AsymmetricTwoOptFinder::solve: the neighbor lists don't match the graph");
+    const size_t n = tour.size();
+    m_seq.resize(n);
+    m_seq[0] = tour.getDepotId();
+    for (size_t rank = 1; rank < n; ++rank)
+      m_seq[rank] = tour.next(m_seq[rank - 1]);
+    m_rankOf.resize(n);
+    m_fwdSums.assign(n + 1, 0);
+    m_bwdSums.assign(n + 1, 0);
+    update_(0, n, g);
+    LocalSearchOutcome<CostTy> outcome;
+    if (stop != nullptr)
+      stop->start(evalTour<CostTy>(tour, g));
+
+    // as in NeighborListTwoOptFinder, the last round reactivates
+    // all vertices to confirm that no move is left
+    size_t numMovesThisRound;
+    do
+    {
+      numMovesThisRound = 0;
+      AccumTy<CostTy> improvementThisRound = 0;
+      m_queue.clear();
+      for (const size_t v : m_seq)
+        m_queue.push(v);
+
+      bool interrupted = false;
+      while (!m_queue.isEmpty())
+      {
+        if (stop != nullptr && stop->shouldStop())
+        {
+          interrupted = true;
+          break;
+        }
+        const size_t vX = m_queue.pop();
+        const auto res2Opt = query2OptGivenA_(vX, g, firstImprovement);
+        if (res2Opt.isValid())
+        {
+          const size_t vA = res2Opt.vA, vB = next(res2Opt.vA);
+          const size_t vC = res2Opt.vC, vD = next(res2Opt.vC);
+          SPDLOG_DEBUG("Perform an asymmetric 2-opt move: A = {:d}, C = {:d}", vA, vC);
+          const size_t rankB = m_rankOf[vB];
+          const size_t lenBC = (m_rankOf[vC] + n - rankB)%n + 1;
+          tour.exchangeTwoEdges(vA, vC, true);
+          const auto touched = internal::reverseRingSegment_strict(
+            m_seq, rankB, rankB + lenBC - 1);
+          update_(touched.start, touched.length, g);
+          improvementThisRound += res2Opt.improvement;
+          ++numMovesThisRound;
+          if (stop != nullptr)
+            stop->recordImprovement(res2Opt.improvement);
+          for (const size_t v : {vA, vB, vC, vD})
+            m_queue.push(v);
+          continue;
+        }
+        if (m_maxSegLen == 0)
+          continue;
+        const auto resOrOpt = queryOrOptGivenX_(vX, g, firstImprovement);
+        if (!resOrOpt.isValid())
+          continue; // i.e., turn on the don't-look bit of X
+
+        const size_t vO = prev(resOrOpt.vS1), vN = next(resOrOpt.vS2);
+        const size_t vP = resOrOpt.vP, vQ = next(resOrOpt.vP);
+        SPDLOG_DEBUG("Perform an asymmetric Or-opt move: S1 = {:d}, S2 = {:d}, P = {:d}, reversed = {}",
+          resOrOpt.vS1, resOrOpt.vS2, vP, resOrOpt.reversed);
+        const size_t rankS1 = m_rankOf[resOrOpt.vS1];
+        const size_t segLen = (m_rankOf[resOrOpt.vS2] + n - rankS1)%n + 1;
+        tour.moveSegment(resOrOpt.vS1, resOrOpt.vS2, vP, resOrOpt.reversed);
+        const auto touched = internal::moveRingSegment(
+          m_seq, rankS1, segLen, m_rankOf[vP], resOrOpt.reversed, m_segBuf);
+        update_(touched.start, touched.length, g);
+        improvementThisRound += resOrOpt.improvement;
+        ++numMovesThisRound;
+        if (stop != nullptr)
+          stop->recordImprovement(resOrOpt.improvement);
+        for (const size_t v : {vO, resOrOpt.vS1, resOrOpt.vS2, vN, vP, vQ})
+          m_queue.push(v);
+      }
+      SPDLOG_INFO(
+        "asymmetric 2-opt/Or-opt: improved by {} using {:d} moves",
+        improvementThisRound, numMovesThisRound);
+      outcome.update(improvementThisRound, numMovesThisRound, interrupted);
+      if (stop != nullptr && stop->endRound(tour))
+        break;
+    } while (numMovesThisRound > 0);
+    assert(std::all_of(m_seq.cbegin(), m_seq.cend(),
+      [&](size_t v) { return tour.next(v) == next(v); }));
+    return outcome;
+  }
+
+  template <typename CostTy>
+  OrThreeOptFinder<CostTy>::OrThreeOptFinder(
+      const AbstractCompGraph<CostTy> &g, size_t numNeighbors)
+    : m_candidates(CandidateSet<CostTy>::fromGraph(g, numNeighbors)),
+      m_queue(g.numVertices())
+  {
+    if (g.numVertices() < 5)
+      throw std::invalid_argument("OrThreeOptFinder ctor: the graph is too small");
+  }
+
+  template <typename CostTy>
+  OrThreeOptFinder<CostTy>::OrThreeOptFinder(const CandidateSet<CostTy> &candidates)
+    : m_candidates(candidates),
+      m_queue(candidates.numVertices())
+  {
+    if (candidates.numVertices() < 5)
+      throw std::invalid_argument("OrThreeOptFinder ctor: the graph is too small");
+  }
+
+  template <typename CostTy>
+  OrThreeOptQueryResults<CostTy> OrThreeOptFinder<CostTy>::queryMoveGivenA(
+      const AbstractTour &tour, size_t vA, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement) const
+  {
+    return internal::visitConcreteTour(tour, [&](const auto &t) {
+      return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+        return queryMoveGivenA_(t, vA, gConcrete, firstImprovement);
+      });
+    });
+  }
+
+  template <typename CostTy>
+  template <typename TourTy, typename GraphTy>
+  OrThreeOptQueryResults<CostTy> OrThreeOptFinder<CostTy>::queryMoveGivenA_(
+      const TourTy &tour, size_t vA, const GraphTy &g,
+      bool firstImprovement) const
+  {
+    OrThreeOptQueryResults<CostTy> res;
+    const size_t vA1 = tour.next(vA); // i.e., A'
+    const AccumTy<CostTy> cAA1 = g.getEdgeCost(vA, vA1);
+    for (const auto& [vB1, cAB1] : m_candidates.getCandidates(vA))
+    {
+      const AccumTy<CostTy> g1 = cAA1 - cAB1;
+      if (g1 <= 0) // the remaining neighbors are even farther away
+        break;
+      if (vB1 == vA1)
+        continue;
+      const size_t vB = tour.prev(vB1);
+      const AccumTy<CostTy> g1Open = g1 + g.getEdgeCost(vB, vB1);
+      for (const auto& [vC1, cBC1] : m_candidates.getCandidates(vB))
+      {
+        const AccumTy<CostTy> g2 = g1Open - cBC1;
+        if (g2 <= 0)
+          break;
+        // C must be on the path B' -> ... -> prev(A)
+        const size_t vC = tour.prev(vC1);
+        if (vC == vA || vC1 == vB1 || !tour.between(vB1, vC, vA))
+          continue;
+        const AccumTy<CostTy> gain = g2 + g.getEdgeCost(vC, vC1) - g.getEdgeCost(vC, vA1);
+        if (res.updateIfBetter(gain, vA, vB, vC) && firstImprovement)
+          return res;
+      }
+    }
+    return res;
+  }
+
+  template <typename CostTy>
+  void OrThreeOptFinder<CostTy>::applyMove(
+      AbstractTour &tour, const OrThreeOptQueryResults<CostTy> &res)
+  {
+    if (!res.isValid())
+      throw std::invalid_argument("Trying to apply an invalid or-3opt move");
+    // i.e., A' -> ... -> B goes between C and C'
+    tour.moveSegment(tour.next(res.vA), res.vB, res.vC, false);
+  }
+
+  template <typename CostTy>
+  LocalSearchOutcome<CostTy> OrThreeOptFinder<CostTy>::solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement, StopCriterion<CostTy> *stop)
+  {
+    return internal::visitConcreteTour(tour, [&](auto &t) {
+      return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+        return solve_(t, gConcrete, firstImprovement, stop);
+      });
+    });
+  }
+
+  template <typename CostTy>
+  template <typename TourTy, typename GraphTy>
+  LocalSearchOutcome<CostTy> OrThreeOptFinder<CostTy>::solve_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement,
+      StopCriterion<CostTy> *stop)
+  {
+    if (tour.maxSize() != g.numVertices() || !tour.isHamiltonian())
+      throw std::invalid_argument(
+          "OrThreeOptFinder::solve expects a Hamiltonian tour of the graph");
+    if (m_candidates.numVertices() != g.numVertices())
+      throw std::invalid_argument(
+          "OrThreeOptFinder::solve: the neighbor lists don't match the graph");
+    LocalSearchOutcome<CostTy> outcome;
+    if (stop != nullptr)
+      stop->start(evalTour<CostTy>(tour, g));
+
+    size_t numMovesThisRound;
+    do
+    {
+      numMovesThisRound = 0;
+      AccumTy<CostTy> improvementThisRound = 0;
+      m_queue.clear();
+      for (size_t v = tour.getDepotId(), k = 0; k < tour.size(); ++k, v = tour.next(v))
+        m_queue.push(v);
+
+      bool interrupted = false;
+      while (!m_queue.isEmpty())
+      {
+        if (stop != nullptr && stop->shouldStop())
+        {
+          interrupted = true;
+          break;
+        }
+        const size_t vA = m_queue.pop();
+        const auto res = queryMoveGivenA_(tour, vA, g, firstImprovement);
+        if (!res.isValid())
+          continue; // i.e., turn on the don't-look bit of A
+
+        const size_t vA1 = tour.next(res.vA);
+        const size_t vB1 = tour.next(res.vB);
+        const size_t vC1 = tour.next(res.vC);
+        SPDLOG_DEBUG("Perform an or-3opt move: A = {:d}, B = {:d}, C = {:d}",
+          res.vA, res.vB, res.vC);
+        tour.moveSegment(vA1, res.vB, res.vC, false);
+        improvementThisRound += res.improvement;
+        ++numMovesThisRound;
+        if (stop != nullptr)
+          stop->recordImprovement(res.improvement);
+        for (const size_t v : {res.vA, vA1, res.vB, vB1, res.vC, vC1})
+          m_queue.push(v);
+      }
+      SPDLOG_INFO(
+        "or-3opt: improved by {} using {:d} moves",
+        improvementThisRound, numMovesThisRound);
+      outcome.update(improvementThisRound, numMovesThisRound, interrupted);
+      if (stop != nullptr && stop->endRound(tour))
+        break;
+    } while (numMovesThisRound > 0);
+    return outcome;
+  }
+
+  // explicit template instantiation
+  template class AsymmetricTwoOptFinder<float>;
+  template class AsymmetricTwoOptFinder<int>;
+  template class AsymmetricTwoOptFinder<uint16_t>;
+  template class AsymmetricTwoOptFinder<int16_t>;
+  template class AsymmetricTwoOptFinder<uint32_t>;
+  template class OrThreeOptFinder<float>;
+  template class OrThreeOptFinder<int>;
+  template class OrThreeOptFinder<uint16_t>;
+  template class OrThreeOptFinder<int16_t>;
+  template class OrThreeOptFinder<uint32_t>;
+}
@@ -1,4 +1,5 @@
 #include "xtsp/local_search/gtsp_only.h"
+#include "../toolbox/devirtualize.h"
 
 // Eliminate some logging at compile time
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
@@ -17,11 +18,26 @@ namespace xtsp::algo
   }
 
   template <typename CostTy>
-  CostTy GtspClusterOptimizer<CostTy>::solve(
+  AccumTy<CostTy> GtspClusterOptimizer<CostTy>::solve(
     const xtsp::GeneralizedTour& tour, 
     const xtsp::AbstractCompGraph<CostTy>& graph, 
     size_t cutCluster,
-    std::vector<size_t>& overallBestVertexSeq)
+    std::vector<size_t>& overallBestVertexSeq,
+    StopCriterion<CostTy> *stop)
+  {
+    return internal::visitConcreteGraph(graph, [&](const auto& graphConcrete) {
+      return solve_(tour, graphConcrete, cutCluster, overallBestVertexSeq, stop);
+    });
+  }
+
+  template <typename CostTy>
+  template <typename GraphTy, typename SeqTy>
+  AccumTy<CostTy> GtspClusterOptimizer<CostTy>::solve_(
+    const xtsp::GeneralizedTour& tour, 
+    const GraphTy& graph, 
+    size_t cutCluster,
+    SeqTy& overallBestVertexSeq,
+    StopCriterion<CostTy> *stop)
   {
     if (graph.getClusteringInfo() != tour.getClusteringInfo())
     {
@@ -43,12 +59,21 @@ namespace xtsp::algo
     assert(tour.numClusters() == numClusters);
     assert(tour.numVertices() == graph.numVertices());
 
+    // (before the output overwrites the tour's sequence in \p improve )
+    if (stop != nullptr)
+      stop->start(evalTour<CostTy>(*tour.getTour(), graph));
+    // The tour's own vertex of cutCluster goes first (swapped with the first
+    // member): its DP considers the tour itself, so it never returns anything
+    // worse, and an early stop after it never makes the tour worse.
+    const auto& cutMembers = clustering->getMembers(cutCluster);
+    const size_t tourCutVertex = tour.getVertexByClusterId(cutCluster);
+
     // initialize the outputs 
     // (overall among the optimal solutions of all cut vertices)
-    CostTy overallBestCost = std::numeric_limits<CostTy>::max();
+    AccumTy<CostTy> overallBestCost = std::numeric_limits<AccumTy<CostTy>>::max();
     overallBestVertexSeq.clear();
     overallBestVertexSeq.resize(
-      numClusters, std::numeric_limits<size_t>::max());
+      numClusters, std::numeric_limits<typename SeqTy::value_type>::max());
 
     SPDLOG_INFO("CO begins: cutCluster size = {:d})",
       clustering->getClusterSize(cutCluster));
@@ -57,8 +82,12 @@ namespace xtsp::algo
     size_t rankCutCluster = tour.findClusterRankById(cutCluster);
 
     /// ideally this outer loop is iterated just once
-    for (const size_t cutVertex : clustering->getMembers(cutCluster))
+    bool hasResult = false;
+    for (size_t k = 0; k < cutMembers.size(); ++k)
     {
+      const size_t cutVertex = (k == 0) ? tourCutVertex
+        : (cutMembers[k] == tourCutVertex ? cutMembers[0] : cutMembers[k]);
+      bool interrupted = false;
       /// initialize
       this->clearBuf();
       // notice it's the number of vertices not the number of clusters M
@@ -74,10 +103,23 @@ namespace xtsp::algo
       ///@todo benchmark runtime-performance
       for (size_t i = 1; i < numClusters; ++i)
       {
+        // an unfinished DP is discarded, so the first one always finishes
+        if (hasResult && stop != nullptr && stop->shouldStop())
+        {
+          interrupted = true;
+          break;
+        }
         size_t rankPos = rankCutCluster + (numClusters - i);
         rankPos = rankPos%numClusters;
         size_t thisClusterId = tour.getClusterIdByRank(rankPos);
-        const std::vector<size_t>& thisCluster = clustering->getMembers(thisClusterId);
+        const auto& thisCluster = clustering->getMembers(thisClusterId);
+        if (i > 1)
+        {
+          // widen the next cluster once for all the vertices of this cluster
+          size_t nextClusterId = tour.getClusterIdByRank((rankPos+1)%numClusters);
+          const auto& nextCluster = clustering->getMembers(nextClusterId);
+          m_nextClusterBuf.assign(nextCluster.cbegin(), nextCluster.cend());
+        }
         for (const size_t vertex : thisCluster)
         {
           // a terminal state (after that, the tour goes to cutVertex again)
@@ -93,21 +135,23 @@ namespace xtsp::algo
           {
             SPDLOG_DEBUG("intermediate vertex: n = {:d}, m = {:d}, rank: {:d}", 
               vertex, thisClusterId, rankPos);
-            size_t nextClusterId = tour.getClusterIdByRank((rankPos+1)%numClusters);
-            const std::vector<size_t>& nextCluster = clustering->getMembers(nextClusterId); 
-            this->backpassStep(
-              vertex, nextCluster, 
-              [& graph](size_t from, size_t to){return graph.getEdgeCost(from,to);});
+            this->backpassStep(vertex, m_nextClusterBuf, graph);
           }
         }
       }
 
+      if (interrupted)
+      {
+        SPDLOG_INFO("CO: stopped early (reason {:d})",
+          static_cast<int>(stop->stopReason()));
+        break;
+      }
+
       /// the last backward pass (the step from cutVertex to the next cluster's)
       size_t nextClusterId = tour.getClusterIdByRank((rankCutCluster+1)%numClusters);
-      const std::vector<size_t>& nextCluster = clustering->getMembers(nextClusterId); 
-      this->backpassStep(
-        cutVertex, nextCluster,
-        [& graph](size_t from, size_t to){return graph.getEdgeCost(from,to);});
+      const auto& nextCluster = clustering->getMembers(nextClusterId); 
+      m_nextClusterBuf.assign(nextCluster.cbegin(), nextCluster.cend());
+      this->backpassStep(cutVertex, m_nextClusterBuf, graph);
 
       /// The forward-pass.
       /// We only need to do it if this cutVertex leads to a new best.
@@ -115,6 +159,7 @@ namespace xtsp::algo
       /// Alternatively, we could also just copy the costToGo and bestNextVertex
       /// to somewhere
       /// and defer the forward pass until the end.
+      bool improvedTour = false;
       if (this->costToGo[cutVertex] < overallBestCost)
       {
         overallBestCost = this->costToGo[cutVertex];
@@ -135,23 +180,57 @@ namespace xtsp::algo
           overallBestVertexSeq[(rankCutCluster+delta)%numClusters] = nextBestVertex;
           thisVertex_ = nextBestVertex;
         }
+        // (the first DP may also settle on the tour's own cost,
+        // which keeps stop->cost() equal to overallBestCost)
+        if (stop != nullptr)
+        {
+          improvedTour = overallBestCost < stop->cost();
+          stop->recordImprovement(stop->cost() - overallBestCost);
+        }
+      }
+      hasResult = true;
+
+      if (stop != nullptr)
+      {
+        bool stopNow;
+        if (improvedTour && stop->hasProgressCallback())
+        {
+          const PermTour bestSoFar(
+            std::vector<size_t>(overallBestVertexSeq.cbegin(), overallBestVertexSeq.cend()),
+            static_cast<int>(graph.numVertices()), false);
+          stopNow = stop->endRound(bestSoFar);
+        }
+        else
+        {
+          stopNow = stop->endRound();
+        }
+        if (stopNow)
+        {
+          SPDLOG_INFO("CO: stopped early (reason {:d})",
+            static_cast<int>(stop->stopReason()));
+          break;
+        }
       }
     }
     return overallBestCost;
   }
 
   template <typename CostTy>
-  CostTy GtspClusterOptimizer<CostTy>::improve(
+  AccumTy<CostTy> GtspClusterOptimizer<CostTy>::improve(
     xtsp::GeneralizedTour &tour, 
     const xtsp::AbstractCompGraph<CostTy> &graph, 
-    size_t cutCluster)
+    size_t cutCluster,
+    StopCriterion<CostTy> *stop)
   {
     // during the solve, we don't need to use tour.m_seq.
     // So we can safely "reuse" it as the output buffer for
     // the `solve` call. 
     // This guarantees that there is no memory allocation
     // during this `improve` routine.
-    CostTy newCost = this->solve(tour, graph, cutCluster, tour.getTourMutable__()->getSeqMutableRef__());
+    auto& seq = tour.getTourMutable__()->getSeqMutableRef__();
+    AccumTy<CostTy> newCost = internal::visitConcreteGraph(graph, [&](const auto& graphConcrete) {
+      return solve_(tour, graphConcrete, cutCluster, seq, stop);
+    });
     return newCost;
 
     // // In the case of Cluster Optimization, 
@@ -163,5 +242,8 @@ namespace xtsp::algo
   // explicit template instantiation
   template class GtspClusterOptimizer<float>;
   template class GtspClusterOptimizer<int>;
+  template class GtspClusterOptimizer<uint16_t>;
+  template class GtspClusterOptimizer<int16_t>;
+  template class GtspClusterOptimizer<uint32_t>;
 
 } // namespace xtsp::algo
\ No newline at end of file
@@ -2,12 +2,55 @@
 #include <spdlog/spdlog.h>
 
 #include "xtsp/local_search/kopt.h"
+#include "../toolbox/cost_kernels.h"
+#include "../toolbox/devirtualize.h"
+#include "../toolbox/sequential_moves.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <type_traits>
 
 namespace xtsp::algo
 {
+  // the best (or the first) improving C of a chunk, the costs are 
+  // reduced 8-16 candidates at a time for float and int
+  // (see internal::bestTwoOptCandidate), returns len if none
   template <typename CostTy>
-  TwoOptQueryResults<CostTy> find2OptMoveGivenA(
-      const AbstractTour &tour, size_t vA, const AbstractCompGraph<CostTy> &g,
+  static size_t bestTwoOptCandidate_(
+      AccumTy<CostTy> cAB, const CostTy* costCD, const CostTy* costAC, 
+      const CostTy* costBD, size_t len, bool firstImprovement, 
+      AccumTy<CostTy> &bestImprovement)
+  {
+    if constexpr (std::is_same_v<CostTy, float> || std::is_same_v<CostTy, int>)
+    {
+      return internal::bestTwoOptCandidate(
+        cAB, costCD, costAC, costBD, len, firstImprovement, bestImprovement);
+    }
+    else
+    {
+      size_t kBest = len;
+      for (size_t k = 0; k < len; ++k)
+      {
+        const AccumTy<CostTy> improvement 
+          = (cAB + costCD[k]) - (AccumTy<CostTy>(costAC[k]) + costBD[k]);
+        if (improvement > bestImprovement)
+        {
+          bestImprovement = improvement;
+          kBest = k;
+          if (firstImprovement)
+            break;
+        }
+      }
+      return kBest;
+    }
+  }
+
+  // the actual scan, templated on the concrete tour and graph types 
+  // so that the per-vertex/per-edge calls can be inlined
+  template <typename CostTy, typename TourTy, typename GraphTy>
+  static TwoOptQueryResults<CostTy> find2OptMoveGivenA_(
+      const TourTy &tour, size_t vA, const GraphTy &g,
       bool firstImprovement)
   {
     if (tour.size() < 4)
@@ -17,37 +60,69 @@ namespace xtsp::algo
           "Currently the 2-opt implementation doesn't support assymmetric TSP yet");
     TwoOptQueryResults<CostTy> result(vA);
     const auto vB = tour.next(vA);
-    const CostTy cAB = g.getEdgeCost(vA, vB);
+    const AccumTy<CostTy> cAB = g.getEdgeCost(vA, vB);
+
+    // We walk along the tour in chunks: first collect the next 
+    // few vertices C (plus the D after the last one), then fetch 
+    // the costs A-C and B-D for the whole chunk in two batched queries.
+    constexpr size_t chunkSize = 64;
+    std::array<size_t, chunkSize + 1> seqC;
+    std::array<CostTy, chunkSize> costAC, costBD, costCD;
+    // a PermTour is read in rank order straight from its sequence,
+    // i.e., without a rank look-up per C
+    constexpr bool isPermTour = std::is_same_v<TourTy, PermTour>;
+    const size_t n = tour.size();
+    size_t rankC = 0;
+    if constexpr (isPermTour)
+      rankC = (tour.getRank_(vB) + 1)%n;
     auto vC = tour.next(vB);
     // notice the termination condition 
     // (which guarantee each iteration ABCD is valid);
-    for (size_t ii = 0; ii < tour.size() - 3; ++ii)
+    const size_t numC = n - 3;
+    for (size_t iiBegin = 0; iiBegin < numC; iiBegin += chunkSize)
     {
-      auto vD = tour.next(vC);
-      // our for-loop should never let vD == vA
-      SPDLOG_DEBUG(
-        "ii = {:d}: A,B,C,D = {:d},{:d},{:d},{:d} (tour: {})",
-        ii, vA, vB, vC, vD, tour.print());
-      assert(vD != vA);
+      const size_t len = std::min(chunkSize, numC - iiBegin);
+      if constexpr (isPermTour)
+      {
+        for (size_t k = 0, rank = rankC; k <= len; ++k, ++rank)
+        {
+          if (rank == n)
+            rank = 0;
+          seqC[k] = tour.getVertex_(rank);
+        }
+        rankC = (rankC + len)%n;
+      }
+      else
+      {
+        seqC[0] = vC;
+        for (size_t k = 0; k < len; ++k)
+          seqC[k+1] = tour.next(seqC[k]);
+      }
+      for (size_t k = 0; k < len; ++k)
+        costCD[k] = g.getEdgeCost(seqC[k], seqC[k+1]);
+      g.getEdgeCosts(vA, seqC.data(), len, costAC.data());
+      g.getEdgeCosts(vB, seqC.data() + 1, len, costBD.data());
 
-      CostTy oldComponent = cAB + g.getEdgeCost(vC, vD);
-      CostTy newComponent = g.getEdgeCost(vA, vC) + g.getEdgeCost(vB, vD);
+      // our for-loop should never let vD == vA
+      assert(seqC[len] != vA);
       // we assume flipping either segment BC or AD
       // has no impact on their respective tour cost component
       // (we can take care of it later if we want to support ATSP)
-      CostTy improvement = oldComponent - newComponent;
-      bool isAccepted = result.updateIfBetter(improvement, vC);
-      if (isAccepted)
+      AccumTy<CostTy> improvement = result.improvement;
+      const size_t kBest = bestTwoOptCandidate_<CostTy>(
+        cAB, costCD.data(), costAC.data(), costBD.data(), len,
+        firstImprovement, improvement);
+      if (kBest < len)
       {
-        SPDLOG_DEBUG("accepted the move with improvement: {}", improvement);
+        SPDLOG_DEBUG(
+          "accepted the move A,B,C,D = {:d},{:d},{:d},{:d} with improvement: {}",
+          vA, vB, seqC[kBest], seqC[kBest+1], improvement);
+        result.updateIfBetter(improvement, seqC[kBest]);
+        if (firstImprovement)
+          return result;
       }
-      if (isAccepted && firstImprovement)
-      {
-        return result;
-      }
-
-      // update for the next iter
-      vC = tour.next(vC);
+      // the first C of the next chunk
+      vC = seqC[len];
     }
     // if not found, return a dummy;
     // otherwise, this corresponds to the best 2-opt move for this given vertex A
@@ -55,79 +130,198 @@ namespace xtsp::algo
   }
 
   template <typename CostTy>
-  PriorityTwoOptFinder<CostTy>::PriorityTwoOptFinder(
+  TwoOptQueryResults<CostTy> find2OptMoveGivenA(
+      const AbstractTour &tour, size_t vA, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement)
+  {
+    return internal::visitConcreteTour(tour, [&](const auto &t) {
+      return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+        return find2OptMoveGivenA_<CostTy>(t, vA, gConcrete, firstImprovement);
+      });
+    });
+  }
+
+  // all tour vertices A with the cost of A -> next(A), 
+  // in the tour order (starting from the depot)
+  template <typename TourTy, typename GraphTy, typename IdxTy, typename CostTy>
+  static void collectTourEdges(
+      const TourTy &tour, const GraphTy &g,
+      std::vector<std::pair<IdxTy, CostTy>> &vAandCostAB)
+  {
+    vAandCostAB.clear();
+    vAandCostAB.reserve(tour.size());
+    size_t vA = tour.getDepotId();
+    for (size_t rank = 0; rank < tour.size(); ++rank)
+    {
+      auto vB = tour.next(vA);
+      vAandCostAB.emplace_back(static_cast<IdxTy>(vA), g.getEdgeCost(vA, vB));
+      vA = vB;
+    }
+  }
+
+  // the same, sorted in descending!!! edge cost AB, 
+  // i.e., the order of the priority sweeps
+  template <typename TourTy, typename GraphTy, typename IdxTy, typename CostTy>
+  static void orderByDescendingCostAB(
+      const TourTy &tour, const GraphTy &g,
+      std::vector<std::pair<IdxTy, CostTy>> &vAandCostAB)
+  {
+    collectTourEdges(tour, g, vAandCostAB);
+    std::sort(vAandCostAB.begin(), vAandCostAB.end(),
+              [](const std::pair<IdxTy, CostTy> &lhs, const std::pair<IdxTy, CostTy> &rhs)
+              {
+                return lhs.second > rhs.second;
+              });
+  }
+
+  template <typename CostTy, typename IdxTy>
+  PriorityTwoOptFinder<CostTy, IdxTy>::PriorityTwoOptFinder(
       const AbstractTour &tour, const AbstractCompGraph<CostTy> &g)
   {
     if (tour.maxSize() != g.numVertices())
       throw std::invalid_argument(
           "PriorityTwoOptFinder ctor: tour is inconsistent with the graph");
-    updateForNextSweep(tour, g);
+    if (tour.maxSize() > std::numeric_limits<IdxTy>::max())
+      throw std::invalid_argument(
+          "PriorityTwoOptFinder ctor: too many vertices for the index type");
+    reset(tour, g);
   }
 
-  template <typename CostTy>
-  void PriorityTwoOptFinder<CostTy>::updateForNextSweep(
+  template <typename CostTy, typename IdxTy>
+  void PriorityTwoOptFinder<CostTy, IdxTy>::reset(
       const AbstractTour &tour, const AbstractCompGraph<CostTy> &g)
+  {
+    internal::visitConcreteTour(tour, [&](const auto &t) {
+      internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+        reset_(t, gConcrete);
+      });
+    });
+  }
+
+  template <typename CostTy, typename IdxTy>
+  template <typename TourTy, typename GraphTy>
+  void PriorityTwoOptFinder<CostTy, IdxTy>::reset_(const TourTy &tour, const GraphTy &g)
   {
     // we allow the tour to be partially-Hamiltonian (e.g., in generalized TSP )
-    m_skip = std::vector<bool>(tour.maxSize(), false);
-    m_vAandCostAB.clear();
-    m_vAandCostAB.reserve(tour.size());
+    m_skipStamp.resize(tour.maxSize(), 0);
+    m_heap.clear();
+    m_heap.reserve(tour.size());
     size_t vA = tour.getDepotId();
     for (size_t rank = 0; rank < tour.size(); ++rank)
     {
-      auto vB = tour.next(vA);
-      m_vAandCostAB.emplace_back(
-        std::make_pair<size_t &, CostTy>(vA, g.getEdgeCost(vA, vB)));
+      const size_t vB = tour.next(vA);
+      m_heap.pushUnordered(vA, vB, g.getEdgeCost(vA, vB));
       vA = vB;
     }
-    // sorting (in descending!!! edge cost AB)
-    std::sort(m_vAandCostAB.begin(), m_vAandCostAB.end(),
-              [](const std::pair<size_t, CostTy> &lhs, std::pair<size_t, CostTy> &rhs)
-              {
-                return lhs.second > rhs.second;
-              });
+    m_heap.heapify();
+    m_deferredEdges.clear();
+    m_hasAllEdges = true;
+    m_tourSize = tour.size();
   }
 
-  template <typename CostTy>
-  TwoOptOutcome<CostTy> PriorityTwoOptFinder<CostTy>::tryOneSweep2Opts(
+  template <typename CostTy, typename IdxTy>
+  TwoOptOutcome<CostTy> PriorityTwoOptFinder<CostTy, IdxTy>::tryOneSweep2Opts(
       AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
-      bool firstImprovement)
+      bool firstImprovement, StopCriterion<CostTy> *stop)
+  {
+    return internal::visitConcreteTour(tour, [&](auto &t) {
+      return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+        return tryOneSweep2Opts_(t, gConcrete, firstImprovement, stop);
+      });
+    });
+  }
+
+  template <typename CostTy, typename IdxTy>
+  template <typename TourTy, typename GraphTy>
+  TwoOptOutcome<CostTy> PriorityTwoOptFinder<CostTy, IdxTy>::tryOneSweep2Opts_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement,
+      StopCriterion<CostTy> *stop)
   {
     TwoOptOutcome<CostTy> outcome;
-    updateForNextSweep(tour, g);
-    for (const auto &[vA, preComputedCostAB] : m_vAandCostAB)
+    if (++m_sweepStamp == 0) // wrapped around, so the old stamps are ambiguous
+    {
+      std::fill(m_skipStamp.begin(), m_skipStamp.end(), 0);
+      m_sweepStamp = 1;
+    }
+    if (tour.size() != m_tourSize)
+      reset_(tour, g);
+    // only the edges that changed since the last sweep
+    for (const auto &[vU, vV] : m_deferredEdges)
+      m_heap.push(vU, vV, g.getEdgeCost(vU, vV));
+    m_deferredEdges.clear();
+
+    processQueuedEdges_(tour, g, firstImprovement, stop, outcome);
+    const bool stopped = (stop != nullptr) && stop->stopped();
+    if (outcome.numMoves() == 0 && !m_hasAllEdges && !stopped)
     {
-      // the preComputedCostAB is more for prioritizing vA,
-      // during the actual twoOpt search, we will lead to we evaluate
-      // them because the precomputed cost value can be outdated
-      if (m_skip[vA])
+      // nothing left among the changed edges: 
+      // confirm with all of them in the same sweep
+      SPDLOG_DEBUG("no move among the changed edges, queuing all the tour edges");
+      reset_(tour, g);
+      processQueuedEdges_(tour, g, firstImprovement, stop, outcome);
+    }
+    m_hasAllEdges = false;
+    return outcome;
+  }
+
+  template <typename CostTy, typename IdxTy>
+  template <typename TourTy, typename GraphTy>
+  void PriorityTwoOptFinder<CostTy, IdxTy>::processQueuedEdges_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement,
+      StopCriterion<CostTy> *stop, TwoOptOutcome<CostTy> &outcome)
+  {
+    while (!m_heap.isEmpty())
+    {
+      if (stop != nullptr && stop->shouldStop())
+        return; // the rest stays queued
+      // the cost is more for prioritizing the edge, 
+      // the actual twoOpt search re-evaluates it
+      const auto edge = m_heap.pop();
+      size_t vA;
+      if (tour.next(edge.vU) == edge.vV)
+        vA = edge.vU;
+      else if (tour.next(edge.vV) == edge.vU) // i.e., flipped by a move
+        vA = edge.vV;
+      else
+        continue; // no longer a tour edge
+      if (m_skipStamp[vA] == m_sweepStamp)
+      {
+        // A is done in this sweep, but not with this edge
+        m_deferredEdges.emplace_back(edge.vU, edge.vV);
         continue;
-      auto res = find2OptMoveGivenA<CostTy>(tour, vA, g, firstImprovement);
+      }
+      auto res = find2OptMoveGivenA_<CostTy>(tour, vA, g, firstImprovement);
       assert(res.vA == vA);
-      m_skip[vA] = true;
+      m_skipStamp[vA] = m_sweepStamp;
       if (res.isValid())
       {
         /// @todo confirm empirically if this speeds up the improvement
-        m_skip[res.vC] = true;
+        m_skipStamp[res.vC] = m_sweepStamp;
 
         outcome.update(res.improvement, 1);
+        if (stop != nullptr)
+          stop->recordImprovement(res.improvement);
         /// in this Priority-based method, it might be better to 
         /// specify the sequence. @todo evidence
         SPDLOG_DEBUG("Perform a two-opt move: A = {:d}, C = {:d}", res.vA, res.vC);
         SPDLOG_DEBUG("Tour (currently): {}", tour.print());
+        const size_t vB = tour.next(res.vA);
+        const size_t vD = tour.next(res.vC);
         tour.exchangeTwoEdges(res.vA, res.vC, true);
         SPDLOG_DEBUG("Tour (new)      : {}", tour.print());
+        // i.e., A -> C and B -> D (strict)
+        m_deferredEdges.emplace_back(res.vA, res.vC);
+        m_deferredEdges.emplace_back(vB, vD);
       }
     }
-    
-    return outcome;
   }
 
-  template <typename CostTy>
-  TwoOptOutcome<CostTy> PriorityTwoOptFinder<CostTy>::solve(
+  template <typename CostTy, typename IdxTy>
+  TwoOptOutcome<CostTy> PriorityTwoOptFinder<CostTy, IdxTy>::solve(
       AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
       size_t maxNumSweeps,
-      bool firstImprovement)
+      bool firstImprovement,
+      StopCriterion<CostTy> *stop)
   {
     {
       std::string displayName;
@@ -141,6 +335,10 @@ namespace xtsp::algo
     }
     if (maxNumSweeps == 0)
       SPDLOG_WARN("priority 2-opt: Ignoring no-op request");
+    // the tour may have changed since the ctor (or the last call)
+    reset(tour, g);
+    if (stop != nullptr)
+      stop->start(evalTour(tour, g));
     TwoOptOutcome<CostTy> overallResult; // overall across all sweeps so far
     // CostTy improvementLastSweep = 1e3; // a dummy value
     for (size_t totNumSweeps = 0; totNumSweeps < maxNumSweeps; ++totNumSweeps)
@@ -148,31 +346,482 @@ namespace xtsp::algo
       SPDLOG_INFO("sweep {:d} begins", totNumSweeps+1);
 
       TwoOptOutcome<CostTy> sweepRes = tryOneSweep2Opts(
-        tour, g, firstImprovement);
+        tour, g, firstImprovement, stop);
       
       SPDLOG_INFO(
           "sweep {:d} : further improved by {} using {:d} moves", 
           totNumSweeps+1, sweepRes.improvement(), sweepRes.numMoves());
-      overallResult.update(sweepRes.improvement(), sweepRes.numMoves());
+      const bool interrupted = (stop != nullptr) && stop->stopped();
+      overallResult.update(sweepRes.improvement(), sweepRes.numMoves(), interrupted);
       /// @todo early termination if the the improvement is 
       /// very small for several sweeps in a row
       if (sweepRes.numMoves() != 0) // i.e., > 0
       {
         assert(sweepRes.improvement() > 0);
       }
-      else // i.e. (numMovesThisSweep == 0)
+      else if (!interrupted) // i.e. (numMovesThisSweep == 0)
       {
         SPDLOG_INFO(
           "no move found, so 2-opt is confirmed", 
           totNumSweeps+1);
         return overallResult;
       }
+      if (stop != nullptr && stop->endRound(tour))
+      {
+        SPDLOG_INFO("priority 2-opt: stopped early (reason {:d})",
+          static_cast<int>(stop->stopReason()));
+        return overallResult;
+      }
 
       // improvementLastSweep = sweepRes.improvement;
     }
     return overallResult;
   }
 
+  template <typename CostTy>
+  NeighborListTwoOptFinder<CostTy>::NeighborListTwoOptFinder(
+      const AbstractCompGraph<CostTy> &g, size_t numNeighbors)
+    : m_candidates(CandidateSet<CostTy>::fromGraph(g, numNeighbors)),
+      m_queue(g.numVertices())
+  {
+    if (g.numVertices() < 4)
+      throw std::invalid_argument("NeighborListTwoOptFinder ctor: the graph is too small");
+    if (!g.isSymmetric())
+      throw std::invalid_argument(
+          "Currently the 2-opt implementation doesn't support assymmetric TSP yet");
+  }
+
+  template <typename CostTy>
+  NeighborListTwoOptFinder<CostTy>::NeighborListTwoOptFinder(
+      const CandidateSet<CostTy> &candidates)
+    : m_candidates(candidates),
+      m_queue(candidates.numVertices())
+  {
+    if (candidates.numVertices() < 4)
+      throw std::invalid_argument("NeighborListTwoOptFinder ctor: the graph is too small");
+  }
+
+  template <typename CostTy>
+  TwoOptQueryResults<CostTy> NeighborListTwoOptFinder<CostTy>::queryMoveGivenA(
+      const AbstractTour &tour, size_t vA, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement) const
+  {
+    return internal::visitConcreteTour(tour, [&](const auto &t) {
+      return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+        return queryMoveGivenA_(t, vA, gConcrete, firstImprovement);
+      });
+    });
+  }
+
+  template <typename CostTy>
+  template <typename TourTy, typename GraphTy>
+  TwoOptQueryResults<CostTy> NeighborListTwoOptFinder<CostTy>::queryMoveGivenA_(
+      const TourTy &tour, size_t vA, const GraphTy &g,
+      bool firstImprovement) const
+  {
+    const auto neighbors = m_candidates.getCandidates(vA);
+
+    // Case 1: remove A -> B and C -> D, add A-C and B-D
+    //         i.e., tour.exchangeTwoEdges(A, C)
+    TwoOptQueryResults<CostTy> resOut(vA);
+    const size_t vB = tour.next(vA);
+    const AccumTy<CostTy> cAB = g.getEdgeCost(vA, vB);
+    for (const auto& [vC, cAC] : neighbors)
+    {
+      const AccumTy<CostTy> g1 = cAB - cAC;
+      if (g1 <= 0) // the remaining neighbors are even farther away
+        break;
+      const size_t vD = tour.next(vC);
+      if (vC == vB || vD == vA)
+        continue;
+      AccumTy<CostTy> improvement = g1 + g.getEdgeCost(vC, vD) - g.getEdgeCost(vB, vD);
+      if (resOut.updateIfBetter(improvement, vC) && firstImprovement)
+        return resOut;
+    }
+
+    // Case 2: remove P -> A and Q -> C, add A-C and P-Q 
+    //         where P = prev(A), Q = prev(C)
+    //         i.e., tour.exchangeTwoEdges(P, Q)
+    const size_t vP = tour.prev(vA);
+    TwoOptQueryResults<CostTy> resIn(vP);
+    const AccumTy<CostTy> cPA = g.getEdgeCost(vP, vA);
+    for (const auto& [vC, cAC] : neighbors)
+    {
+      const AccumTy<CostTy> g1 = cPA - cAC;
+      if (g1 <= 0)
+        break;
+      const size_t vQ = tour.prev(vC);
+      if (vC == vP || vQ == vA)
+        continue;
+      AccumTy<CostTy> improvement = g1 + g.getEdgeCost(vQ, vC) - g.getEdgeCost(vP, vQ);
+      if (resIn.updateIfBetter(improvement, vQ) && firstImprovement)
+        return resIn;
+    }
+    return (resIn.improvement > resOut.improvement) ? resIn : resOut;
+  }
+
+  template <typename CostTy>
+  TwoOptOutcome<CostTy> NeighborListTwoOptFinder<CostTy>::solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement, StopCriterion<CostTy> *stop)
+  {
+    return internal::visitConcreteTour(tour, [&](auto &t) {
+      return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+        return solve_(t, gConcrete, firstImprovement, stop);
+      });
+    });
+  }
+
+  template <typename CostTy>
+  template <typename TourTy, typename GraphTy>
+  TwoOptOutcome<CostTy> NeighborListTwoOptFinder<CostTy>::solve_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement,
+      StopCriterion<CostTy> *stop)
+  {
+    if (tour.maxSize() != g.numVertices() || !tour.isHamiltonian())
+      throw std::invalid_argument(
+          "NeighborListTwoOptFinder::solve expects a Hamiltonian tour of the graph");
+    if (m_candidates.numVertices() != g.numVertices())
+      throw std::invalid_argument(
+          "NeighborListTwoOptFinder::solve: the neighbor lists don't match the graph");
+    if (!g.isSymmetric())
+      throw std::invalid_argument(
+          "Currently the 2-opt implementation doesn't support assymmetric TSP yet");
+    TwoOptOutcome<CostTy> outcome;
+    if (stop != nullptr)
+      stop->start(evalTour<CostTy>(tour, g));
+
+    // A move may also reverse the orientation of a vertex's neighbor C
+    // (without touching its own tour edges), which then offers a new move
+    // that the don't-look bit would hide. So once the queue runs dry, 
+    // we reactivate all vertices to verify, which is cheap (O(NK)).
+    size_t numMovesThisRound;
+    do
+    {
+      numMovesThisRound = 0;
+      AccumTy<CostTy> improvementThisRound = 0;
+      // all vertices are initially active (following the tour order)
+      m_queue.clear();
+      size_t vHead = tour.getDepotId();
+      for (size_t rank = 0; rank < tour.size(); ++rank)
+      {
+        m_queue.push(vHead);
+        vHead = tour.next(vHead);
+      }
+
+      bool interrupted = false;
+      while (!m_queue.isEmpty())
+      {
+        if (stop != nullptr && stop->shouldStop())
+        {
+          interrupted = true;
+          break;
+        }
+        const size_t vX = m_queue.pop();
+        auto res = queryMoveGivenA_(tour, vX, g, firstImprovement);
+        if (!res.isValid())
+          continue; // i.e., turn on the don't-look bit of X
+
+        const size_t vA = res.vA, vB = tour.next(res.vA);
+        const size_t vC = res.vC, vD = tour.next(res.vC);
+        SPDLOG_DEBUG("Perform a two-opt move: A = {:d}, C = {:d}", vA, vC);
+        tour.exchangeTwoEdges(vA, vC);
+        improvementThisRound += res.improvement;
+        ++numMovesThisRound;
+        if (stop != nullptr)
+          stop->recordImprovement(res.improvement);
+        // X is one of them
+        m_queue.push(vA);
+        m_queue.push(vB);
+        m_queue.push(vC);
+        m_queue.push(vD);
+      }
+      SPDLOG_INFO(
+        "neighbor-list 2-opt: improved by {} using {:d} moves", 
+        improvementThisRound, numMovesThisRound);
+      // the last round is always move-free 
+      // which confirms 2-opt w.r.t. the neighbor lists
+      outcome.update(improvementThisRound, numMovesThisRound, interrupted);
+      if (stop != nullptr && stop->endRound(tour))
+        break;
+    } while (numMovesThisRound > 0);
+    return outcome;
+  }
+
+  template <typename CostTy>
+  ThreeOptFinder<CostTy>::ThreeOptFinder(
+      const AbstractCompGraph<CostTy> &g, size_t numNeighbors)
+    : m_candidates(CandidateSet<CostTy>::fromGraph(g, numNeighbors))
+  {
+    if (g.numVertices() < 6)
+      throw std::invalid_argument("ThreeOptFinder ctor: the graph is too small");
+    if (g.numVertices() > std::numeric_limits<uint32_t>::max())
+      throw std::invalid_argument("ThreeOptFinder ctor: too many vertices");
+    if (!g.isSymmetric())
+      throw std::invalid_argument(
+          "Currently the 3-opt implementation doesn't support assymmetric TSP yet");
+  }
+
+  template <typename CostTy>
+  ThreeOptFinder<CostTy>::ThreeOptFinder(const CandidateSet<CostTy> &candidates)
+    : m_candidates(candidates)
+  {
+    if (candidates.numVertices() < 6)
+      throw std::invalid_argument("ThreeOptFinder ctor: the graph is too small");
+    if (candidates.numVertices() > std::numeric_limits<uint32_t>::max())
+      throw std::invalid_argument("ThreeOptFinder ctor: too many vertices");
+  }
+
+  template <typename CostTy>
+  ThreeOptQueryResults<CostTy> ThreeOptFinder<CostTy>::queryMoveGivenT1(
+      const AbstractTour &tour, size_t vT1, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement) const
+  {
+    return internal::visitConcreteTour(tour, [&](const auto &t) {
+      return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+        return queryMoveGivenT1_(t, vT1, gConcrete, firstImprovement);
+      });
+    });
+  }
+
+  template <typename CostTy>
+  template <typename TourTy, typename GraphTy>
+  ThreeOptQueryResults<CostTy> ThreeOptFinder<CostTy>::queryMoveGivenT1_(
+      const TourTy &tour, size_t vT1, const GraphTy &g,
+      bool firstImprovement) const
+  {
+    ThreeOptQueryResults<CostTy> res;
+    // t2 = next(t1), then t2 = prev(t1) via the mirrored tour
+    if (queryDirection_(tour, vT1, g, firstImprovement, false, res))
+      return res;
+    queryDirection_(internal::MirroredTour<const TourTy>(tour),
+      vT1, g, firstImprovement, true, res);
+    return res;
+  }
+
+  template <typename CostTy>
+  template <typename ViewTy, typename GraphTy>
+  bool ThreeOptFinder<CostTy>::queryDirection_(
+      const ViewTy &view, size_t vT1, const GraphTy &g, bool firstImprovement,
+      bool mirrored, ThreeOptQueryResults<CostTy> &res) const
+  {
+    const size_t vT2 = view.next(vT1);
+    const AccumTy<CostTy> c12 = g.getEdgeCost(vT1, vT2);
+    // close the tour with t6-t1 and record the move
+    auto tryClosing = [&](AccumTy<CostTy> gainOpen, ThreeOptReconnection type,
+        size_t vT3, size_t vT4, size_t vT5, size_t vT6) -> bool
+    {
+      const AccumTy<CostTy> gain = gainOpen - g.getEdgeCost(vT6, vT1);
+      return res.updateIfBetter(gain, type, {vT1, vT2, vT3, vT4, vT5, vT6}, mirrored)
+        && firstImprovement;
+    };
+
+    for (const auto& [vT3, c23] : m_candidates.getCandidates(vT2))
+    {
+      const AccumTy<CostTy> g1 = c12 - c23;
+      if (g1 <= 0) // the remaining neighbors are even farther away
+        break;
+      if (vT3 == vT1)
+        continue;
+
+      // Case 1: t4 = prev(t3), i.e., t4-t1 closes a 2-opt move
+      //         t1 -> t2 ... t4 -> t3 ... becomes t1 - t4 ... t2 - t3 ...
+      const size_t vT4b = view.prev(vT3);
+      if (vT4b != vT2)
+      {
+        const AccumTy<CostTy> g1Open = g1 + g.getEdgeCost(vT4b, vT3);
+        if (tryClosing(g1Open, kPure2Opt, vT3, vT4b, vT4b, vT4b))
+          return true;
+        for (const auto& [vT5, c45] : m_candidates.getCandidates(vT4b))
+        {
+          const AccumTy<CostTy> g2 = g1Open - c45;
+          if (g2 <= 0)
+            break;
+          if (vT5 == vT1)
+            continue;
+          // t6 is the neighbor of t5 on the side of t4 
+          // along the path t4 ... t2 - t3 ... t1
+          const size_t vT6 = view.between(vT2, vT5, vT4b) ? 
+            view.next(vT5) : view.prev(vT5);
+          if (vT6 == vT4b) // i.e., t4-t5 is already there
+            continue;
+          if (tryClosing(g2 + g.getEdgeCost(vT5, vT6), kSegmentReversal,
+                vT3, vT4b, vT5, vT6))
+            return true;
+        }
+      }
+
+      // Case 2: t4 = next(t3), which leaves the cycle t2 -> ... -> t3 - t2
+      //         and the path t4 -> ... -> t1, so t5 must break that cycle
+      const size_t vT4a = view.next(vT3);
+      if (vT4a == vT1)
+        continue;
+      const AccumTy<CostTy> g1Open = g1 + g.getEdgeCost(vT3, vT4a);
+      for (const auto& [vT5, c45] : m_candidates.getCandidates(vT4a))
+      {
+        const AccumTy<CostTy> g2 = g1Open - c45;
+        if (g2 <= 0)
+          break;
+        if (!view.between(vT2, vT5, vT3))
+          continue;
+        if (vT5 != vT3)
+        {
+          const size_t vT6 = view.next(vT5);
+          if (tryClosing(g2 + g.getEdgeCost(vT5, vT6), kOr3Opt,
+                vT3, vT4a, vT5, vT6))
+            return true;
+        }
+        if (vT5 != vT2)
+        {
+          const size_t vT6 = view.prev(vT5);
+          if (tryClosing(g2 + g.getEdgeCost(vT6, vT5), kBothReversed,
+                vT3, vT4a, vT5, vT6))
+            return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  template <typename CostTy>
+  void ThreeOptFinder<CostTy>::applyMove(
+      AbstractTour &tour, const ThreeOptQueryResults<CostTy> &res)
+  {
+    if (!res.isValid())
+      throw std::invalid_argument("Trying to apply an invalid 3-opt move");
+    internal::visitConcreteTour(tour, [&](auto &t) {
+      if (res.mirrored)
+      {
+        internal::MirroredTour<std::remove_reference_t<decltype(t)>> view(t);
+        applyMove_(view, res);
+      }
+      else
+      {
+        applyMove_(t, res);
+      }
+    });
+  }
+
+  template <typename CostTy>
+  template <typename ViewTy>
+  void ThreeOptFinder<CostTy>::applyMove_(
+      ViewTy &view, const ThreeOptQueryResults<CostTy> &res)
+  {
+    const auto& [vT1, vT2, vT3, vT4, vT5, vT6] = res.t;
+    switch (res.type)
+    {
+    case kPure2Opt:
+      internal::exchangeUndirectedEdges(view, vT1, vT2, vT4, vT3);
+      break;
+    case kSegmentReversal:
+      // the 2-opt move, then t1-t4 and t5-t6 are exchanged
+      internal::exchangeUndirectedEdges(view, vT1, vT2, vT4, vT3);
+      internal::exchangeUndirectedEdges(view, vT1, vT4, vT6, vT5);
+      break;
+    case kOr3Opt:
+      view.moveSegment(vT2, vT5, vT3, false);
+      break;
+    case kBothReversed:
+      // each flip is a no-op for a single vertex
+      if (vT6 != vT2)
+        internal::exchangeUndirectedEdges(view, vT1, vT2, vT6, vT5);
+      if (vT5 != vT3)
+        internal::exchangeUndirectedEdges(view, vT2, vT5, vT3, vT4);
+      break;
+    }
+  }
+
+  template <typename CostTy>
+  LocalSearchOutcome<CostTy> ThreeOptFinder<CostTy>::solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      size_t maxNumSweeps, bool firstImprovement, SweepMethod method,
+      StopCriterion<CostTy> *stop)
+  {
+    if (tour.maxSize() != g.numVertices() || !tour.isHamiltonian())
+      throw std::invalid_argument(
+          "ThreeOptFinder::solve expects a Hamiltonian tour of the graph");
+    if (m_candidates.numVertices() != g.numVertices())
+      throw std::invalid_argument(
+          "ThreeOptFinder::solve: the neighbor lists don't match the graph");
+    if (!g.isSymmetric())
+      throw std::invalid_argument(
+          "Currently the 3-opt implementation doesn't support assymmetric TSP yet");
+    SPDLOG_INFO(
+      "3-opt: {}-improvement, max. {:d} sweep(s)",
+      firstImprovement ? "first" : "best", maxNumSweeps);
+
+    if (stop != nullptr)
+      stop->start(evalTour(tour, g));
+    LocalSearchOutcome<CostTy> overallResult;
+    for (size_t totNumSweeps = 0; totNumSweeps < maxNumSweeps; ++totNumSweeps)
+    {
+      auto sweepRes = internal::visitConcreteTour(tour, [&](auto &t) {
+        return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+          return tryOneSweep_(t, gConcrete, firstImprovement, method, stop);
+        });
+      });
+      SPDLOG_INFO(
+          "sweep {:d} : further improved by {} using {:d} moves", 
+          totNumSweeps+1, sweepRes.improvement(), sweepRes.numMoves());
+      const bool interrupted = (stop != nullptr) && stop->stopped();
+      overallResult.update(sweepRes.improvement(), sweepRes.numMoves(), interrupted);
+      if (sweepRes.numMoves() == 0 && !interrupted)
+      {
+        SPDLOG_INFO("no move found, so 3-opt is confirmed");
+        break;
+      }
+      if (stop != nullptr && stop->endRound(tour))
+      {
+        SPDLOG_INFO("3-opt: stopped early (reason {:d})",
+          static_cast<int>(stop->stopReason()));
+        break;
+      }
+    }
+    return overallResult;
+  }
+
+  template <typename CostTy>
+  template <typename TourTy, typename GraphTy>
+  LocalSearchOutcome<CostTy> ThreeOptFinder<CostTy>::tryOneSweep_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement, SweepMethod method,
+      StopCriterion<CostTy> *stop)
+  {
+    if (method == kPriorityTwoOptSweep)
+      orderByDescendingCostAB(tour, g, m_vAandCostAB);
+    else
+      collectTourEdges(tour, g, m_vAandCostAB);
+
+    AccumTy<CostTy> improvement = 0;
+    size_t numMoves = 0;
+    for (const auto &[vT1, preComputedCostAB] : m_vAandCostAB)
+    {
+      if (stop != nullptr && stop->shouldStop())
+        break;
+      // only the order, the actual costs are re-evaluated in the query
+      auto res = queryMoveGivenT1_(tour, vT1, g, firstImprovement);
+      if (!res.isValid())
+        continue;
+      SPDLOG_DEBUG("Perform a 3-opt move (type {:d}): t1 = {:d}, t2 = {:d}, t3 = {:d}",
+        static_cast<int>(res.type), res.t[0], res.t[1], res.t[2]);
+      if (res.mirrored)
+      {
+        internal::MirroredTour<TourTy> view(tour);
+        applyMove_(view, res);
+      }
+      else
+      {
+        applyMove_(tour, res);
+      }
+      improvement += res.improvement;
+      ++numMoves;
+      if (stop != nullptr)
+        stop->recordImprovement(res.improvement);
+    }
+    LocalSearchOutcome<CostTy> outcome;
+    outcome.update(improvement, numMoves);
+    return outcome;
+  }
+
   /**********************************
     Explict template instantiation
    **********************************/
@@ -182,7 +831,29 @@ namespace xtsp::algo
   template TwoOptQueryResults<float> find2OptMoveGivenA(
       const AbstractTour &tour, size_t vA, const AbstractCompGraph<float> &g,
       bool firstImprovement);
+  template TwoOptQueryResults<uint16_t> find2OptMoveGivenA(
+      const AbstractTour &tour, size_t vA, const AbstractCompGraph<uint16_t> &g,
+      bool firstImprovement);
+  template TwoOptQueryResults<int16_t> find2OptMoveGivenA(
+      const AbstractTour &tour, size_t vA, const AbstractCompGraph<int16_t> &g,
+      bool firstImprovement);
+  template TwoOptQueryResults<uint32_t> find2OptMoveGivenA(
+      const AbstractTour &tour, size_t vA, const AbstractCompGraph<uint32_t> &g,
+      bool firstImprovement);
   template class PriorityTwoOptFinder<float>;
   template class PriorityTwoOptFinder<int>;
+  template class PriorityTwoOptFinder<uint16_t>;
+  template class PriorityTwoOptFinder<int16_t>;
+  template class PriorityTwoOptFinder<uint32_t>;
+  template class NeighborListTwoOptFinder<float>;
+  template class NeighborListTwoOptFinder<int>;
+  template class NeighborListTwoOptFinder<uint16_t>;
+  template class NeighborListTwoOptFinder<int16_t>;
+  template class NeighborListTwoOptFinder<uint32_t>;
+  template class ThreeOptFinder<float>;
+  template class ThreeOptFinder<int>;
+  template class ThreeOptFinder<uint16_t>;
+  template class ThreeOptFinder<int16_t>;
+  template class ThreeOptFinder<uint32_t>;
 
 }
\ No newline at end of file
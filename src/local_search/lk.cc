@@ -0,0 +1,339 @@
+// #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_DEBUG
+#include <spdlog/spdlog.h>
+
+#include "xtsp/local_search/lk.h"
+#include "../toolbox/devirtualize.h"
+#include "../toolbox/sequential_moves.h"
+
+#include <algorithm>
+
+namespace xtsp::algo
+{
+  template <typename CostTy>
+  LinKernighan<CostTy>::LinKernighan(
+      const AbstractCompGraph<CostTy> &g, size_t numNeighbors, size_t maxDepth)
+    : m_candidates(CandidateSet<CostTy>::fromGraph(g, numNeighbors)),
+      m_maxDepth(maxDepth),
+      m_queue(g.numVertices())
+  {
+    if (g.numVertices() < 5)
+      throw std::invalid_argument("LinKernighan ctor: the graph is too small");
+    if (maxDepth == 0)
+      throw std::invalid_argument("LinKernighan ctor: a move needs at least one step");
+    if (!g.isSymmetric())
+      throw std::invalid_argument(
+          "Currently the Lin-Kernighan implementation doesn't support assymmetric TSP yet");
+  }
+
+  template <typename CostTy>
+  LinKernighan<CostTy>::LinKernighan(
+      const CandidateSet<CostTy> &candidates, size_t maxDepth)
+    : m_candidates(candidates),
+      m_maxDepth(maxDepth),
+      m_queue(candidates.numVertices())
+  {
+    if (candidates.numVertices() < 5)
+      throw std::invalid_argument("LinKernighan ctor: the graph is too small");
+    if (maxDepth == 0)
+      throw std::invalid_argument("LinKernighan ctor: a move needs at least one step");
+  }
+
+  template <typename CostTy>
+  bool LinKernighan<CostTy>::isAdded(size_t vT3, size_t vT4) const
+  {
+    // the move has at most m_maxDepth steps, so a linear scan is fine
+    for (const auto &[vX, vY] : m_added)
+    {
+      if ((vX == vT3 && vY == vT4) || (vX == vT4 && vY == vT3))
+        return true;
+    }
+    return false;
+  }
+
+  // in descending gain, i.e., the most promising first
+  template <typename AlternativeTy>
+  static void sortAlternatives(std::vector<AlternativeTy> &alternatives)
+  {
+    std::sort(alternatives.begin(), alternatives.end(),
+              [](const AlternativeTy &lhs, const AlternativeTy &rhs)
+              {
+                return lhs.gOpen > rhs.gOpen;
+              });
+  }
+
+  template <typename CostTy>
+  template <typename TourTy, typename GraphTy>
+  bool LinKernighan<CostTy>::step_(
+      TourTy &tour, size_t vT1, size_t vT2, AccumTy<CostTy> gOpen,
+      size_t depth, const GraphTy &g)
+  {
+    const bool exhaustive = (depth <= m_alternatives.size());
+    Alternative best{0, 0, 0};
+    if (exhaustive)
+      m_alternatives[depth - 1].clear();
+
+    // the closing edge t1-t2 is either t1 -> t2 or t2 -> t1 by now,
+    // and t4 has to be on the same side of t3
+    const bool forward = (tour.next(vT1) == vT2);
+    for (const auto& [vT3, c23] : m_candidates.getCandidates(vT2))
+    {
+      const AccumTy<CostTy> g1 = gOpen - c23;
+      if (g1 <= 0) // the remaining neighbors are even farther away
+        break;
+      if (vT3 == vT1)
+        continue;
+      const size_t vT4 = forward ? tour.prev(vT3) : tour.next(vT3);
+      if (vT4 == vT2 || isAdded(vT3, vT4))
+        continue;
+      const Alternative alt{g1 + g.getEdgeCost(vT3, vT4), vT3, vT4};
+      if (exhaustive)
+        m_alternatives[depth - 1].push_back(alt);
+      else if (alt.gOpen > best.gOpen)
+        best = alt;
+    }
+
+    auto tryAlternative = [&](const Alternative &alt) -> bool
+    {
+      const auto &[gOpenNew, vT3, vT4] = alt;
+      const size_t journalSize = tour.journalSize();
+      // t1 - t4 ... t2 - t3 ..., i.e., t1-t4 is the new closing edge
+      internal::exchangeUndirectedEdges(tour, vT1, vT2, vT4, vT3);
+      m_added.emplace_back(vT2, vT3);
+      m_touched.push_back(vT2);
+      m_touched.push_back(vT3);
+      m_touched.push_back(vT4);
+
+      const AccumTy<CostTy> gain = gOpenNew - g.getEdgeCost(vT4, vT1);
+      if (gain > m_bestGain)
+      {
+        m_bestGain = gain;
+        m_bestJournalSize = tour.journalSize();
+      }
+      if (depth < m_maxDepth)
+        step_(tour, vT1, vT4, gOpenNew, depth + 1, g);
+      // no backtracking once the move improves
+      if (m_bestGain > 0)
+        return true;
+      tour.rollback(journalSize);
+      m_added.pop_back();
+      return false;
+    };
+
+    if (!exhaustive)
+      return (best.gOpen > 0) && tryAlternative(best);
+    sortAlternatives(m_alternatives[depth - 1]);
+    for (const Alternative &alt : m_alternatives[depth - 1])
+    {
+      if (tryAlternative(alt))
+        return true;
+    }
+    return false;
+  }
+
+  template <typename CostTy>
+  template <typename TourTy, typename ViewTy, typename GraphTy>
+  bool LinKernighan<CostTy>::alternateFirstStep_(
+      TourTy &tour, ViewTy &view, size_t vT1, size_t vT2, const GraphTy &g)
+  {
+    // (the first level of step_ is done by now)
+    auto &alternatives = m_alternatives[1];
+    const AccumTy<CostTy> c12 = g.getEdgeCost(vT1, vT2);
+    for (const auto& [vT3, c23] : m_candidates.getCandidates(vT2))
+    {
+      const AccumTy<CostTy> g1 = c12 - c23;
+      if (g1 <= 0)
+        break;
+      // t4 = next(t3) leaves the cycle t2 -> ... -> t3 - t2,
+      // so t5 has to be on it (see ThreeOptFinder)
+      const size_t vT4 = view.next(vT3);
+      if (vT3 == vT1 || vT4 == vT1)
+        continue;
+      const AccumTy<CostTy> g1Open = g1 + g.getEdgeCost(vT3, vT4);
+
+      alternatives.clear();
+      for (const auto& [vT5, c45] : m_candidates.getCandidates(vT4))
+      {
+        const AccumTy<CostTy> g2 = g1Open - c45;
+        if (g2 <= 0)
+          break;
+        if (!view.between(vT2, vT5, vT3))
+          continue;
+        // t6 = next(t5) moves t2 -> ... -> t5 between t3 and t4,
+        // t6 = prev(t5) reverses t2 -> ... -> t6 and t5 -> ... -> t3
+        if (vT5 != vT3)
+          alternatives.push_back({g2 + g.getEdgeCost(vT5, view.next(vT5)), vT5, view.next(vT5)});
+        if (vT5 != vT2)
+          alternatives.push_back({g2 + g.getEdgeCost(vT5, view.prev(vT5)), vT5, view.prev(vT5)});
+      }
+      sortAlternatives(alternatives);
+
+      for (const auto &[gOpenNew, vT5, vT6] : alternatives)
+      {
+        const size_t journalSize = tour.journalSize();
+        if (vT6 == view.next(vT5))
+        {
+          view.moveSegment(vT2, vT5, vT3, false);
+        }
+        else
+        {
+          // each flip is a no-op for a single vertex
+          if (vT6 != vT2)
+            internal::exchangeUndirectedEdges(tour, vT1, vT2, vT6, vT5);
+          if (vT5 != vT3)
+            internal::exchangeUndirectedEdges(tour, vT2, vT5, vT3, vT4);
+        }
+        // either way, t1-t6 is the new closing edge
+        m_added.emplace_back(vT2, vT3);
+        m_added.emplace_back(vT4, vT5);
+        for (const size_t v : {vT2, vT3, vT4, vT5, vT6})
+          m_touched.push_back(v);
+
+        const AccumTy<CostTy> gain = gOpenNew - g.getEdgeCost(vT6, vT1);
+        if (gain > m_bestGain)
+        {
+          m_bestGain = gain;
+          m_bestJournalSize = tour.journalSize();
+        }
+        if (m_maxDepth > 2)
+          step_(tour, vT1, vT6, gOpenNew, 3, g);
+        if (m_bestGain > 0)
+          return true;
+        tour.rollback(journalSize);
+        m_added.resize(m_added.size() - 2);
+      }
+    }
+    return false;
+  }
+
+  template <typename CostTy>
+  AccumTy<CostTy> LinKernighan<CostTy>::improveFrom(
+      AbstractTour &tour, size_t vT1, size_t vT2, const AbstractCompGraph<CostTy> &g)
+  {
+    return internal::visitConcreteTour(tour, [&](auto &t) {
+      return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+        return improveFrom_(t, vT1, vT2, gConcrete);
+      });
+    });
+  }
+
+  template <typename CostTy>
+  template <typename TourTy, typename GraphTy>
+  AccumTy<CostTy> LinKernighan<CostTy>::improveFrom_(
+      TourTy &tour, size_t vT1, size_t vT2, const GraphTy &g)
+  {
+    if (tour.next(vT1) != vT2 && tour.prev(vT1) != vT2)
+      throw std::invalid_argument("LinKernighan::improveFrom: t1-t2 is not a tour edge");
+    m_bestGain = 0;
+    m_added.clear();
+    m_touched.clear();
+    tour.clearJournal();
+    m_bestJournalSize = tour.checkpoint();
+
+    if (!step_(tour, vT1, vT2, g.getEdgeCost(vT1, vT2), 1, g) && m_maxDepth > 1)
+    {
+      // i.e., in the direction of t1 -> t2
+      if (tour.next(vT1) == vT2)
+      {
+        alternateFirstStep_(tour, tour, vT1, vT2, g);
+      }
+      else
+      {
+        internal::MirroredTour<TourTy> view(tour);
+        alternateFirstStep_(tour, view, vT1, vT2, g);
+      }
+    }
+    // i.e., undo the steps after the best one (or all of them)
+    tour.rollback(m_bestJournalSize);
+    tour.clearJournal();
+    return m_bestGain;
+  }
+
+  template <typename CostTy>
+  LocalSearchOutcome<CostTy> LinKernighan<CostTy>::solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      StopCriterion<CostTy> *stop)
+  {
+    return internal::visitConcreteTour(tour, [&](auto &t) {
+      return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+        return solve_(t, gConcrete, stop);
+      });
+    });
+  }
+
+  template <typename CostTy>
+  template <typename TourTy, typename GraphTy>
+  LocalSearchOutcome<CostTy> LinKernighan<CostTy>::solve_(
+      TourTy &tour, const GraphTy &g, StopCriterion<CostTy> *stop)
+  {
+    if (tour.maxSize() != g.numVertices() || !tour.isHamiltonian())
+      throw std::invalid_argument(
+          "LinKernighan::solve expects a Hamiltonian tour of the graph");
+    if (m_candidates.numVertices() != g.numVertices())
+      throw std::invalid_argument(
+          "LinKernighan::solve: the neighbor lists don't match the graph");
+    if (!g.isSymmetric())
+      throw std::invalid_argument(
+          "Currently the Lin-Kernighan implementation doesn't support assymmetric TSP yet");
+    LocalSearchOutcome<CostTy> outcome;
+    if (stop != nullptr)
+      stop->start(evalTour<CostTy>(tour, g));
+
+    // as in NeighborListTwoOptFinder, the last round reactivates
+    // all vertices to confirm that no move is left
+    size_t numMovesThisRound;
+    do
+    {
+      numMovesThisRound = 0;
+      AccumTy<CostTy> improvementThisRound = 0;
+      m_queue.clear();
+      size_t vHead = tour.getDepotId();
+      for (size_t rank = 0; rank < tour.size(); ++rank)
+      {
+        m_queue.push(vHead);
+        vHead = tour.next(vHead);
+      }
+
+      bool interrupted = false;
+      while (!m_queue.isEmpty())
+      {
+        if (stop != nullptr && stop->shouldStop())
+        {
+          interrupted = true;
+          break;
+        }
+        const size_t vT1 = m_queue.pop();
+        for (const size_t vT2 : {tour.next(vT1), tour.prev(vT1)})
+        {
+          const AccumTy<CostTy> gain = improveFrom_(tour, vT1, vT2, g);
+          if (gain <= 0)
+            continue;
+          SPDLOG_DEBUG("Performed a Lin-Kernighan move: t1 = {:d}, t2 = {:d}, gain = {}",
+            vT1, vT2, gain);
+          improvementThisRound += gain;
+          ++numMovesThisRound;
+          if (stop != nullptr)
+            stop->recordImprovement(gain);
+          // (a superset of) the endpoints of the changed edges
+          m_queue.push(vT1);
+          for (const size_t v : m_touched)
+            m_queue.push(v);
+          break;
+        }
+      }
+      SPDLOG_INFO(
+        "Lin-Kernighan: improved by {} using {:d} moves",
+        improvementThisRound, numMovesThisRound);
+      outcome.update(improvementThisRound, numMovesThisRound, interrupted);
+      if (stop != nullptr && stop->endRound(tour))
+        break;
+    } while (numMovesThisRound > 0);
+    return outcome;
+  }
+
+  // explicit template instantiation
+  template class LinKernighan<float>;
+  template class LinKernighan<int>;
+  template class LinKernighan<uint16_t>;
+  template class LinKernighan<int16_t>;
+  template class LinKernighan<uint32_t>;
+}
@@ -0,0 +1,281 @@
+// #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_DEBUG
+#include <spdlog/spdlog.h>
+
+#include "xtsp/local_search/move_evaluator.h"
+#include "../toolbox/devirtualize.h"
+#include "../toolbox/move_operators.h"
+#include "../toolbox/sequential_moves.h"
+
+namespace xtsp::algo
+{
+  /// @brief call @a fn with the operator policy of @a op (as a tag)
+  template <typename CostTy, typename Fn>
+  static decltype(auto) visitOperator(NeighborhoodOperator op, Fn&& fn)
+  {
+    switch (op)
+    {
+    case kTwoOptOperator:
+      return fn(internal::TwoOptOperator<CostTy>{});
+    case kTwoHOptOperator:
+      return fn(internal::TwoHOptOperator<CostTy>{});
+    case kNodeSwapOperator:
+      return fn(internal::NodeSwapOperator<CostTy>{});
+    case kNodeInsertionOperator:
+      return fn(internal::NodeInsertionOperator<CostTy>{});
+    }
+    throw std::invalid_argument("unknown neighborhood operator");
+  }
+
+  template <typename CostTy>
+  MoveEvaluator<CostTy>::MoveEvaluator(
+      const AbstractCompGraph<CostTy> &g, size_t numNeighbors)
+    : m_candidates(CandidateSet<CostTy>::fromGraph(g, numNeighbors)),
+      m_queue(g.numVertices())
+  {
+    if (g.numVertices() < 5)
+      throw std::invalid_argument("MoveEvaluator ctor: the graph is too small");
+    if (!g.isSymmetric())
+      throw std::invalid_argument(
+          "MoveEvaluator ctor: only symmetric graphs are supported");
+  }
+
+  template <typename CostTy>
+  MoveEvaluator<CostTy>::MoveEvaluator(const CandidateSet<CostTy> &candidates)
+    : m_candidates(candidates),
+      m_queue(candidates.numVertices())
+  {
+    if (candidates.numVertices() < 5)
+      throw std::invalid_argument("MoveEvaluator ctor: the graph is too small");
+  }
+
+  template <typename CostTy>
+  MoveProposal<CostTy> MoveEvaluator<CostTy>::queryMoveGivenX(
+      const AbstractTour &tour, size_t vX, NeighborhoodOperator op,
+      const AbstractCompGraph<CostTy> &g, bool firstImprovement) const
+  {
+    return visitOperator<CostTy>(op, [&](auto opTag) {
+      using OperatorTy = decltype(opTag);
+      return internal::visitConcreteTour(tour, [&](const auto &t) {
+        return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+          return queryMoveGivenX_<OperatorTy>(t, vX, gConcrete, firstImprovement);
+        });
+      });
+    });
+  }
+
+  template <typename CostTy>
+  template <typename OperatorTy, typename TourTy, typename GraphTy>
+  MoveProposal<CostTy> MoveEvaluator<CostTy>::queryMoveGivenX_(
+      const TourTy &tour, size_t vX, const GraphTy &g,
+      bool firstImprovement) const
+  {
+    MoveProposal<CostTy> res;
+    const AccumTy<CostTy> maxCostXC = OperatorTy::bound(tour, vX, g);
+    for (const auto& [vC, cXC] : m_candidates.getCandidates(vX))
+    {
+      if (cXC >= maxCostXC) // the remaining neighbors are even farther away
+        break;
+      if (OperatorTy::evaluate(tour, vX, vC, cXC, g, res) && firstImprovement)
+        break;
+    }
+    return res;
+  }
+
+  template <typename CostTy>
+  void MoveEvaluator<CostTy>::applyMove(
+      AbstractTour &tour, const MoveProposal<CostTy> &move)
+  {
+    if (!move.isValid())
+      throw std::invalid_argument("Trying to apply an invalid move");
+    internal::visitConcreteTour(tour, [&](auto &t) {
+      applyMove_(t, move);
+    });
+  }
+
+  template <typename CostTy>
+  template <typename TourTy>
+  void MoveEvaluator<CostTy>::applyMove_(
+      TourTy &tour, const MoveProposal<CostTy> &move)
+  {
+    const auto& [v0, v1, v2, v3] = move.v;
+    switch (move.type)
+    {
+    case kExchangeEdges:
+      internal::exchangeUndirectedEdges(tour, v0, v1, v2, v3);
+      break;
+    case kRelocateVertex:
+      tour.moveSegment(v0, v0, v1, false);
+      break;
+    case kSwapVertices:
+      if (tour.next(v0) == v1)
+        tour.moveSegment(v0, v0, v1, false);
+      else if (tour.next(v1) == v0)
+        tour.moveSegment(v1, v1, v0, false);
+      else
+      {
+        // X goes after Y, then Y goes where X was
+        const size_t vPX = tour.prev(v0);
+        tour.moveSegment(v0, v0, v1, false);
+        tour.moveSegment(v1, v1, vPX, false);
+      }
+      break;
+    }
+  }
+
+  template <typename CostTy>
+  LocalSearchOutcome<CostTy> MoveEvaluator<CostTy>::solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      NeighborhoodOperator op, bool firstImprovement,
+      StopCriterion<CostTy> *stop)
+  {
+    checkInputs_(tour, g);
+    if (stop != nullptr)
+      stop->start(evalTour(tour, g));
+    return solveFromHere_(tour, g, op, firstImprovement, stop);
+  }
+
+  template <typename CostTy>
+  void MoveEvaluator<CostTy>::checkInputs_(
+      const AbstractTour &tour, const AbstractCompGraph<CostTy> &g) const
+  {
+    if (tour.maxSize() != g.numVertices() || !tour.isHamiltonian())
+      throw std::invalid_argument(
+          "MoveEvaluator::solve expects a Hamiltonian tour of the graph");
+    if (m_candidates.numVertices() != g.numVertices())
+      throw std::invalid_argument(
+          "MoveEvaluator::solve: the neighbor lists don't match the graph");
+    if (!g.isSymmetric())
+      throw std::invalid_argument(
+          "MoveEvaluator::solve: only symmetric graphs are supported");
+  }
+
+  template <typename CostTy>
+  LocalSearchOutcome<CostTy> MoveEvaluator<CostTy>::solveFromHere_(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      NeighborhoodOperator op, bool firstImprovement,
+      StopCriterion<CostTy> *stop)
+  {
+    return visitOperator<CostTy>(op, [&](auto opTag) {
+      using OperatorTy = decltype(opTag);
+      return internal::visitConcreteTour(tour, [&](auto &t) {
+        return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+          return solve_<OperatorTy>(t, gConcrete, firstImprovement, stop);
+        });
+      });
+    });
+  }
+
+  template <typename CostTy>
+  template <typename OperatorTy, typename TourTy, typename GraphTy>
+  LocalSearchOutcome<CostTy> MoveEvaluator<CostTy>::solve_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement,
+      StopCriterion<CostTy> *stop)
+  {
+    LocalSearchOutcome<CostTy> outcome;
+    // the endpoints of the removed edges (to requeue)
+    std::array<size_t, 8> touched;
+    size_t numMovesThisRound;
+    do
+    {
+      numMovesThisRound = 0;
+      AccumTy<CostTy> improvementThisRound = 0;
+      m_queue.clear();
+      for (size_t v = tour.getDepotId(), k = 0; k < tour.size(); ++k, v = tour.next(v))
+        m_queue.push(v);
+
+      bool interrupted = false;
+      while (!m_queue.isEmpty())
+      {
+        if (stop != nullptr && stop->shouldStop())
+        {
+          interrupted = true;
+          break;
+        }
+        const size_t vX = m_queue.pop();
+        const auto move = queryMoveGivenX_<OperatorTy>(tour, vX, g, firstImprovement);
+        if (!move.isValid())
+          continue; // i.e., turn on the don't-look bit of X
+
+        SPDLOG_DEBUG("Perform a move (type {:d}): {:d}, {:d}, {:d}, {:d}",
+          static_cast<int>(move.type), move.v[0], move.v[1], move.v[2], move.v[3]);
+        size_t numTouched = 0;
+        if (move.type == kExchangeEdges)
+        {
+          for (const size_t v : move.v)
+            touched[numTouched++] = v;
+        }
+        else
+        {
+          // X (and Y) with their tour neighbors, P and its successor
+          const size_t numMoved = (move.type == kSwapVertices) ? 2 : 1;
+          for (size_t k = 0; k < numMoved; ++k)
+          {
+            touched[numTouched++] = move.v[k];
+            touched[numTouched++] = tour.prev(move.v[k]);
+            touched[numTouched++] = tour.next(move.v[k]);
+          }
+          if (move.type == kRelocateVertex)
+          {
+            touched[numTouched++] = move.v[1];
+            touched[numTouched++] = tour.next(move.v[1]);
+          }
+        }
+        applyMove_(tour, move);
+        improvementThisRound += move.improvement;
+        ++numMovesThisRound;
+        if (stop != nullptr)
+          stop->recordImprovement(move.improvement);
+        for (size_t k = 0; k < numTouched; ++k)
+          m_queue.push(touched[k]);
+      }
+      // the last round is always move-free
+      outcome.update(improvementThisRound, numMovesThisRound, interrupted);
+      if (stop != nullptr && stop->endRound(tour))
+        break;
+    } while (numMovesThisRound > 0);
+    return outcome;
+  }
+
+  template <typename CostTy>
+  LocalSearchOutcome<CostTy> MoveEvaluator<CostTy>::variableNeighborhoodDescent(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      const std::vector<NeighborhoodOperator> &ops, bool firstImprovement,
+      StopCriterion<CostTy> *stop)
+  {
+    if (ops.empty())
+      throw std::invalid_argument(
+          "MoveEvaluator::variableNeighborhoodDescent needs at least one operator");
+    checkInputs_(tour, g);
+    // one run across all the operators
+    if (stop != nullptr)
+      stop->start(evalTour(tour, g));
+    LocalSearchOutcome<CostTy> outcome;
+    size_t k = 0;
+    while (k < ops.size())
+    {
+      const auto res = solveFromHere_(tour, g, ops[k], firstImprovement, stop);
+      SPDLOG_INFO("VND operator {:d} ({:d}): improved by {} using {:d} moves",
+        k, static_cast<int>(ops[k]), res.improvement(), res.numMoves());
+      if (res.numMoves() > 0)
+        outcome.update(res.improvement(), res.numMoves());
+      if (stop != nullptr && stop->stopped())
+      {
+        SPDLOG_INFO("VND: stopped early (reason {:d})",
+          static_cast<int>(stop->stopReason()));
+        return outcome;
+      }
+      // the current operator is exhausted either way
+      k = (res.numMoves() > 0 && k > 0) ? 0 : k + 1;
+    }
+    // i.e., no operator has found anything since the last move
+    outcome.update(0, 0);
+    return outcome;
+  }
+
+  // explicit template instantiation
+  template class MoveEvaluator<float>;
+  template class MoveEvaluator<int>;
+  template class MoveEvaluator<uint16_t>;
+  template class MoveEvaluator<int16_t>;
+  template class MoveEvaluator<uint32_t>;
+}
@@ -0,0 +1,211 @@
+// #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_DEBUG
+#include <spdlog/spdlog.h>
+
+#include "xtsp/local_search/or_opt.h"
+#include "../toolbox/devirtualize.h"
+
+#include <algorithm>
+
+namespace xtsp::algo
+{
+  template <typename CostTy>
+  NeighborListOrOptFinder<CostTy>::NeighborListOrOptFinder(
+      const AbstractCompGraph<CostTy> &g, size_t numNeighbors, size_t maxSegmentLength)
+    : m_candidates(CandidateSet<CostTy>::fromGraph(g, numNeighbors)),
+      m_maxSegLen(maxSegmentLength),
+      m_queue(g.numVertices())
+  {
+    if (g.numVertices() < 5)
+      throw std::invalid_argument("NeighborListOrOptFinder ctor: the graph is too small");
+    if (maxSegmentLength == 0)
+      throw std::invalid_argument("NeighborListOrOptFinder ctor: the segments can't be empty");
+    if (!g.isSymmetric())
+      throw std::invalid_argument(
+          "Currently the Or-opt implementation doesn't support assymmetric TSP yet");
+  }
+
+  template <typename CostTy>
+  NeighborListOrOptFinder<CostTy>::NeighborListOrOptFinder(
+      const CandidateSet<CostTy> &candidates, size_t maxSegmentLength)
+    : m_candidates(candidates),
+      m_maxSegLen(maxSegmentLength),
+      m_queue(candidates.numVertices())
+  {
+    if (candidates.numVertices() < 5)
+      throw std::invalid_argument("NeighborListOrOptFinder ctor: the graph is too small");
+    if (maxSegmentLength == 0)
+      throw std::invalid_argument("NeighborListOrOptFinder ctor: the segments can't be empty");
+  }
+
+  template <typename CostTy>
+  template <typename TourTy, typename GraphTy>
+  bool NeighborListOrOptFinder<CostTy>::querySegment_(
+      const TourTy &tour, size_t vS1, size_t vS2, const GraphTy &g,
+      bool firstImprovement, OrOptQueryResults<CostTy> &res) const
+  {
+    const size_t vO = tour.prev(vS1);
+    const size_t vN = tour.next(vS2);
+    // the gain of taking the segment out (O -> N instead)
+    const AccumTy<CostTy> gainOut = AccumTy<CostTy>(g.getEdgeCost(vO, vS1))
+      + g.getEdgeCost(vS2, vN) - g.getEdgeCost(vO, vN);
+    if (gainOut <= 0)
+      return false;
+
+    // insert it between P and Q = next(P), as P -> first ... last -> Q
+    auto tryInsertion = [&](size_t vP, size_t vQ, bool reversed) -> bool
+    {
+      if (tour.between(vS1, vP, vS2) || tour.between(vS1, vQ, vS2))
+        return false;
+      const size_t vFirst = reversed ? vS2 : vS1;
+      const size_t vLast = reversed ? vS1 : vS2;
+      const AccumTy<CostTy> costIn = AccumTy<CostTy>(g.getEdgeCost(vP, vFirst))
+        + g.getEdgeCost(vLast, vQ) - g.getEdgeCost(vP, vQ);
+      return res.updateIfBetter(gainOut - costIn, vS1, vS2, vP, reversed)
+        && firstImprovement;
+    };
+
+    // make an end E (either S1 or S2) adjacent to its neighbor C
+    for (const bool endIsS1 : {true, false})
+    {
+      const size_t vE = endIsS1 ? vS1 : vS2;
+      for (const auto& [vC, cEC] : m_candidates.getCandidates(vE))
+      {
+        if (cEC >= gainOut) // the remaining neighbors are even farther away
+          break;
+        // C -> E, i.e., P = C
+        if (tryInsertion(vC, tour.next(vC), !endIsS1))
+          return true;
+        // E -> C, i.e., Q = C
+        if (tryInsertion(tour.prev(vC), vC, endIsS1))
+          return true;
+      }
+    }
+    return false;
+  }
+
+  template <typename CostTy>
+  OrOptQueryResults<CostTy> NeighborListOrOptFinder<CostTy>::queryMoveGivenX(
+      const AbstractTour &tour, size_t vX, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement) const
+  {
+    return internal::visitConcreteTour(tour, [&](const auto &t) {
+      return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+        return queryMoveGivenX_(t, vX, gConcrete, firstImprovement);
+      });
+    });
+  }
+
+  template <typename CostTy>
+  template <typename TourTy, typename GraphTy>
+  OrOptQueryResults<CostTy> NeighborListOrOptFinder<CostTy>::queryMoveGivenX_(
+      const TourTy &tour, size_t vX, const GraphTy &g,
+      bool firstImprovement) const
+  {
+    OrOptQueryResults<CostTy> res;
+    // leave at least 3 vertices out of the segment
+    const size_t maxLen = std::min(m_maxSegLen, tour.size() - 3);
+    // the segments X -> ... (i.e., starting at X)
+    for (size_t len = 1, vEnd = vX; len <= maxLen; ++len, vEnd = tour.next(vEnd))
+    {
+      if (querySegment_(tour, vX, vEnd, g, firstImprovement, res))
+        return res;
+    }
+    // the segments ... -> X (i.e., ending at X)
+    for (size_t len = 2, vBegin = tour.prev(vX); len <= maxLen; ++len, vBegin = tour.prev(vBegin))
+    {
+      if (querySegment_(tour, vBegin, vX, g, firstImprovement, res))
+        return res;
+    }
+    return res;
+  }
+
+  template <typename CostTy>
+  LocalSearchOutcome<CostTy> NeighborListOrOptFinder<CostTy>::solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      bool firstImprovement, StopCriterion<CostTy> *stop)
+  {
+    return internal::visitConcreteTour(tour, [&](auto &t) {
+      return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+        return solve_(t, gConcrete, firstImprovement, stop);
+      });
+    });
+  }
+
+  template <typename CostTy>
+  template <typename TourTy, typename GraphTy>
+  LocalSearchOutcome<CostTy> NeighborListOrOptFinder<CostTy>::solve_(
+      TourTy &tour, const GraphTy &g, bool firstImprovement,
+      StopCriterion<CostTy> *stop)
+  {
+    if (tour.maxSize() != g.numVertices() || !tour.isHamiltonian())
+      throw std::invalid_argument(
+          "NeighborListOrOptFinder::solve expects a Hamiltonian tour of the graph");
+    if (m_candidates.numVertices() != g.numVertices())
+      throw std::invalid_argument(
+          "NeighborListOrOptFinder::solve: the neighbor lists don't match the graph");
+    if (!g.isSymmetric())
+      throw std::invalid_argument(
+          "Currently the Or-opt implementation doesn't support assymmetric TSP yet");
+    LocalSearchOutcome<CostTy> outcome;
+    if (stop != nullptr)
+      stop->start(evalTour<CostTy>(tour, g));
+
+    // as in NeighborListTwoOptFinder, the last round reactivates
+    // all vertices to confirm that no move is left
+    size_t numMovesThisRound;
+    do
+    {
+      numMovesThisRound = 0;
+      AccumTy<CostTy> improvementThisRound = 0;
+      m_queue.clear();
+      size_t vHead = tour.getDepotId();
+      for (size_t rank = 0; rank < tour.size(); ++rank)
+      {
+        m_queue.push(vHead);
+        vHead = tour.next(vHead);
+      }
+
+      bool interrupted = false;
+      while (!m_queue.isEmpty())
+      {
+        if (stop != nullptr && stop->shouldStop())
+        {
+          interrupted = true;
+          break;
+        }
+        const size_t vX = m_queue.pop();
+        auto res = queryMoveGivenX_(tour, vX, g, firstImprovement);
+        if (!res.isValid())
+          continue; // i.e., turn on the don't-look bit of X
+
+        // the endpoints of the 3 removed edges
+        const size_t vO = tour.prev(res.vS1), vN = tour.next(res.vS2);
+        const size_t vP = res.vP, vQ = tour.next(res.vP);
+        SPDLOG_DEBUG("Perform an Or-opt move: S1 = {:d}, S2 = {:d}, P = {:d}, reversed = {}",
+          res.vS1, res.vS2, vP, res.reversed);
+        tour.moveSegment(res.vS1, res.vS2, vP, res.reversed);
+        improvementThisRound += res.improvement;
+        ++numMovesThisRound;
+        if (stop != nullptr)
+          stop->recordImprovement(res.improvement);
+        // X is one of them
+        for (const size_t v : {vO, res.vS1, res.vS2, vN, vP, vQ})
+          m_queue.push(v);
+      }
+      SPDLOG_INFO(
+        "neighbor-list Or-opt: improved by {} using {:d} moves",
+        improvementThisRound, numMovesThisRound);
+      outcome.update(improvementThisRound, numMovesThisRound, interrupted);
+      if (stop != nullptr && stop->endRound(tour))
+        break;
+    } while (numMovesThisRound > 0);
+    return outcome;
+  }
+
+  // explicit template instantiation
+  template class NeighborListOrOptFinder<float>;
+  template class NeighborListOrOptFinder<int>;
+  template class NeighborListOrOptFinder<uint16_t>;
+  template class NeighborListOrOptFinder<int16_t>;
+  template class NeighborListOrOptFinder<uint32_t>;
+}
@@ -0,0 +1,183 @@
+// #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_DEBUG
+#include <spdlog/spdlog.h>
+
+#include "xtsp/local_search/parallel_kopt.h"
+#include "../toolbox/devirtualize.h"
+#include "../toolbox/sequential_moves.h"
+
+#include <algorithm>
+#include <array>
+
+namespace xtsp::algo
+{
+  template <typename CostTy>
+  ParallelTwoOptFinder<CostTy>::ParallelTwoOptFinder(size_t numThreads)
+    : m_pool(numThreads)
+  {
+  }
+
+  template <typename CostTy>
+  TwoOptOutcome<CostTy> ParallelTwoOptFinder<CostTy>::solve(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g,
+      size_t maxNumSweeps, StopCriterion<CostTy> *stop)
+  {
+    SPDLOG_INFO(
+      "parallel 2-opt: {:d} thread(s), max. {:d} sweep(s)",
+      numThreads(), maxNumSweeps);
+    if (stop != nullptr)
+      stop->start(evalTour(tour, g));
+    TwoOptOutcome<CostTy> overallResult;
+    for (size_t totNumSweeps = 0; totNumSweeps < maxNumSweeps; ++totNumSweeps)
+    {
+      const auto sweepRes = tryOneSweep(tour, g);
+      SPDLOG_INFO(
+          "sweep {:d} : further improved by {} using {:d} moves",
+          totNumSweeps+1, sweepRes.improvement(), sweepRes.numMoves());
+      overallResult.update(sweepRes.improvement(), sweepRes.numMoves());
+      if (sweepRes.numMoves() == 0)
+      {
+        SPDLOG_INFO("no move found, so 2-opt is confirmed");
+        break;
+      }
+      if (stop != nullptr)
+      {
+        stop->recordImprovement(sweepRes.improvement());
+        if (stop->endRound(tour))
+        {
+          SPDLOG_INFO("parallel 2-opt: stopped early (reason {:d})",
+            static_cast<int>(stop->stopReason()));
+          break;
+        }
+      }
+    }
+    return overallResult;
+  }
+
+  template <typename CostTy>
+  TwoOptOutcome<CostTy> ParallelTwoOptFinder<CostTy>::tryOneSweep(
+      AbstractTour &tour, const AbstractCompGraph<CostTy> &g)
+  {
+    if (tour.maxSize() != g.numVertices())
+      throw std::invalid_argument(
+          "ParallelTwoOptFinder: tour is inconsistent with the graph");
+    if (tour.size() < 4)
+      throw std::invalid_argument("Your tour is too short");
+    if (!g.isSymmetric())
+      throw std::invalid_argument(
+          "Currently the 2-opt implementation doesn't support assymmetric TSP yet");
+    return internal::visitConcreteTour(tour, [&](auto &t) {
+      return internal::visitConcreteGraph(g, [&](const auto &gConcrete) {
+        return tryOneSweep_(t, gConcrete);
+      });
+    });
+  }
+
+  template <typename CostTy>
+  template <typename TourTy, typename GraphTy>
+  TwoOptOutcome<CostTy> ParallelTwoOptFinder<CostTy>::tryOneSweep_(
+      TourTy &tour, const GraphTy &g)
+  {
+    // 1. the snapshot
+    const size_t n = tour.size();
+    m_seq.resize(n + 1);
+    m_edgeCosts.resize(n);
+    m_seq[0] = tour.getDepotId();
+    for (size_t rank = 0; rank < n; ++rank)
+    {
+      m_seq[rank + 1] = tour.next(m_seq[rank]);
+      m_edgeCosts[rank] = g.getEdgeCost(m_seq[rank], m_seq[rank + 1]);
+    }
+
+    // 2. the evaluation (the earlier edges have more partners,
+    //    so they are claimed first)
+    m_bestMoves.resize(n - 2);
+    m_pool.parallelFor(n - 2, [&](size_t rankA, size_t) {
+      m_bestMoves[rankA] = findBestPartner_(rankA, g);
+    });
+
+    // 3. the batch
+    selectNonOverlappingMoves_();
+    TwoOptOutcome<CostTy> outcome;
+    for (const auto &move : m_batch)
+    {
+      SPDLOG_DEBUG("Perform a two-opt move: A = {:d}, C = {:d}",
+        m_seq[move.rankA], m_seq[move.rankC]);
+      // the earlier moves of the batch may have flipped both edges,
+      // but never only one of them
+      internal::exchangeUndirectedEdges(tour,
+        m_seq[move.rankA], m_seq[move.rankA + 1],
+        m_seq[move.rankC], m_seq[move.rankC + 1]);
+      outcome.update(move.improvement, 1);
+    }
+    return outcome;
+  }
+
+  template <typename CostTy>
+  template <typename GraphTy>
+  typename ParallelTwoOptFinder<CostTy>::RankedMove
+  ParallelTwoOptFinder<CostTy>::findBestPartner_(size_t rankA, const GraphTy &g) const
+  {
+    const size_t n = m_edgeCosts.size();
+    const size_t vA = m_seq[rankA];
+    const size_t vB = m_seq[rankA + 1];
+    const AccumTy<CostTy> cAB = m_edgeCosts[rankA];
+    RankedMove best;
+    best.rankA = rankA;
+
+    // C at the ranks rankA + 2, ..., with D = next(C) != A,
+    // fetched chunk by chunk as in find2OptMoveGivenA
+    constexpr size_t chunkSize = 64;
+    std::array<CostTy, chunkSize> costAC, costBD;
+    const size_t rankEnd = (rankA == 0) ? n - 1 : n;
+    for (size_t rankBegin = rankA + 2; rankBegin < rankEnd; rankBegin += chunkSize)
+    {
+      const size_t len = std::min(chunkSize, rankEnd - rankBegin);
+      g.getEdgeCosts(vA, m_seq.data() + rankBegin, len, costAC.data());
+      g.getEdgeCosts(vB, m_seq.data() + rankBegin + 1, len, costBD.data());
+      for (size_t k = 0; k < len; ++k)
+      {
+        const AccumTy<CostTy> improvement = cAB + m_edgeCosts[rankBegin + k]
+          - (AccumTy<CostTy>(costAC[k]) + costBD[k]);
+        if (improvement > best.improvement)
+        {
+          best.improvement = improvement;
+          best.rankC = rankBegin + k;
+        }
+      }
+    }
+    return best;
+  }
+
+  template <typename CostTy>
+  void ParallelTwoOptFinder<CostTy>::selectNonOverlappingMoves_()
+  {
+    // the improving ones, by descending improvement
+    auto candidatesEnd = std::remove_if(m_bestMoves.begin(), m_bestMoves.end(),
+      [](const RankedMove &move) { return move.improvement <= 0; });
+    std::sort(m_bestMoves.begin(), candidatesEnd,
+      [](const RankedMove &lhs, const RankedMove &rhs) {
+        return (lhs.improvement != rhs.improvement)
+          ? lhs.improvement > rhs.improvement : lhs.rankA < rhs.rankA;
+      });
+
+    m_batch.clear();
+    m_takenRanges.clear();
+    for (auto it = m_bestMoves.begin(); it != candidatesEnd; ++it)
+    {
+      // the taken range starting last before rankC (if any) is the only
+      // candidate for an overlap, since the taken ranges are disjoint
+      auto after = m_takenRanges.upper_bound(it->rankC);
+      if (after != m_takenRanges.begin() && std::prev(after)->second >= it->rankA)
+        continue;
+      m_takenRanges.emplace(it->rankA, it->rankC);
+      m_batch.push_back(*it);
+    }
+  }
+
+  // explicit template instantiation
+  template class ParallelTwoOptFinder<float>;
+  template class ParallelTwoOptFinder<int>;
+  template class ParallelTwoOptFinder<uint16_t>;
+  template class ParallelTwoOptFinder<int16_t>;
+  template class ParallelTwoOptFinder<uint32_t>;
+}
@@ -0,0 +1,394 @@
+#include "cost_kernels.h"
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace xtsp::internal
+{
+  // the scalar reference implementation for targets [kBegin, numTo)
+  template <int Norm, typename T>
+  static void pointDistancesScalar(
+    const T* cols, size_t ld, size_t nDim,
+    size_t from, const size_t* to, size_t kBegin, size_t numTo, T* out)
+  {
+    for (size_t k = kBegin; k < numTo; ++k)
+    {
+      T acc = 0;
+      for (size_t d = 0; d < nDim; ++d)
+      {
+        const T diff = cols[d*ld + from] - cols[d*ld + to[k]];
+        if constexpr (Norm == 2)
+          acc += diff*diff;
+        else if constexpr (Norm == 1)
+          acc += std::abs(diff);
+        else
+          acc = std::max(acc, std::abs(diff));
+      }
+      if constexpr (Norm == 2)
+        acc = std::sqrt(acc);
+      out[k] = acc;
+    }
+  }
+
+#if defined(__AVX512F__)
+  static_assert(sizeof(size_t) == 8, "the gather below assumes 64-bit indices");
+
+  // 16 targets per iteration, returns where the scalar loop shall continue
+  template <int Norm>
+  static size_t pointDistancesSimd(
+    const float* cols, size_t ld, size_t nDim,
+    size_t from, const size_t* to, size_t numTo, float* out)
+  {
+    size_t k = 0;
+    for (; k + 16 <= numTo; k += 16)
+    {
+      const __m512i idxLo = _mm512_loadu_si512(to + k);
+      const __m512i idxHi = _mm512_loadu_si512(to + k + 8);
+      __m512 acc = _mm512_setzero_ps();
+      for (size_t d = 0; d < nDim; ++d)
+      {
+        // (the masked/zeroing forms, since the plain ones pass an
+        //  undefined source that GCC flags as maybe uninitialized)
+        const float* col = cols + d*ld;
+        const __m256 lo = _mm512_mask_i64gather_ps(_mm256_setzero_ps(), 0xFF, idxLo, col, 4);
+        const __m256 hi = _mm512_mask_i64gather_ps(_mm256_setzero_ps(), 0xFF, idxHi, col, 4);
+        const __m512d loHalf = _mm512_maskz_insertf64x4(
+          0xFF, _mm512_setzero_pd(), _mm256_castps_pd(lo), 0);
+        const __m512 x = _mm512_castpd_ps(_mm512_maskz_insertf64x4(
+          0xFF, loHalf, _mm256_castps_pd(hi), 1));
+        const __m512 diff = _mm512_sub_ps(_mm512_set1_ps(col[from]), x);
+        if constexpr (Norm == 2)
+          acc = _mm512_add_ps(acc, _mm512_mul_ps(diff, diff));
+        else if constexpr (Norm == 1)
+          acc = _mm512_add_ps(acc, _mm512_abs_ps(diff));
+        else
+          acc = _mm512_maskz_max_ps(0xFFFF, acc, _mm512_abs_ps(diff));
+      }
+      if constexpr (Norm == 2)
+        acc = _mm512_maskz_sqrt_ps(0xFFFF, acc);
+      _mm512_storeu_ps(out + k, acc);
+    }
+    return k;
+  }
+#elif defined(__AVX2__)
+  static_assert(sizeof(size_t) == 8, "the gather below assumes 64-bit indices");
+
+  // 8 targets per iteration, returns where the scalar loop shall continue
+  template <int Norm>
+  static size_t pointDistancesSimd(
+    const float* cols, size_t ld, size_t nDim,
+    size_t from, const size_t* to, size_t numTo, float* out)
+  {
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    size_t k = 0;
+    for (; k + 8 <= numTo; k += 8)
+    {
+      const __m256i idxLo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(to + k));
+      const __m256i idxHi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(to + k + 4));
+      __m256 acc = _mm256_setzero_ps();
+      for (size_t d = 0; d < nDim; ++d)
+      {
+        const float* col = cols + d*ld;
+        const __m128 lo = _mm256_i64gather_ps(col, idxLo, 4);
+        const __m128 hi = _mm256_i64gather_ps(col, idxHi, 4);
+        const __m256 x = _mm256_set_m128(hi, lo);
+        const __m256 diff = _mm256_sub_ps(_mm256_set1_ps(col[from]), x);
+        if constexpr (Norm == 2)
+          acc = _mm256_add_ps(acc, _mm256_mul_ps(diff, diff));
+        else if constexpr (Norm == 1)
+          acc = _mm256_add_ps(acc, _mm256_andnot_ps(signMask, diff));
+        else
+          acc = _mm256_max_ps(acc, _mm256_andnot_ps(signMask, diff));
+      }
+      if constexpr (Norm == 2)
+        acc = _mm256_sqrt_ps(acc);
+      _mm256_storeu_ps(out + k, acc);
+    }
+    return k;
+  }
+#else
+  template <int Norm>
+  static size_t pointDistancesSimd(
+    const float*, size_t, size_t, size_t, const size_t*, size_t, float*)
+  {
+    return 0; // nothing is done, so the scalar loop does everything
+  }
+#endif
+
+  template <int Norm>
+  static void pointDistancesDispatched(
+    const float* cols, size_t ld, size_t nDim,
+    size_t from, const size_t* to, size_t numTo, float* out)
+  {
+    const size_t kDone = pointDistancesSimd<Norm>(cols, ld, nDim, from, to, numTo, out);
+    pointDistancesScalar<Norm>(cols, ld, nDim, from, to, kDone, numTo, out);
+  }
+
+  void pointDistances(
+    const float* cols, size_t ld, size_t nDim, int normType,
+    size_t from, const size_t* to, size_t numTo, float* out)
+  {
+    // the switch is evaluated once per batch instead of once per edge
+    switch (normType)
+    {
+      case 2:
+        pointDistancesDispatched<2>(cols, ld, nDim, from, to, numTo, out);
+        break;
+      case 1:
+        pointDistancesDispatched<1>(cols, ld, nDim, from, to, numTo, out);
+        break;
+      default: // maxNorm, aka. L_infinty
+        pointDistancesDispatched<0>(cols, ld, nDim, from, to, numTo, out);
+    }
+  }
+
+  void pointDistances(
+    const double* cols, size_t ld, size_t nDim, int normType,
+    size_t from, const size_t* to, size_t numTo, double* out)
+  {
+    switch (normType)
+    {
+      case 2:
+        pointDistancesScalar<2>(cols, ld, nDim, from, to, 0, numTo, out);
+        break;
+      case 1:
+        pointDistancesScalar<1>(cols, ld, nDim, from, to, 0, numTo, out);
+        break;
+      default: // maxNorm, aka. L_infinty
+        pointDistancesScalar<0>(cols, ld, nDim, from, to, 0, numTo, out);
+    }
+  }
+
+  // the scalar reference implementation for candidates [kBegin, numC)
+  template <typename T, typename AccT>
+  static size_t bestTwoOptCandidateScalar(
+    AccT cAB, const T* costCD, const T* costAC, const T* costBD,
+    size_t kBegin, size_t numC, bool firstImprovement, 
+    AccT &bestImprovement, size_t kBest)
+  {
+    for (size_t k = kBegin; k < numC; ++k)
+    {
+      const AccT improvement = (cAB + costCD[k]) - (AccT(costAC[k]) + costBD[k]);
+      if (improvement > bestImprovement)
+      {
+        bestImprovement = improvement;
+        kBest = k;
+        if (firstImprovement)
+          break;
+      }
+    }
+    return kBest;
+  }
+
+  // merge the running bests of the lanes (laneK < 0 if a lane has none),
+  // the smaller k wins a tie as in the scalar loop
+  template <typename AccT, typename LaneIdxT>
+  static void mergeLanes(
+    const AccT* laneBest, const LaneIdxT* laneK, size_t numLanes,
+    AccT &bestImprovement, size_t &kBest)
+  {
+    for (size_t lane = 0; lane < numLanes; ++lane)
+    {
+      if (laneK[lane] < 0)
+        continue;
+      const size_t k = static_cast<size_t>(laneK[lane]);
+      if (laneBest[lane] > bestImprovement 
+          || (laneBest[lane] == bestImprovement && k < kBest))
+      {
+        bestImprovement = laneBest[lane];
+        kBest = k;
+      }
+    }
+  }
+
+#if defined(__AVX512F__)
+  // 16 candidates per iteration, returns where the scalar loop shall continue
+  // (numC if the first improvement is found)
+  static size_t bestTwoOptCandidateSimd(
+    float cAB, const float* costCD, const float* costAC, const float* costBD,
+    size_t numC, bool firstImprovement, float &bestImprovement, size_t &kBest)
+  {
+    const __m512 ab = _mm512_set1_ps(cAB);
+    __m512 laneBest = _mm512_set1_ps(bestImprovement);
+    __m512i laneK = _mm512_set1_epi32(-1);
+    __m512i ks = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    alignas(64) float improvements[16];
+    size_t k = 0;
+    for (; k + 16 <= numC; k += 16)
+    {
+      const __m512 improvement = _mm512_sub_ps(
+        _mm512_add_ps(ab, _mm512_loadu_ps(costCD + k)),
+        _mm512_add_ps(_mm512_loadu_ps(costAC + k), _mm512_loadu_ps(costBD + k)));
+      const __mmask16 better = _mm512_cmp_ps_mask(improvement, laneBest, _CMP_GT_OQ);
+      if (firstImprovement && better)
+      {
+        const unsigned lane = __builtin_ctz(better);
+        _mm512_store_ps(improvements, improvement);
+        bestImprovement = improvements[lane];
+        kBest = k + lane;
+        return numC;
+      }
+      laneBest = _mm512_mask_blend_ps(better, laneBest, improvement);
+      laneK = _mm512_mask_blend_epi32(better, laneK, ks);
+      ks = _mm512_add_epi32(ks, _mm512_set1_epi32(16));
+    }
+    alignas(64) int32_t laneKs[16];
+    _mm512_store_ps(improvements, laneBest);
+    _mm512_store_si512(laneKs, laneK);
+    mergeLanes(improvements, laneKs, 16, bestImprovement, kBest);
+    return k;
+  }
+
+  // 8 candidates per iteration (in 64 bits)
+  static size_t bestTwoOptCandidateSimd(
+    int64_t cAB, const int* costCD, const int* costAC, const int* costBD,
+    size_t numC, bool firstImprovement, int64_t &bestImprovement, size_t &kBest)
+  {
+    const auto load = [](const int* src) {
+      // (zeroing form, see pointDistancesSimd)
+      return _mm512_maskz_cvtepi32_epi64(
+        0xFF, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)));
+    };
+    const __m512i ab = _mm512_set1_epi64(cAB);
+    __m512i laneBest = _mm512_set1_epi64(bestImprovement);
+    __m512i laneK = _mm512_set1_epi64(-1);
+    __m512i ks = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    alignas(64) int64_t improvements[8];
+    size_t k = 0;
+    for (; k + 8 <= numC; k += 8)
+    {
+      const __m512i improvement = _mm512_sub_epi64(
+        _mm512_add_epi64(ab, load(costCD + k)),
+        _mm512_add_epi64(load(costAC + k), load(costBD + k)));
+      const __mmask8 better = _mm512_cmpgt_epi64_mask(improvement, laneBest);
+      if (firstImprovement && better)
+      {
+        const unsigned lane = __builtin_ctz(better);
+        _mm512_store_si512(improvements, improvement);
+        bestImprovement = improvements[lane];
+        kBest = k + lane;
+        return numC;
+      }
+      laneBest = _mm512_mask_blend_epi64(better, laneBest, improvement);
+      laneK = _mm512_mask_blend_epi64(better, laneK, ks);
+      ks = _mm512_add_epi64(ks, _mm512_set1_epi64(8));
+    }
+    alignas(64) int64_t laneKs[8];
+    _mm512_store_si512(improvements, laneBest);
+    _mm512_store_si512(laneKs, laneK);
+    mergeLanes(improvements, laneKs, 8, bestImprovement, kBest);
+    return k;
+  }
+#elif defined(__AVX2__)
+  // 8 candidates per iteration, returns where the scalar loop shall continue
+  // (numC if the first improvement is found)
+  static size_t bestTwoOptCandidateSimd(
+    float cAB, const float* costCD, const float* costAC, const float* costBD,
+    size_t numC, bool firstImprovement, float &bestImprovement, size_t &kBest)
+  {
+    const __m256 ab = _mm256_set1_ps(cAB);
+    __m256 laneBest = _mm256_set1_ps(bestImprovement);
+    __m256i laneK = _mm256_set1_epi32(-1);
+    __m256i ks = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    alignas(32) float improvements[8];
+    size_t k = 0;
+    for (; k + 8 <= numC; k += 8)
+    {
+      const __m256 improvement = _mm256_sub_ps(
+        _mm256_add_ps(ab, _mm256_loadu_ps(costCD + k)),
+        _mm256_add_ps(_mm256_loadu_ps(costAC + k), _mm256_loadu_ps(costBD + k)));
+      const __m256 better = _mm256_cmp_ps(improvement, laneBest, _CMP_GT_OQ);
+      const int betterMask = _mm256_movemask_ps(better);
+      if (firstImprovement && betterMask)
+      {
+        const unsigned lane = __builtin_ctz(betterMask);
+        _mm256_store_ps(improvements, improvement);
+        bestImprovement = improvements[lane];
+        kBest = k + lane;
+        return numC;
+      }
+      laneBest = _mm256_blendv_ps(laneBest, improvement, better);
+      laneK = _mm256_blendv_epi8(laneK, ks, _mm256_castps_si256(better));
+      ks = _mm256_add_epi32(ks, _mm256_set1_epi32(8));
+    }
+    alignas(32) int32_t laneKs[8];
+    _mm256_store_ps(improvements, laneBest);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(laneKs), laneK);
+    mergeLanes(improvements, laneKs, 8, bestImprovement, kBest);
+    return k;
+  }
+
+  // 4 candidates per iteration (in 64 bits)
+  static size_t bestTwoOptCandidateSimd(
+    int64_t cAB, const int* costCD, const int* costAC, const int* costBD,
+    size_t numC, bool firstImprovement, int64_t &bestImprovement, size_t &kBest)
+  {
+    const auto load = [](const int* src) {
+      return _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+    };
+    const __m256i ab = _mm256_set1_epi64x(cAB);
+    __m256i laneBest = _mm256_set1_epi64x(bestImprovement);
+    __m256i laneK = _mm256_set1_epi64x(-1);
+    __m256i ks = _mm256_setr_epi64x(0, 1, 2, 3);
+    alignas(32) int64_t improvements[4];
+    size_t k = 0;
+    for (; k + 4 <= numC; k += 4)
+    {
+      const __m256i improvement = _mm256_sub_epi64(
+        _mm256_add_epi64(ab, load(costCD + k)),
+        _mm256_add_epi64(load(costAC + k), load(costBD + k)));
+      const __m256i better = _mm256_cmpgt_epi64(improvement, laneBest);
+      const int betterMask = _mm256_movemask_pd(_mm256_castsi256_pd(better));
+      if (firstImprovement && betterMask)
+      {
+        const unsigned lane = __builtin_ctz(betterMask);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(improvements), improvement);
+        bestImprovement = improvements[lane];
+        kBest = k + lane;
+        return numC;
+      }
+      laneBest = _mm256_blendv_epi8(laneBest, improvement, better);
+      laneK = _mm256_blendv_epi8(laneK, ks, better);
+      ks = _mm256_add_epi64(ks, _mm256_set1_epi64x(4));
+    }
+    alignas(32) int64_t laneKs[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(improvements), laneBest);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(laneKs), laneK);
+    mergeLanes(improvements, laneKs, 4, bestImprovement, kBest);
+    return k;
+  }
+#else
+  template <typename T, typename AccT>
+  static size_t bestTwoOptCandidateSimd(
+    AccT, const T*, const T*, const T*, size_t, bool, AccT&, size_t&)
+  {
+    return 0; // nothing is done, so the scalar loop does everything
+  }
+#endif
+
+  size_t bestTwoOptCandidate(
+    float cAB, const float* costCD, const float* costAC, const float* costBD,
+    size_t numC, bool firstImprovement, float &bestImprovement)
+  {
+    size_t kBest = numC;
+    const size_t kDone = bestTwoOptCandidateSimd(
+      cAB, costCD, costAC, costBD, numC, firstImprovement, bestImprovement, kBest);
+    return bestTwoOptCandidateScalar(
+      cAB, costCD, costAC, costBD, kDone, numC, firstImprovement, bestImprovement, kBest);
+  }
+
+  size_t bestTwoOptCandidate(
+    int64_t cAB, const int* costCD, const int* costAC, const int* costBD,
+    size_t numC, bool firstImprovement, int64_t &bestImprovement)
+  {
+    size_t kBest = numC;
+    const size_t kDone = bestTwoOptCandidateSimd(
+      cAB, costCD, costAC, costBD, numC, firstImprovement, bestImprovement, kBest);
+    return bestTwoOptCandidateScalar(
+      cAB, costCD, costAC, costBD, kDone, numC, firstImprovement, bestImprovement, kBest);
+  }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace xtsp::internal
+{
+  /**
+   * @brief distances from one point to many points (batched)
+   *
+   * The point set is stored column by column (as in a column-major 
+   * Eigen matrix), i.e., coordinate d of point i is at \p cols[d*ld + i].
+   * 
+   * If the library is compiled with AVX2 or AVX-512 enabled 
+   * (e.g., -march=native), the single-precision version gathers and 
+   * processes 8 or 16 targets at a time. Otherwise (or for the 
+   * remainder), it falls back to a scalar loop.
+   * 
+   * @param normType 2 -- Euclidean, 1 -- Manhattan, 0 -- maxNorm
+   * @param from the index of the source point
+   * @param to the indices of the target points
+   * @param[out] out out[k] = distance(from, to[k]) for k < numTo
+   */
+  void pointDistances(
+    const float* cols, size_t ld, size_t nDim, int normType,
+    size_t from, const size_t* to, size_t numTo, float* out);
+
+  void pointDistances(
+    const double* cols, size_t ld, size_t nDim, int normType,
+    size_t from, const size_t* to, size_t numTo, double* out);
+
+  /**
+   * @brief the best (or the first) improving 2-opt candidate of a batch
+   *
+   * Exchanging the tour edges A -> B and C_k -> D_k for A -> C_k and
+   * B -> D_k improves the tour by 
+   * (cAB + costCD[k]) - (costAC[k] + costBD[k]).
+   * 
+   * If the library is compiled with AVX2 or AVX-512 enabled, 
+   * 8 or 16 candidates (float), resp. 4 or 8 candidates (int, 
+   * accumulated in 64 bits) are evaluated at a time, each lane keeping
+   * its own running best. The result is the scalar loop's, i.e., 
+   * the first k in case of ties.
+   * 
+   * @param[in,out] bestImprovement only a strictly larger improvement
+   *                is accepted, updated if so
+   * @param firstImprovement stop at the first accepted candidate
+   * @return the accepted k (the best one, or the first one), 
+   *         \p numC if none
+   */
+  size_t bestTwoOptCandidate(
+    float cAB, const float* costCD, const float* costAC, const float* costBD,
+    size_t numC, bool firstImprovement, float &bestImprovement);
+
+  size_t bestTwoOptCandidate(
+    int64_t cAB, const int* costCD, const int* costAC, const int* costBD,
+    size_t numC, bool firstImprovement, int64_t &bestImprovement);
+}
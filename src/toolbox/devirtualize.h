@@ -0,0 +1,65 @@
+#pragma once
+
+#include "xtsp/core/complete_graph.h"
+#include "xtsp/core/point_graph.h"
+#include "xtsp/core/tour.h"
+#include "xtsp/core/tour_alternatives.h"
+#include "xtsp/core/two_level_list_tour.h"
+
+#include <type_traits>
+
+namespace xtsp::internal
+{
+  /**
+   * @brief call @a fn with the graph downcast to its concrete type
+   *
+   * The solvers keep a virtual front door (AbstractCompGraph), but the hot
+   * loops are templates on the graph type. By dispatching once per call
+   * (instead of once per edge), all the \p getEdgeCost inside the hot loop
+   * are resolved at compile time (the overrides are final) and can be inlined.
+   *
+   * Known types: CompleteGraph<CostTy>, and for single precision,
+   * ImplicitCompleteGraph<float> and PointGraph<2, kL2Norm>.
+   * Unknown (e.g., user-defined) graphs fall back to the virtual calls.
+   *
+   * @a fn must return the same type for all the graph types.
+   */
+  template <typename CostTy, typename Fn>
+  decltype(auto) visitConcreteGraph(const AbstractCompGraph<CostTy>& g, Fn&& fn)
+  {
+    if (auto gExplicit = dynamic_cast<const CompleteGraph<CostTy>*>(&g))
+      return fn(*gExplicit);
+    if constexpr (std::is_same_v<CostTy, float>)
+    {
+      if (auto gImplicit = dynamic_cast<const ImplicitCompleteGraph<float>*>(&g))
+        return fn(*gImplicit);
+      if (auto gPts = dynamic_cast<const PointGraph<2, kL2Norm>*>(&g))
+        return fn(*gPts);
+    }
+    return fn(g);
+  }
+
+  /**
+   * @brief call @a fn with the tour downcast to its concrete type
+   *
+   * @see visitConcreteGraph
+   *
+   * @tparam TourTy either AbstractTour or const AbstractTour
+   */
+  template <typename TourTy, typename Fn>
+  decltype(auto) visitConcreteTour(TourTy& tour, Fn&& fn)
+  {
+    static_assert(std::is_same_v<std::remove_const_t<TourTy>, AbstractTour>);
+    constexpr bool isConst = std::is_const_v<TourTy>;
+    using PermTy = std::conditional_t<isConst, const PermTour, PermTour>;
+    using AdjTabTy = std::conditional_t<isConst, const AdjTabTour, AdjTabTour>;
+    using TwoLevelTy = std::conditional_t<isConst, const TwoLevelListTour, TwoLevelListTour>;
+    if (auto tPerm = dynamic_cast<PermTy*>(&tour))
+      return fn(*tPerm);
+    if (auto tAdjTab = dynamic_cast<AdjTabTy*>(&tour))
+      return fn(*tAdjTab);
+    if (auto tTwoLevel = dynamic_cast<TwoLevelTy*>(&tour))
+      return fn(*tTwoLevel);
+    return fn(tour);
+  }
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "xtsp/local_search/move_evaluator.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace xtsp::internal
+{
+  /**
+   * The operators of algo::MoveEvaluator, as compile-time policies:
+   *
+   *  * bound(tour, X, g): the new edge X-C must be shorter than this,
+   *    i.e., the neighbor list of X is scanned until then;
+   *  * evaluate(tour, X, C, cXC, g, res): the moves adding X-C,
+   *    @retval whether \p res is updated.
+   *
+   * The tour edges are undirected here (symmetric graphs),
+   * so each operator tries both tour directions.
+   */
+
+  // the gain of swapping X and Y (adjacent or not)
+  template <typename CostTy, typename TourTy, typename GraphTy>
+  AccumTy<CostTy> swapGain(const TourTy &tour, size_t vX, size_t vY, const GraphTy &g)
+  {
+    const size_t vPX = tour.prev(vX), vNX = tour.next(vX);
+    const size_t vPY = tour.prev(vY), vNY = tour.next(vY);
+    if (vNX == vY) // PX -> X -> Y -> NY
+      return AccumTy<CostTy>(g.getEdgeCost(vPX, vX)) + g.getEdgeCost(vY, vNY)
+        - g.getEdgeCost(vPX, vY) - g.getEdgeCost(vX, vNY);
+    if (vNY == vX) // PY -> Y -> X -> NX
+      return AccumTy<CostTy>(g.getEdgeCost(vPY, vY)) + g.getEdgeCost(vX, vNX)
+        - g.getEdgeCost(vPY, vX) - g.getEdgeCost(vY, vNX);
+    return AccumTy<CostTy>(g.getEdgeCost(vPX, vX)) + g.getEdgeCost(vX, vNX)
+      + g.getEdgeCost(vPY, vY) + g.getEdgeCost(vY, vNY)
+      - g.getEdgeCost(vPX, vY) - g.getEdgeCost(vY, vNX)
+      - g.getEdgeCost(vPY, vX) - g.getEdgeCost(vX, vNY);
+  }
+
+  // the gain of taking X out, i.e., PX - NX instead
+  template <typename CostTy, typename TourTy, typename GraphTy>
+  AccumTy<CostTy> removalGain(const TourTy &tour, size_t vX, const GraphTy &g)
+  {
+    const size_t vPX = tour.prev(vX), vNX = tour.next(vX);
+    return AccumTy<CostTy>(g.getEdgeCost(vPX, vX)) + g.getEdgeCost(vX, vNX)
+      - g.getEdgeCost(vPX, vNX);
+  }
+
+  // the longer tour edge of X
+  template <typename CostTy, typename TourTy, typename GraphTy>
+  AccumTy<CostTy> longerTourEdge(const TourTy &tour, size_t vX, const GraphTy &g)
+  {
+    return std::max(
+      g.getEdgeCost(tour.prev(vX), vX), g.getEdgeCost(vX, tour.next(vX)));
+  }
+
+  // {A, B}, {C, D} -> {A, C}, {B, D} with B, D = next(A), next(C) or prev(A), prev(C)
+  template <typename CostTy>
+  struct TwoOptOperator
+  {
+    template <typename TourTy, typename GraphTy>
+    static AccumTy<CostTy> bound(const TourTy &tour, size_t vA, const GraphTy &g)
+    {
+      return longerTourEdge<CostTy>(tour, vA, g);
+    }
+
+    template <typename TourTy, typename GraphTy>
+    static bool evaluate(
+      const TourTy &tour, size_t vA, size_t vC, CostTy cAC, const GraphTy &g,
+      algo::MoveProposal<CostTy> &res)
+    {
+      bool updated = false;
+      for (const bool forward : {true, false})
+      {
+        const size_t vB = forward ? tour.next(vA) : tour.prev(vA);
+        const size_t vD = forward ? tour.next(vC) : tour.prev(vC);
+        if (vC == vB || vD == vA)
+          continue;
+        const AccumTy<CostTy> gain = AccumTy<CostTy>(g.getEdgeCost(vA, vB))
+          + g.getEdgeCost(vC, vD) - cAC - g.getEdgeCost(vB, vD);
+        updated |= res.updateIfBetter(gain, algo::kExchangeEdges, {vA, vB, vC, vD});
+      }
+      return updated;
+    }
+  };
+
+  // 2-opt, plus the node insertions that share its removed edges [Bentley92]:
+  // C between A and B (adding A-C), or B between C and D
+  template <typename CostTy>
+  struct TwoHOptOperator
+  {
+    template <typename TourTy, typename GraphTy>
+    static AccumTy<CostTy> bound(const TourTy &tour, size_t vA, const GraphTy &g)
+    {
+      return longerTourEdge<CostTy>(tour, vA, g);
+    }
+
+    template <typename TourTy, typename GraphTy>
+    static bool evaluate(
+      const TourTy &tour, size_t vA, size_t vC, CostTy cAC, const GraphTy &g,
+      algo::MoveProposal<CostTy> &res)
+    {
+      bool updated = TwoOptOperator<CostTy>::evaluate(tour, vA, vC, cAC, g, res);
+      for (const bool forward : {true, false})
+      {
+        const size_t vB = forward ? tour.next(vA) : tour.prev(vA);
+        const size_t vD = forward ? tour.next(vC) : tour.prev(vC);
+        if (vC == vB || vD == vA)
+          continue;
+        const AccumTy<CostTy> cAB = g.getEdgeCost(vA, vB);
+        const CostTy cBC = g.getEdgeCost(vB, vC);
+        // C between A and B, i.e., right after whichever comes first
+        const AccumTy<CostTy> gainC = removalGain<CostTy>(tour, vC, g)
+          - cAC - cBC + cAB;
+        updated |= res.updateIfBetter(
+          gainC, algo::kRelocateVertex, {vC, forward ? vA : vB, 0, 0});
+        // B between C and D
+        const AccumTy<CostTy> gainB = removalGain<CostTy>(tour, vB, g)
+          - cBC - g.getEdgeCost(vB, vD) + g.getEdgeCost(vC, vD);
+        updated |= res.updateIfBetter(
+          gainB, algo::kRelocateVertex, {vB, forward ? vC : vD, 0, 0});
+      }
+      return updated;
+    }
+  };
+
+  // X takes the place of Y = next(C) or prev(C), and vice versa
+  template <typename CostTy>
+  struct NodeSwapOperator
+  {
+    template <typename TourTy, typename GraphTy>
+    static AccumTy<CostTy> bound(const TourTy &tour, size_t vX, const GraphTy &g)
+    {
+      return longerTourEdge<CostTy>(tour, vX, g);
+    }
+
+    template <typename TourTy, typename GraphTy>
+    static bool evaluate(
+      const TourTy &tour, size_t vX, size_t vC, CostTy, const GraphTy &g,
+      algo::MoveProposal<CostTy> &res)
+    {
+      bool updated = false;
+      for (const size_t vY : {tour.next(vC), tour.prev(vC)})
+      {
+        if (vY == vX)
+          continue;
+        updated |= res.updateIfBetter(
+          swapGain<CostTy>(tour, vX, vY, g), algo::kSwapVertices, {vX, vY, 0, 0});
+      }
+      return updated;
+    }
+  };
+
+  // X between C and next(C) or prev(C) and C
+  template <typename CostTy>
+  struct NodeInsertionOperator
+  {
+    template <typename TourTy, typename GraphTy>
+    static AccumTy<CostTy> bound(const TourTy &tour, size_t vX, const GraphTy &g)
+    {
+      return removalGain<CostTy>(tour, vX, g);
+    }
+
+    template <typename TourTy, typename GraphTy>
+    static bool evaluate(
+      const TourTy &tour, size_t vX, size_t vC, CostTy cXC, const GraphTy &g,
+      algo::MoveProposal<CostTy> &res)
+    {
+      const AccumTy<CostTy> gainOut = removalGain<CostTy>(tour, vX, g);
+      bool updated = false;
+      for (const bool forward : {true, false})
+      {
+        const size_t vD = forward ? tour.next(vC) : tour.prev(vC);
+        if (vD == vX)
+          continue;
+        const AccumTy<CostTy> gain = gainOut - cXC - g.getEdgeCost(vX, vD)
+          + g.getEdgeCost(vC, vD);
+        updated |= res.updateIfBetter(
+          gain, algo::kRelocateVertex, {vX, forward ? vC : vD, 0, 0});
+      }
+      return updated;
+    }
+  };
+}
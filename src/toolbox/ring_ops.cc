@@ -1,6 +1,7 @@
 #include "ring_ops.h"
 
 #include <algorithm> // std::reverse
+#include <cstdint>
 // #include <cstring> // for memcpy
 #include <stdexcept>
 
@@ -9,7 +10,7 @@
 namespace xtsp::internal
 {
   template <typename T>
-  void reverseRingSegment_strict(std::vector<T> &ring, size_t rankStart, size_t rankEnd)
+  RingRange reverseRingSegment_strict(std::vector<T> &ring, size_t rankStart, size_t rankEnd)
   {
     int segSz = (int)(rankEnd) - (int)(rankStart) + 1;
     if (segSz > (int)ring.size())
@@ -18,29 +19,30 @@ namespace xtsp::internal
     {
       SPDLOG_WARN("ignoring no-op request: rankStart = {:d}, rankEnd = {:d}",
         rankStart, rankEnd);
-      return;
+      return RingRange{rankStart % ring.size(), 0};
     }
     if (segSz == 1)
     {
       std::swap(ring[rankStart%ring.size()], ring[rankEnd%ring.size()]);
-      return;
+      return RingRange{rankStart % ring.size(), 1};
     }
     if (segSz == (int)ring.size())
     {
       std::reverse(std::begin(ring), std::end(ring));
-      return;
+      return RingRange{0, ring.size()};
     }
 
     // compute the "canonical" segment index
     // where the segment start index must be in {0, 1, ..., arraySz - 1}
     const size_t normalizedStart = rankStart % ring.size();
     const size_t normalizedStop = normalizedStart + segSz;
+    const RingRange touched{normalizedStart, (size_t)segSz};
     if (normalizedStop <= ring.size())
     {
       std::reverse(
           std::begin(ring) + normalizedStart,
           std::begin(ring) + normalizedStop);
-      return;
+      return touched;
     }
 
     // now, we tackle the remaining case where
@@ -65,27 +67,90 @@ namespace xtsp::internal
     // {
     //     std::swap(this[indA%ring.size()], this[indB%ring.size()]);
     // }
+    return touched;
   }
 
   template <typename T>
-  bool reverseRingSegment_smart(std::vector<T> &ring, size_t segStart, size_t segEnd)
+  RingRange reverseRingSegment_smart(std::vector<T> &ring, size_t segStart, size_t segEnd)
   {
     if (segStart > segEnd)
       throw std::invalid_argument("segStart index too large");
     size_t segSz = segEnd - segStart;
     if (segSz <= (ring.size() >> 1))
     {
-      reverseRingSegment_strict(ring, segStart, segEnd);
-      return true;
+      return reverseRingSegment_strict(ring, segStart, segEnd);
     }
     else
     {
-      reverseRingSegment_strict(ring, segEnd, segEnd + ring.size() - segSz);
-      return false;
+      // the complement is [segEnd+1, segStart-1] (wrapped)
+      return reverseRingSegment_strict(ring, segEnd + 1, segStart + ring.size() - 1);
     }
   }
 
+  template <typename T>
+  RingRange moveRingSegment(
+    std::vector<T> &ring, size_t segStart, size_t segLen, 
+    size_t rankAfter, bool reversed, std::vector<T> &buf)
+  {
+    const size_t n = ring.size();
+    segStart %= n;
+    rankAfter %= n;
+    if (segLen == 0 || segLen >= n || (rankAfter + n - segStart)%n < segLen)
+      throw std::invalid_argument("invalid segment move specification");
+    // the elements after the segment up to rankAfter (moving it forward),
+    // or those after rankAfter up to the segment (moving it backward)
+    const size_t gapFwd = (rankAfter + n - segStart)%n + 1 - segLen;
+    const size_t gapBwd = n - segLen - gapFwd;
+
+    buf.resize(segLen);
+    for (size_t k = 0; k < segLen; ++k)
+      buf[k] = ring[(segStart + k)%n];
+    if (reversed)
+      std::reverse(buf.begin(), buf.end());
+
+    RingRange touched;
+    if (gapFwd <= gapBwd)
+    {
+      // shift the gap backward by segLen, then put the segment after it
+      touched = RingRange{segStart, gapFwd + segLen};
+      if (segStart + touched.length <= n)
+      {
+        auto first = ring.begin() + segStart;
+        std::copy(first + segLen, first + touched.length, first);
+        std::copy(buf.cbegin(), buf.cend(), first + gapFwd);
+        return touched;
+      }
+      for (size_t k = 0; k < gapFwd; ++k)
+        ring[(segStart + k)%n] = ring[(segStart + segLen + k)%n];
+      for (size_t k = 0; k < segLen; ++k)
+        ring[(segStart + gapFwd + k)%n] = buf[k];
+    }
+    else
+    {
+      // shift the gap forward by segLen, then put the segment before it
+      touched = RingRange{(rankAfter + 1)%n, gapBwd + segLen};
+      if (touched.start + touched.length <= n)
+      {
+        auto first = ring.begin() + touched.start;
+        std::copy_backward(first, first + gapBwd, first + touched.length);
+        std::copy(buf.cbegin(), buf.cend(), first);
+        return touched;
+      }
+      for (size_t k = gapBwd; k-- > 0; )
+        ring[(touched.start + segLen + k)%n] = ring[(touched.start + k)%n];
+      for (size_t k = 0; k < segLen; ++k)
+        ring[(touched.start + k)%n] = buf[k];
+    }
+    return touched;
+  }
+
   // template instantiation
-  template bool reverseRingSegment_smart<size_t>(std::vector<size_t> &, size_t, size_t);
-  template void reverseRingSegment_strict<size_t>(std::vector<size_t> &, size_t, size_t);
+  template RingRange reverseRingSegment_smart<size_t>(std::vector<size_t> &, size_t, size_t);
+  template RingRange reverseRingSegment_strict<size_t>(std::vector<size_t> &, size_t, size_t);
+  template RingRange reverseRingSegment_smart<uint32_t>(std::vector<uint32_t> &, size_t, size_t);
+  template RingRange reverseRingSegment_strict<uint32_t>(std::vector<uint32_t> &, size_t, size_t);
+  template RingRange moveRingSegment<size_t>(
+    std::vector<size_t> &, size_t, size_t, size_t, bool, std::vector<size_t> &);
+  template RingRange moveRingSegment<uint32_t>(
+    std::vector<uint32_t> &, size_t, size_t, size_t, bool, std::vector<uint32_t> &);
 }
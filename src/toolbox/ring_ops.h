@@ -5,6 +5,14 @@
 
 namespace xtsp::internal
 {
+  /// @brief the ranks touched by a ring operation:
+  ///        start, start+1, ..., start+length-1 (wrapped)
+  struct RingRange
+  {
+    size_t start = 0;  // in {0, 1, ..., ring size - 1}
+    size_t length = 0; // in {0, 1, ..., ring size}
+  };
+
   /**
    * @brief efficient inplace reversal/flip a segment indicated by [segStart, segEnd]
    * 
@@ -17,15 +25,37 @@ namespace xtsp::internal
    * 
    *  * with no-op, i.e., segSz = 0 or 1
    *  * segSz = the array size --- i.e., reversing the whole array
+   * 
+   * @return the touched ranks, e.g., for incremental cache maintenance
    */
   template <typename T>
-  void reverseRingSegment_strict(std::vector<T> &ring, size_t rankStart, size_t rankEnd);
+  RingRange reverseRingSegment_strict(std::vector<T> &ring, size_t rankStart, size_t rankEnd);
 
   /// @brief Automatically decide which side to flip.
   /// It's smarter than the strict version "smart" because 
   /// it can reduce the number of operations.
-  /// @return true if the reversal concerns [segStart, segEnd], 
-  ///    false if it's the other (geodesis) "complement" of the segment.
+  /// @return the touched ranks, i.e., either [segStart, segEnd] (normalized)
+  ///    or the other (geodesic) "complement" of the segment.
+  template <typename T>
+  RingRange reverseRingSegment_smart(std::vector<T> &ring, size_t segStart, size_t segEnd);
+
+  /**
+   * @brief move the segment [segStart, segStart + segLen - 1] (wrapped) 
+   *        right after the element at @a rankAfter , optionally reversed
+   *
+   * The elements between the segment and its destination are shifted 
+   * by @a segLen , on whichever side of the ring is shorter.
+   * So the cost is O(min(gap, ring size - gap)), with memmove
+   * (i.e., std::copy) when the touched ranks don't wrap around.
+   * 
+   * @param rankAfter must be outside the segment; if it is 
+   *        the rank just before the segment, the segment stays 
+   *        (and is reversed if requested).
+   * @param buf scratch for the segment (to avoid allocations)
+   * @return the touched ranks
+   */
   template <typename T>
-  bool reverseRingSegment_smart(std::vector<T> &ring, size_t segStart, size_t segEnd);
+  RingRange moveRingSegment(
+    std::vector<T> &ring, size_t segStart, size_t segLen, 
+    size_t rankAfter, bool reversed, std::vector<T> &buf);
 }
\ No newline at end of file
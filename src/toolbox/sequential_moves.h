@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+
+namespace xtsp::internal
+{
+  /**
+   * @brief the same tour, read in the opposite direction
+   *
+   * A sequential move search (e.g., 3-opt, Lin-Kernighan) usually
+   * starts by removing the edge t1 -> next(t1). Running the same search
+   * on this view covers t1 -> prev(t1) instead, without duplicating
+   * the case analysis.
+   *
+   * The modifiers are translated such that the resulting cycle is
+   * the one intended in the mirrored view (including \p strict ).
+   *
+   * @tparam TourTy AbstractTour or one of its concrete types
+   *         (add const for a read-only view)
+   */
+  template <typename TourTy>
+  class MirroredTour
+  {
+  public:
+    explicit MirroredTour(TourTy& tour) : m_tour(tour)
+    {
+    }
+    size_t size() const
+    {
+      return m_tour.size();
+    }
+    size_t next(size_t v) const
+    {
+      return m_tour.prev(v);
+    }
+    size_t prev(size_t v) const
+    {
+      return m_tour.next(v);
+    }
+    bool between(size_t vA, size_t vB, size_t vC) const
+    {
+      return m_tour.between(vC, vB, vA);
+    }
+    // A -> B and C -> D here are B -> A and D -> C in the actual tour
+    void exchangeTwoEdges(size_t vA, size_t vC, bool strict = false)
+    {
+      m_tour.exchangeTwoEdges(m_tour.prev(vC), m_tour.prev(vA), strict);
+    }
+    // P -> S1 ... S2 -> Q here is Q -> S2 ... S1 -> P in the actual tour
+    void moveSegment(size_t vS1, size_t vS2, size_t vP, bool reversed = false)
+    {
+      m_tour.moveSegment(vS2, vS1, m_tour.prev(vP), reversed);
+    }
+
+  protected:
+    TourTy& m_tour;
+  };
+
+  /**
+   * @brief replace the tour edges {A, B} and {C, D} by {A, C} and {B, D}
+   *
+   * The same as exchangeTwoEdges, except that the edges are undirected,
+   * i.e., it doesn't matter which direction the tour currently has
+   * (e.g., after a non-strict flip).
+   * The caller must ensure that the result is a cycle, i.e.,
+   * A -> B and C -> D are in the same direction.
+   */
+  template <typename TourTy>
+  void exchangeUndirectedEdges(TourTy& tour, size_t vA, size_t vB, size_t vC, size_t vD)
+  {
+    if (tour.next(vA) == vB)
+      tour.exchangeTwoEdges(vA, vC);
+    else // i.e., B -> A and D -> C
+      tour.exchangeTwoEdges(vB, vD);
+  }
+}
@@ -0,0 +1,93 @@
+#include "xtsp/core/candidate_set.h"
+#include "xtsp/core/utils.h"
+
+#include <gtest/gtest.h>
+#include "../expect_throw_and_msg.h"
+
+// the spatial query should agree with the brute force
+TEST(CandidateSet, kdTreeVsPartialSort)
+{
+  const size_t numPts = 300;
+  const size_t K = 7;
+  xtsp::utils::Rng_T rng(7);
+  std::uniform_int_distribution<int> coord(0, 50); // plenty of ties
+  Eigen::MatrixXf xy(numPts, 2);
+  for (size_t i = 0; i < numPts; ++i)
+    for (int d = 0; d < 2; ++d)
+      xy(i, d) = coord(rng);
+  xtsp::ImplicitCompleteGraph<float> gPts(xy);
+
+  Eigen::MatrixXf mat(numPts, numPts);
+  for (size_t i = 0; i < numPts; ++i)
+    for (size_t j = 0; j < numPts; ++j)
+      mat(i, j) = gPts.getEdgeCost(i, j);
+  xtsp::CompleteGraph<float> gMat(true, mat);
+
+  auto candKd = xtsp::CandidateSet<float>::fromGraph(gPts, K);
+  auto candMat = xtsp::CandidateSet<float>::fromGraph(gMat, K);
+  ASSERT_EQ(candKd.numVertices(), numPts);
+  ASSERT_EQ(candMat.numVertices(), numPts);
+  ASSERT_EQ(candKd.maxNumCandidates(), K);
+  for (size_t v = 0; v < numPts; ++v)
+  {
+    auto rowKd = candKd.getCandidates(v);
+    auto rowMat = candMat.getCandidates(v);
+    ASSERT_EQ(rowKd.size(), K);
+    ASSERT_EQ(rowMat.size(), K);
+    for (size_t k = 0; k < K; ++k)
+    {
+      EXPECT_NE(rowKd[k].vertex, v);
+      EXPECT_EQ(rowKd[k].cost, gPts.getEdgeCost(v, rowKd[k].vertex));
+      EXPECT_EQ(rowKd[k].cost, rowMat[k].cost) << "v = " << v << ", k = " << k;
+      if (k > 0)
+      {
+        EXPECT_LE(rowKd[k-1].cost, rowKd[k].cost);
+      }
+    }
+  }
+}
+
+TEST(CandidateSet, asymmetricUsesOutgoingEdges)
+{
+  Eigen::MatrixXi mat(4, 4);
+  mat << 0, 5, 1, 9,
+         2, 0, 8, 3,
+         7, 6, 0, 4,
+         1, 1, 9, 0;
+  xtsp::CompleteGraph<int> g(false, mat);
+  auto cand = xtsp::CandidateSet<int>::fromGraph(g, 10);
+  ASSERT_EQ(cand.maxNumCandidates(), 3); // capped at N-1
+  std::vector<std::vector<size_t>> expected = {
+    {2, 1, 3}, {0, 3, 2}, {3, 1, 0}, {0, 1, 2}};
+  for (size_t v = 0; v < 4; ++v)
+  {
+    auto row = cand.getCandidates(v);
+    ASSERT_EQ(row.size(), 3);
+    for (size_t k = 0; k < 3; ++k)
+    {
+      EXPECT_EQ(row[k].vertex, expected[v][k]);
+      EXPECT_EQ(row[k].cost, mat(v, row[k].vertex));
+    }
+  }
+}
+
+TEST(CandidateSet, customRows)
+{
+  using Entry = xtsp::CandidateSet<int>::Entry;
+  xtsp::CandidateSet<int> cand({0, 2, 2, 3}, {{1, 3}, {2, 4}, {0, 1}});
+  EXPECT_EQ(cand.numVertices(), 3);
+  EXPECT_EQ(cand.numCandidates(0), 2);
+  EXPECT_EQ(cand.numCandidates(1), 0);
+  EXPECT_EQ(cand.maxNumCandidates(), 2);
+  size_t cnt = 0;
+  for (const Entry& e : cand.getCandidates(1))
+    cnt += e.vertex + 1;
+  EXPECT_EQ(cnt, 0);
+
+  expect_throw_thisMsg<std::invalid_argument>(
+    []() { xtsp::CandidateSet<int>({0, 2, 4}, {{1, 3}, {2, 4}, {0, 1}}); },
+    "CandidateSet ctor: the offsets don't match the entries");
+  expect_throw_thisMsg<std::invalid_argument>(
+    []() { xtsp::CandidateSet<int>({0, 2, 1, 3}, {{1, 3}, {2, 4}, {0, 1}}); },
+    "CandidateSet ctor: the offsets must be non-decreasing");
+}
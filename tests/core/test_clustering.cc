@@ -1,6 +1,7 @@
 #include "xtsp/core/clustering.h"
 
 #include <gtest/gtest.h>
+#include <algorithm>
 // #include "../expect_throw_and_msg.h"
 #include <spdlog/spdlog.h>
 
@@ -140,4 +141,20 @@ TEST(clustering, cumsum)
   EXPECT_EQ(clustering.getMembers(1)[2], 4);
   EXPECT_EQ(clustering.getMembers(2)[0], 5);
   EXPECT_EQ(clustering.numVertices(), 6);
-}
\ No newline at end of file
+}
+TEST(clustering, wideIndexTypeSameAsDefault)
+{
+  const std::vector<std::vector<size_t>> membership {{6, 4}, {2, 1, 5}, {0, 3}, {7}};
+  xtsp::Clustering clustering(8, membership);
+  xtsp::BasicClustering<size_t> clusteringWide(8, membership);
+  ASSERT_EQ(clustering.numClusters(), clusteringWide.numClusters());
+  for (size_t m = 0; m < clustering.numClusters(); ++m)
+  {
+    const auto& members = clustering.getMembers(m);
+    const auto& membersWide = clusteringWide.getMembers(m);
+    EXPECT_TRUE(std::equal(members.cbegin(), members.cend(), 
+                           membersWide.cbegin(), membersWide.cend())) << "at m = " << m;
+  }
+  for (size_t v = 0; v < clustering.numVertices(); ++v)
+    EXPECT_EQ(clustering.getClusterId(v), clusteringWide.getClusterId(v)) << "at v = " << v;
+}
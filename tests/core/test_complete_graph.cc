@@ -1,4 +1,5 @@
 #include "xtsp/core/complete_graph.h"
+#include "xtsp/core/utils.h"
 
 #include <gtest/gtest.h>
 #include <spdlog/spdlog.h>
@@ -49,6 +50,43 @@ TEST_F(SimpleCompleteGraphInt, symmetricCostQuery)
         << "wrong edge cost value at (i,j) = (" << i << ", " << j << ")";
 }
 
+TEST_F(SimpleCompleteGraphInt, packedLowerTriangle)
+{
+  xtsp::CompleteGraph<int> gFromMat (true, this->costMatrix);
+  EXPECT_EQ(gFromMat.numStoredCosts(), 4*5/2);
+
+  // row by row: (0,0), (1,0), (1,1), (2,0), ...
+  std::vector<int> packed = {0, 15, 0, 12, 3, 0, 23, 7, 6, 0};
+  auto g = xtsp::CompleteGraph<int>::fromPackedLowerTriangle(4, std::move(packed));
+  EXPECT_TRUE(g.isSymmetric());
+  EXPECT_EQ(g.numVertices(), 4);
+  for (size_t i = 0; i < 4; ++i)
+    for (size_t j = 0; j < 4; ++j)
+      EXPECT_EQ(g.getEdgeCost(i,j), gFromMat.getEdgeCost(i,j))
+        << "wrong edge cost value at (i,j) = (" << i << ", " << j << ")";
+
+  EXPECT_THROW(
+    xtsp::CompleteGraph<int>::fromPackedLowerTriangle(4, std::vector<int>(16)),
+    std::invalid_argument);
+}
+
+TEST_F(SimpleCompleteGraphInt, batchedCostQuery)
+{
+  std::vector<size_t> to = {3, 0, 2, 2, 1};
+  std::vector<int> out(to.size());
+  for (const bool isSymmetric : {false, true})
+  {
+    xtsp::CompleteGraph<int> g (isSymmetric, this->costMatrix);
+    for (size_t from = 0; from < 4; ++from)
+    {
+      g.getEdgeCosts(from, to.data(), to.size(), out.data());
+      for (size_t k = 0; k < to.size(); ++k)
+        EXPECT_EQ(out[k], g.getEdgeCost(from, to[k])) 
+          << "from = " << from << ", to = " << to[k];
+    }
+  }
+}
+
 class VerySmallImplicitCompleteGraph2D : public testing::Test
 {
 protected:
@@ -125,6 +163,37 @@ TEST_F(SimpleImplicitCompleteGraph3D, costQuery)
   }
 }
 
+// (long enough to cover both the SIMD part and the remainder if any)
+TEST(ImplicitCompleteGraphBatched, sameAsSingleQuery)
+{
+  xtsp::utils::Rng_T rng(3);
+  std::uniform_real_distribution<float> coord(-50, 50);
+  const size_t numPts = 45;
+  for (const int nDim : {2, 3})
+  {
+    Eigen::MatrixXf xy(numPts, nDim);
+    for (size_t i = 0; i < numPts; ++i)
+      for (int d = 0; d < nDim; ++d)
+        xy(i, d) = coord(rng);
+    std::vector<size_t> to;
+    xtsp::utils::genPermutation(rng, numPts, to);
+    to.resize(numPts - 8);
+    std::vector<float> out(to.size());
+    for (const int normType : {0, 1, 2})
+    {
+      xtsp::ImplicitCompleteGraph<float> g(xy, nullptr, normType);
+      for (const size_t from : {0, 17, 44})
+      {
+        g.getEdgeCosts(from, to.data(), to.size(), out.data());
+        for (size_t k = 0; k < to.size(); ++k)
+          EXPECT_FLOAT_EQ(out[k], g.getEdgeCost(from, to[k])) 
+            << "nDim = " << nDim << ", norm = " << normType 
+            << ", from = " << from << ", to = " << to[k];
+      }
+    }
+  }
+}
+
 TEST(SimpleImplicitCompleteGraph2D, explicitize)
 {
   // setup the test
@@ -150,12 +219,46 @@ TEST(SimpleImplicitCompleteGraph2D, explicitize)
   float upscale = 1000.;
   // the test subject
   auto gExplicit = g.explicitize(upscale);
+  EXPECT_TRUE(gExplicit.isSymmetric());
+  EXPECT_EQ(gExplicit.numStoredCosts(), 6*7/2);
   for (size_t i = 0; i < g.numVertices(); ++i)
     for (size_t j = 0; j < g.numVertices(); ++j)
       EXPECT_EQ(nint(g.getEdgeCost(i,j)*upscale), gExplicit.getEdgeCost(i,j)) 
         << "i = " << i << ", j = " << j;
 }
 
+TEST(SimpleImplicitCompleteGraph2D, explicitizeNarrow)
+{
+  Eigen::Matrix<float, 4, 2> xy;
+  xy <<
+    0, 0,
+    3, 4,
+    6, 8,
+    0, 8;
+  xtsp::ImplicitCompleteGraph<float> g(xy);
+  EXPECT_FLOAT_EQ(g.upperBoundEdgeCost(), 10);
+
+  auto gU16 = g.explicitizeAs<uint16_t>(1000);
+  auto gInt = g.explicitize(1000);
+  for (size_t i = 0; i < g.numVertices(); ++i)
+    for (size_t j = 0; j < g.numVertices(); ++j)
+      EXPECT_EQ(gU16.getEdgeCost(i,j), gInt.getEdgeCost(i,j)) 
+        << "i = " << i << ", j = " << j;
+
+  // 10*4000 > 32767
+  EXPECT_THROW(g.explicitizeAs<int16_t>(4000), std::invalid_argument);
+  EXPECT_NO_THROW(g.explicitizeAs<int16_t>(3000));
+
+  // the bound is 10*scale
+  auto gSmall = g.explicitizeNarrowest(6000);
+  ASSERT_TRUE(std::holds_alternative<xtsp::CompleteGraph<uint16_t>>(gSmall));
+  EXPECT_EQ(std::get<xtsp::CompleteGraph<uint16_t>>(gSmall).getEdgeCost(0, 1), 30000);
+  auto gLarge = g.explicitizeNarrowest(7000);
+  ASSERT_TRUE(std::holds_alternative<xtsp::CompleteGraph<uint32_t>>(gLarge));
+  EXPECT_EQ(std::get<xtsp::CompleteGraph<uint32_t>>(gLarge).getEdgeCost(0, 2), 70000);
+  EXPECT_THROW(g.explicitizeNarrowest(1e9), std::invalid_argument);
+}
+
 TEST(clusterSuperGraph, usingAveraging)
 {
   // setup the test
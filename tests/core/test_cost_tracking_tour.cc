@@ -0,0 +1,119 @@
+#include "xtsp/core/cost_tracking_tour.h"
+#include "xtsp/core/tour_alternatives.h"
+#include "xtsp/core/utils.h"
+
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+#include <random>
+
+static void runRandomFlips(
+  xtsp::CostTrackingTour<int>& tracked, xtsp::utils::Rng_T& rng, size_t numFlips)
+{
+  std::uniform_int_distribution<size_t> pickVertex(0, tracked.size()-1);
+  for (size_t k = 0; k < numFlips; )
+  {
+    const size_t vA = pickVertex(rng);
+    const size_t vC = pickVertex(rng);
+    if (vA == vC || tracked.next(vA) == vC || tracked.next(vC) == vA)
+      continue;
+    tracked.exchangeTwoEdges(vA, vC, k%2 == 0);
+    ++k;
+  }
+}
+
+class CostTrackingTour : public testing::TestWithParam<bool>
+{
+protected:
+  void SetUp() override
+  {
+    spdlog::set_level(spdlog::level::warn);
+    const bool symmetric = GetParam();
+    std::uniform_int_distribution<int> pickCost(1, 100);
+    Eigen::Matrix<int, -1, -1> costs(m_numV, m_numV);
+    for (size_t i = 0; i < m_numV; ++i)
+      for (size_t j = 0; j < m_numV; ++j)
+        costs(i, j) = pickCost(m_rng);
+    if (symmetric)
+      costs = (costs + costs.transpose()).eval();
+    m_graph = std::make_unique<xtsp::CompleteGraph<int>>(symmetric, costs);
+    xtsp::utils::genPermutation(m_rng, m_numV, m_perm);
+  }
+
+  const size_t m_numV = 30;
+  xtsp::utils::Rng_T m_rng {17};
+  std::unique_ptr<xtsp::CompleteGraph<int>> m_graph;
+  std::vector<size_t> m_perm;
+};
+
+TEST_P(CostTrackingTour, sameAsEvalTourAfterFlips)
+{
+  xtsp::AdjTabTour tour(m_perm);
+  // audit after every move
+  xtsp::CostTrackingTour<int> tracked(tour, *m_graph, 1);
+  EXPECT_EQ(tracked.cost(), xtsp::evalTour(tour, *m_graph));
+  for (size_t iter = 0; iter < 10; ++iter)
+  {
+    ASSERT_NO_THROW(runRandomFlips(tracked, m_rng, 20));
+    ASSERT_EQ(tracked.cost(), xtsp::evalTour(tour, *m_graph)) << "iter = " << iter;
+  }
+}
+
+TEST_P(CostTrackingTour, rollbackRestoresTheCost)
+{
+  xtsp::PermTour tour(m_perm);
+  xtsp::CostTrackingTour<int> tracked(tour, *m_graph);
+  const auto costBefore = tracked.cost();
+  const size_t cp = tracked.checkpoint();
+  runRandomFlips(tracked, m_rng, 25);
+  tracked.rollback(cp);
+  EXPECT_EQ(tracked.cost(), costBefore);
+  EXPECT_EQ(xtsp::evalTour(tour, *m_graph), costBefore);
+}
+
+TEST_P(CostTrackingTour, auditCatchesDirectModification)
+{
+  xtsp::AdjTabTour tour(m_perm);
+  xtsp::CostTrackingTour<int> tracked(tour, *m_graph);
+  // bypassing the wrapper, by the first flip of A = perm[0]
+  // that changes the cost (probed on a copy of the tour)
+  const size_t vA = m_perm[0];
+  size_t vC = m_perm[2];
+  for (size_t k = 2; k + 1 < m_numV; ++k)
+  {
+    xtsp::AdjTabTour probe(m_perm);
+    probe.exchangeTwoEdges(vA, m_perm[k]);
+    if (xtsp::evalTour(probe, *m_graph) != tracked.cost())
+    {
+      vC = m_perm[k];
+      break;
+    }
+  }
+  tour.exchangeTwoEdges(vA, vC);
+  ASSERT_NE(tracked.cost(), xtsp::evalTour(tour, *m_graph));
+  EXPECT_THROW(tracked.audit(), std::logic_error);
+  tracked.resync();
+  EXPECT_NO_THROW(tracked.audit());
+}
+
+INSTANTIATE_TEST_SUITE_P(symmetricOrNot, CostTrackingTour, testing::Bool());
+
+TEST_P(CostTrackingTour, sameAsEvalTourAfterSegmentMoves)
+{
+  xtsp::PermTour tour(m_perm);
+  // audit after every move
+  xtsp::CostTrackingTour<int> tracked(tour, *m_graph, 1);
+  const size_t cp = tracked.checkpoint();
+  std::uniform_int_distribution<size_t> pickVertex(0, m_numV-1);
+  for (size_t iter = 0; iter < 100; ++iter)
+  {
+    const size_t vS1 = pickVertex(m_rng);
+    const size_t vS2 = tracked.next(tracked.next(vS1));
+    size_t vP = tracked.prev(vS1);
+    for (size_t steps = pickVertex(m_rng)%(m_numV - 4); steps > 0; --steps)
+      vP = tracked.prev(vP);
+    ASSERT_NO_THROW(tracked.moveSegment(vS1, vS2, vP, iter%2 == 0)) << "iter = " << iter;
+  }
+  tracked.rollback(cp);
+  EXPECT_EQ(tour.getSequence(), m_perm);
+  EXPECT_EQ(tracked.cost(), xtsp::evalTour(tour, *m_graph));
+}
@@ -0,0 +1,135 @@
+#include "xtsp/core/complete_graph.h"
+#include "xtsp/core/kdtree.h"
+#include "xtsp/core/utils.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+// compare against brute force on random points
+class KdTreeRandomPoints : public testing::TestWithParam<std::tuple<int, int>>
+{
+protected:
+  const size_t m_numPts = 500;
+  Eigen::MatrixXf m_xy;
+  int m_nDim;
+  int m_normType;
+
+  void SetUp() override
+  {
+    std::tie(m_nDim, m_normType) = GetParam();
+    xtsp::utils::Rng_T rng(42);
+    std::uniform_int_distribution<int> coord(0, 100); // plenty of ties
+    m_xy.resize(m_numPts, m_nDim);
+    for (size_t i = 0; i < m_numPts; ++i)
+      for (int d = 0; d < m_nDim; ++d)
+        m_xy(i, d) = coord(rng);
+  }
+
+  // the k-th smallest distance from v (among all others)
+  std::vector<float> sortedDistances(const xtsp::ImplicitCompleteGraph<float>& g, size_t v) const
+  {
+    std::vector<float> dists;
+    for (size_t u = 0; u < m_numPts; ++u)
+      if (u != v)
+        dists.emplace_back(g.getEdgeCost(v, u));
+    std::sort(dists.begin(), dists.end());
+    return dists;
+  }
+};
+
+TEST_P(KdTreeRandomPoints, kNearest)
+{
+  xtsp::ImplicitCompleteGraph<float> g(m_xy, nullptr, m_normType);
+  const auto& tree = g.getKdTree();
+  ASSERT_EQ(tree.numPoints(), m_numPts);
+  ASSERT_EQ(tree.nDim(), m_nDim);
+
+  const size_t k = 7;
+  std::vector<size_t> allNeighbors;
+  ASSERT_EQ(tree.kNearestAll(k, allNeighbors), k);
+  ASSERT_EQ(allNeighbors.size(), m_numPts*k);
+
+  std::vector<size_t> neighbors;
+  for (size_t v = 0; v < m_numPts; ++v)
+  {
+    auto expectedDists = sortedDistances(g, v);
+    tree.kNearest(v, k, neighbors);
+    ASSERT_EQ(neighbors.size(), k);
+    for (size_t i = 0; i < k; ++i)
+    {
+      EXPECT_NE(neighbors[i], v);
+      EXPECT_FLOAT_EQ(g.getEdgeCost(v, neighbors[i]), expectedDists[i])
+        << "v = " << v << ", i = " << i;
+      EXPECT_EQ(allNeighbors[v*k + i], neighbors[i]) << "v = " << v << ", i = " << i;
+    }
+  }
+}
+
+TEST_P(KdTreeRandomPoints, radiusSearch)
+{
+  xtsp::ImplicitCompleteGraph<float> g(m_xy, nullptr, m_normType);
+  const auto& tree = g.getKdTree();
+  const float radius = 9;
+  std::vector<size_t> found;
+  for (size_t v = 0; v < m_numPts; v += 7)
+  {
+    tree.radiusSearch(v, radius, found);
+    std::sort(found.begin(), found.end());
+    std::vector<size_t> expected;
+    for (size_t u = 0; u < m_numPts; ++u)
+      if (u != v && g.getEdgeCost(v, u) <= radius)
+        expected.emplace_back(u);
+    EXPECT_EQ(found, expected) << "v = " << v;
+  }
+}
+
+TEST_P(KdTreeRandomPoints, nearestActiveWithDeletion)
+{
+  xtsp::ImplicitCompleteGraph<float> g(m_xy, nullptr, m_normType);
+  // deletion requires a copy
+  xtsp::KdTree<float> tree = g.getKdTree();
+
+  // a nearest-neighbor tour: delete each point as it gets visited
+  size_t v = 0;
+  tree.deletePoint(v);
+  for (size_t numVisited = 1; numVisited < m_numPts; ++numVisited)
+  {
+    size_t u = tree.nearestActive(v);
+    ASSERT_LT(u, m_numPts);
+    EXPECT_FALSE(tree.isDeleted(u));
+
+    float expectedDist = std::numeric_limits<float>::max();
+    for (size_t w = 0; w < m_numPts; ++w)
+      if (!tree.isDeleted(w))
+        expectedDist = std::min(expectedDist, g.getEdgeCost(v, w));
+    EXPECT_FLOAT_EQ(g.getEdgeCost(v, u), expectedDist);
+
+    tree.deletePoint(u);
+    v = u;
+  }
+  EXPECT_EQ(tree.numActive(), 0);
+  EXPECT_EQ(tree.nearestActive(v), std::numeric_limits<size_t>::max());
+
+  // the graph's own tree is intact
+  EXPECT_EQ(g.getKdTree().numActive(), m_numPts);
+  tree.restoreAll();
+  EXPECT_EQ(tree.numActive(), m_numPts);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  nDimAndNormType, KdTreeRandomPoints,
+  testing::Combine(testing::Values(2, 3), testing::Values(0, 1, 2)));
+
+TEST(KdTree, tinyPointSet)
+{
+  Eigen::MatrixXf xy(2, 2);
+  xy << 0, 0, 
+        3, 4;
+  xtsp::KdTree<float> tree(xy);
+  EXPECT_FLOAT_EQ(tree.distance(0, 1), 5);
+  std::vector<size_t> neighbors;
+  tree.kNearest(0, 5, neighbors);
+  ASSERT_EQ(neighbors.size(), 1);
+  EXPECT_EQ(neighbors[0], 1);
+}
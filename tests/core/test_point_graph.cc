@@ -0,0 +1,85 @@
+#include "xtsp/core/point_graph.h"
+#include "xtsp/core/utils.h"
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <spdlog/spdlog.h>
+
+static const auto dataDir = std::filesystem::path(
+  __FILE__).parent_path().parent_path()/"dataset";
+
+template <size_t NDim, xtsp::NormType Norm>
+static void expectSameAsImplicit()
+{
+  xtsp::utils::Rng_T rng(5);
+  std::uniform_real_distribution<float> coord(-20, 20);
+  const size_t numPts = 30;
+  Eigen::MatrixXf xy(numPts, NDim);
+  for (size_t i = 0; i < numPts; ++i)
+    for (size_t d = 0; d < NDim; ++d)
+      xy(i, d) = coord(rng);
+
+  xtsp::ImplicitCompleteGraph<float> gRef(xy, nullptr, Norm);
+  xtsp::PointGraph<NDim, Norm> g(xy);
+  ASSERT_EQ(g.numVertices(), numPts);
+  EXPECT_TRUE(g.isSymmetric());
+  EXPECT_EQ(g.getXy(), xy);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(&g.getPoint(1)) % alignof(decltype(g.getPoint(1))), 0);
+
+  std::vector<size_t> to(numPts);
+  std::vector<float> out(numPts);
+  for (size_t j = 0; j < numPts; ++j)
+    to[j] = j;
+  for (size_t i = 0; i < numPts; ++i)
+  {
+    g.getEdgeCosts(i, to.data(), numPts, out.data());
+    for (size_t j = 0; j < numPts; ++j)
+    {
+      EXPECT_FLOAT_EQ(g.getEdgeCost(i, j), gRef.getEdgeCost(i, j)) 
+        << "i = " << i << ", j = " << j;
+      EXPECT_EQ(out[j], g.getEdgeCost(i, j));
+    }
+  }
+}
+
+TEST(PointGraph, sameAsImplicitCompleteGraph)
+{
+  expectSameAsImplicit<2, xtsp::kL2Norm>();
+  expectSameAsImplicit<3, xtsp::kL2Norm>();
+  expectSameAsImplicit<2, xtsp::kL1Norm>();
+  expectSameAsImplicit<3, xtsp::kL1Norm>();
+  expectSameAsImplicit<2, xtsp::kMaxNorm>();
+  expectSameAsImplicit<3, xtsp::kMaxNorm>();
+}
+
+TEST(PointGraph, wrongDimension)
+{
+  Eigen::MatrixXf xy(4, 3);
+  xy.setZero();
+  EXPECT_THROW((xtsp::PointGraph<2, xtsp::kL2Norm>(xy)), std::invalid_argument);
+}
+
+TEST(PointGraph, loadFromTsplibFile)
+{
+  spdlog::set_level(spdlog::level::warn);
+  auto anyGraph = xtsp::loadPointGraphFromTsplibFile(dataDir/"pr144.tsp");
+  ASSERT_TRUE((std::holds_alternative<xtsp::PointGraph<2, xtsp::kL2Norm>>(anyGraph)));
+
+  auto gRef = xtsp::ImplicitCompleteGraph<float>::loadFromTsplibFile(dataDir/"pr144.tsp");
+  std::visit([&gRef](const auto& g)
+  {
+    ASSERT_EQ(g.numVertices(), gRef.numVertices());
+    EXPECT_FALSE(g.isClustered());
+    for (size_t i = 0; i < g.numVertices(); i += 7)
+      for (size_t j = 0; j < g.numVertices(); ++j)
+        EXPECT_FLOAT_EQ(g.getEdgeCost(i, j), gRef.getEdgeCost(i, j));
+  }, anyGraph);
+
+  // a GTSP instance
+  auto anyGtsp = xtsp::loadPointGraphFromTsplibFile(dataDir/"20kroA100.gtsp");
+  std::visit([](const auto& g)
+  {
+    EXPECT_EQ(g.numVertices(), 100);
+    EXPECT_EQ(g.numClusters(), 20);
+  }, anyGtsp);
+}
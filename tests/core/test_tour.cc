@@ -1,11 +1,14 @@
 #include "xtsp/core/tour.h"
 #include "xtsp/core/tour_alternatives.h"
+#include "xtsp/core/two_level_list_tour.h"
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_INFO
 #include <spdlog/spdlog.h>
 #include <spdlog/fmt/bundled/format.h>
 #include "xtsp/core/utils.h"
+#include "../expect_throw_and_msg.h"
 
 
 TEST(hamiltonianPermTour, successfulInit)
@@ -173,6 +176,7 @@ static std::vector<std::pair<std::unique_ptr<xtsp::AbstractTour>, std::string>>
   std::vector<std::pair<std::unique_ptr<xtsp::AbstractTour>, std::string>> tours;
   addTourDtypeIntoTestRunner<xtsp::PermTour>(tours, permData);
   addTourDtypeIntoTestRunner<xtsp::AdjTabTour>(tours, permData);
+  addTourDtypeIntoTestRunner<xtsp::TwoLevelListTour>(tours, permData);
   return tours;
 }
 
@@ -320,4 +324,320 @@ TEST(TwoEdgeExchangeMore, vertexDImmediatelyBeforeVertexA)
       vHead = tour->next(vHead);
     }
   }
-}
\ No newline at end of file
+}
+TEST(TwoEdgeExchangeMore, nonStrictFlipsTheShorterSide)
+{
+  // flipping BC = 1, ..., 6 is more expensive than flipping DA = 7, 0
+  std::vector<size_t> originalPerm   {0, 1, 2, 3, 4, 5, 6, 7};
+  size_t vA = 0, vC = 6;
+  // the same tour as {0, 6, 5, 4, 3, 2, 1, 7} but possibly in reverse
+  std::vector<size_t> expectedResult {0, 6, 5, 4, 3, 2, 1, 7};
+  auto testToursWithDTypeName = addAllTourDtypeIntoTestRunner(originalPerm);
+  for (auto& [tour, tourDTypeName] : testToursWithDTypeName)
+  {
+    SPDLOG_INFO("Testing Datatype {}", tourDTypeName);
+    tour->exchangeTwoEdges(vA, vC, false);
+    SPDLOG_INFO("Tour (after)   : {}", tour->print());
+    EXPECT_TRUE(tour->isHamiltonian()) << tourDTypeName;
+    for (size_t rank = 0; rank < expectedResult.size(); ++rank)
+    {
+      size_t v = expectedResult[rank];
+      size_t vNext = expectedResult[(rank+1)%expectedResult.size()];
+      EXPECT_TRUE(tour->next(v) == vNext || tour->prev(v) == vNext)
+        << tourDTypeName << ", " << "rank = " << rank;
+    }
+  }
+}
+
+// many random flips on small segments (so that splits and rebuilds happen)
+TEST(TwoLevelListTour, randomFlipsSameAsPermTour)
+{
+  spdlog::set_level(spdlog::level::warn);
+  const size_t numV = 200;
+  xtsp::utils::Rng_T rng(5);
+  std::vector<size_t> perm;
+  xtsp::utils::genPermutation(rng, numV, perm);
+  xtsp::PermTour tourRef(perm);
+  xtsp::TwoLevelListTour tour(perm, -1, true, 3);
+  std::vector<size_t> posRef(numV);
+
+  std::uniform_int_distribution<size_t> pickVertex(0, numV-1);
+  for (size_t iter = 0; iter < 2000; ++iter)
+  {
+    const size_t vA = pickVertex(rng);
+    const size_t vC = pickVertex(rng);
+    if (vA == vC || tourRef.next(vA) == vC || tourRef.next(vC) == vA)
+      continue;
+    // strict: the same orientation, hence the same sequence
+    tourRef.exchangeTwoEdges(vA, vC, true);
+    tour.exchangeTwoEdges(vA, vC, true);
+    ASSERT_LE(tour.numSegments(), 2*((numV+2)/3) + 3);
+    for (size_t v = 0; v < numV; ++v)
+    {
+      ASSERT_EQ(tour.next(v), tourRef.next(v)) << "iter = " << iter;
+      ASSERT_EQ(tour.prev(v), tourRef.prev(v)) << "iter = " << iter;
+    }
+
+    // between vs. the positions (relative to vA) along the reference tour
+    for (size_t k = 0, v = vA; k < numV; ++k, v = tourRef.next(v))
+      posRef[v] = k;
+    const size_t vB = pickVertex(rng);
+    for (size_t v = 0; v < numV; v += 7)
+    {
+      EXPECT_EQ(tour.between(vA, v, vB), posRef[v] <= posRef[vB])
+        << "A, v, B = " << vA << ", " << v << ", " << vB;
+    }
+  }
+  EXPECT_TRUE(tour.isHamiltonian());
+}
+
+TEST(TwoLevelListTour, nonStrictKeepsTheSameCycle)
+{
+  const size_t numV = 100;
+  xtsp::utils::Rng_T rng(6);
+  std::vector<size_t> perm;
+  xtsp::utils::genPermutation(rng, numV, perm);
+  xtsp::AdjTabTour tourRef(perm);
+  xtsp::TwoLevelListTour tour(perm, -1, true, 4);
+  std::uniform_int_distribution<size_t> pickVertex(0, numV-1);
+  for (size_t iter = 0; iter < 500; ++iter)
+  {
+    const size_t vA = pickVertex(rng);
+    const size_t vC = pickVertex(rng);
+    if (vA == vC || tour.next(vA) == vC || tour.next(vC) == vA)
+      continue;
+    // the flip that removes the same two edges from the reference
+    const size_t vB = tour.next(vA), vD = tour.next(vC);
+    if (tourRef.next(vA) == vB)
+      tourRef.exchangeTwoEdges(vA, vC);
+    else
+      tourRef.exchangeTwoEdges(vB, vD);
+    tour.exchangeTwoEdges(vA, vC, false);
+    for (size_t v = 0; v < numV; ++v)
+    {
+      ASSERT_TRUE(
+        (tour.next(v) == tourRef.next(v) && tour.prev(v) == tourRef.prev(v)) ||
+        (tour.next(v) == tourRef.prev(v) && tour.prev(v) == tourRef.next(v)))
+        << "iter = " << iter << ", v = " << v;
+    }
+  }
+  EXPECT_EQ(tour.getDepotId(), perm[0]);
+
+  expect_throw_thisMsg<std::invalid_argument>(
+    [&]() { tour.exchangeTwoEdges(tour.prev(perm[0]), perm[0]); },
+    "TwoLevelListTour::exchangeTwoEdges: "
+    "C must be at least two steps away from A and vice versa");
+}
+
+// the rank cache is only updated for the reversed ranks
+TEST(PermTour, rankCacheAfterFlips)
+{
+  const size_t numV = 50;
+  xtsp::utils::Rng_T rng(8);
+  std::vector<size_t> perm;
+  xtsp::utils::genPermutation(rng, numV, perm);
+  xtsp::PermTour tour(perm);
+  std::uniform_int_distribution<size_t> pickVertex(0, numV-1);
+  for (size_t iter = 0; iter < 300; ++iter)
+  {
+    const size_t vA = pickVertex(rng);
+    const size_t vC = pickVertex(rng);
+    if (vA == vC || tour.next(vA) == vC || tour.next(vC) == vA)
+      continue;
+    tour.exchangeTwoEdges(vA, vC, iter%2 == 0);
+    for (size_t rank = 0; rank < numV; ++rank)
+      ASSERT_EQ(tour.getRank_(tour.getVertex_(rank)), rank) << "iter = " << iter;
+  }
+}
+
+// the O(1) queries should agree with walking the tour
+TEST(hamiltonianTour, betweenAndStepsAhead)
+{
+  const size_t numV = 40;
+  xtsp::utils::Rng_T rng(9);
+  std::vector<size_t> perm;
+  xtsp::utils::genPermutation(rng, numV, perm);
+  std::uniform_int_distribution<size_t> pickVertex(0, numV-1);
+  auto testToursWithDTypeName = addAllTourDtypeIntoTestRunner(perm);
+  for (auto& [tour, tourDTypeName] : testToursWithDTypeName)
+  {
+    for (size_t iter = 0; iter < 50; ++iter)
+    {
+      const size_t vA = pickVertex(rng);
+      const size_t vC = pickVertex(rng);
+      if (vA != vC && tour->next(vA) != vC && tour->next(vC) != vA)
+        tour->exchangeTwoEdges(vA, vC, iter%2 == 0);
+      const size_t vB = pickVertex(rng);
+      for (size_t v = 0; v < numV; ++v)
+      {
+        EXPECT_EQ(tour->between(vA, v, vB), tour->AbstractTour::between(vA, v, vB))
+          << tourDTypeName << ", iter = " << iter;
+        EXPECT_EQ(tour->evalNumStepsAhead(vA, v), tour->AbstractTour::evalNumStepsAhead(vA, v))
+          << tourDTypeName << ", iter = " << iter;
+      }
+    }
+  }
+}
+
+// the adjacency table stores vertex IDs (not addresses), so a copy is independent
+TEST(hamiltonianAdjTabTour, copyIsIndependent)
+{
+  xtsp::AdjTabTour tour({0, 1, 2, 3, 4, 5});
+  xtsp::AdjTabTour tourCopy = tour;
+  tourCopy.exchangeTwoEdges(0, 3);
+  EXPECT_EQ(tour.print(), "0-1-2-3-4-5-");
+  EXPECT_EQ(tourCopy.print(), "0-3-2-1-4-5-");
+}
+
+// the index type only changes the storage, not the behavior
+TEST(PermTour, wideIndexTypeSameAsDefault)
+{
+  const size_t numV = 40;
+  xtsp::utils::Rng_T rng(11);
+  std::vector<size_t> perm;
+  xtsp::utils::genPermutation(rng, numV, perm);
+  xtsp::PermTour tour(perm);
+  xtsp::BasicPermTour<size_t> tourWide(perm);
+  std::uniform_int_distribution<size_t> pickVertex(0, numV-1);
+  for (size_t iter = 0; iter < 200; ++iter)
+  {
+    const size_t vA = pickVertex(rng);
+    const size_t vC = pickVertex(rng);
+    if (vA == vC || tour.next(vA) == vC || tour.next(vC) == vA)
+      continue;
+    tour.exchangeTwoEdges(vA, vC, iter%2 == 0);
+    tourWide.exchangeTwoEdges(vA, vC, iter%2 == 0);
+    ASSERT_EQ(tour.getSequence(), tourWide.getSequence()) << "iter = " << iter;
+  }
+}
+
+TEST(hamiltonianTour, rollbackToCheckpoints)
+{
+  spdlog::set_level(spdlog::level::warn);
+  const size_t numV = 60;
+  xtsp::utils::Rng_T rng(13);
+  std::vector<size_t> perm;
+  xtsp::utils::genPermutation(rng, numV, perm);
+  std::uniform_int_distribution<size_t> pickVertex(0, numV-1);
+
+  auto snapshot = [numV](const xtsp::AbstractTour& tour)
+  {
+    std::vector<size_t> nexts(numV);
+    for (size_t v = 0; v < numV; ++v)
+      nexts[v] = tour.next(v);
+    return nexts;
+  };
+  auto randomFlips = [&](xtsp::AbstractTour& tour, size_t numFlips)
+  {
+    for (size_t k = 0; k < numFlips; )
+    {
+      const size_t vA = pickVertex(rng);
+      const size_t vC = pickVertex(rng);
+      if (vA == vC || tour.next(vA) == vC || tour.next(vC) == vA)
+        continue;
+      tour.exchangeTwoEdges(vA, vC, k%3 == 0);
+      ++k;
+    }
+  };
+
+  for (auto& [tour, tourTypeName] : addAllTourDtypeIntoTestRunner(perm))
+  {
+    randomFlips(*tour, 10); // not recorded
+    EXPECT_EQ(tour->journalSize(), 0) << tourTypeName;
+
+    const auto nextsOuter = snapshot(*tour);
+    const size_t cpOuter = tour->checkpoint();
+    randomFlips(*tour, 15);
+    const auto nextsInner = snapshot(*tour);
+    const size_t cpInner = tour->checkpoint();
+    randomFlips(*tour, 20);
+    EXPECT_EQ(tour->journalSize(), 35) << tourTypeName;
+
+    tour->rollback(cpInner);
+    EXPECT_EQ(snapshot(*tour), nextsInner) << tourTypeName;
+    EXPECT_EQ(tour->journalSize(), 15) << tourTypeName;
+    // the checkpoint remains valid
+    randomFlips(*tour, 5);
+    tour->rollback(cpInner);
+    EXPECT_EQ(snapshot(*tour), nextsInner) << tourTypeName;
+
+    tour->rollback(cpOuter);
+    EXPECT_EQ(snapshot(*tour), nextsOuter) << tourTypeName;
+    EXPECT_TRUE(tour->isHamiltonian()) << tourTypeName;
+
+    tour->clearJournal();
+    randomFlips(*tour, 3);
+    EXPECT_EQ(tour->journalSize(), 0) << tourTypeName;
+  }
+}
+
+// the expected sequence (starting from vO) after moving S1..S2 after P
+static std::vector<size_t> naiveMoveSegment(
+  const xtsp::AbstractTour& tour, size_t vS1, size_t vS2, size_t vP, bool reversed)
+{
+  std::vector<size_t> seg, rest;
+  for (size_t v = vS1; ; v = tour.next(v))
+  {
+    seg.push_back(v);
+    if (v == vS2)
+      break;
+  }
+  for (size_t v = tour.next(vS2); v != vS1; v = tour.next(v))
+    rest.push_back(v);
+  if (reversed)
+    std::reverse(seg.begin(), seg.end());
+  auto posP = std::find(rest.begin(), rest.end(), vP);
+  rest.insert(posP + 1, seg.cbegin(), seg.cend());
+  // start from O, i.e., the last one of rest before the move
+  std::rotate(rest.begin(), std::find(rest.begin(), rest.end(), tour.prev(vS1)), rest.end());
+  return rest;
+}
+
+TEST(hamiltonianTour, moveSegmentSameAsNaive)
+{
+  spdlog::set_level(spdlog::level::warn);
+  const size_t numV = 40;
+  xtsp::utils::Rng_T rng(21);
+  std::vector<size_t> perm;
+  xtsp::utils::genPermutation(rng, numV, perm);
+  std::uniform_int_distribution<size_t> pickVertex(0, numV-1);
+  std::uniform_int_distribution<size_t> pickLen(1, 5);
+
+  for (auto& [tour, tourTypeName] : addAllTourDtypeIntoTestRunner(perm))
+  {
+    const size_t cp = tour->checkpoint();
+    for (size_t iter = 0; iter < 300; ++iter)
+    {
+      const size_t vS1 = pickVertex(rng);
+      size_t vS2 = vS1;
+      for (size_t len = pickLen(rng); len > 1; --len)
+        vS2 = tour->next(vS2);
+      // P anywhere outside the segment (including O and prev(O))
+      size_t vP = tour->prev(vS1);
+      for (size_t steps = pickVertex(rng)%(numV - 5); steps > 0; --steps)
+        vP = tour->prev(vP);
+      const bool reversed = (iter%2 == 1);
+      const auto expected = naiveMoveSegment(*tour, vS1, vS2, vP, reversed);
+
+      const size_t vO = tour->prev(vS1);
+      tour->moveSegment(vS1, vS2, vP, reversed);
+      std::vector<size_t> actual;
+      for (size_t k = 0, v = vO; k < numV; ++k, v = tour->next(v))
+        actual.push_back(v);
+      ASSERT_EQ(actual, expected) << tourTypeName << ", iter = " << iter;
+      for (size_t v = 0; v < numV; ++v)
+        ASSERT_EQ(tour->prev(tour->next(v)), v) << tourTypeName << ", iter = " << iter;
+      ASSERT_TRUE(tour->between(vO, tour->next(vO), tour->prev(vO))) << tourTypeName;
+    }
+    // P on the segment
+    const size_t vS1 = tour->getDepotId();
+    const size_t vP = tour->next(tour->next(vS1));
+    EXPECT_THROW(tour->moveSegment(vS1, tour->next(vP), vP), std::invalid_argument)
+      << tourTypeName;
+
+    // all undone
+    tour->rollback(cp);
+    for (size_t rank = 0; rank < numV; ++rank)
+      ASSERT_EQ(tour->next(perm[rank]), perm[(rank+1)%numV]) << tourTypeName;
+  }
+}
@@ -0,0 +1,80 @@
+#include "xtsp/initialization/nearest_neighbor.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+
+#include <spdlog/spdlog.h>
+
+static const auto dataDir = std::filesystem::path(
+  __FILE__).parent_path().parent_path()/"dataset";
+
+// the candidate lookup + fallback should reproduce 
+// the textbook O(N^2) nearest-neighbor tour
+TEST(NearestNeighborTour, pr144SameAsBruteForce)
+{
+  spdlog::set_level(spdlog::level::warn);
+  auto g = xtsp::ImplicitCompleteGraph<float>::loadFromTsplibFile(dataDir/"pr144.tsp");
+  auto gExplicit = g.explicitize(1);
+  const size_t numV = g.numVertices();
+
+  for (const size_t K : {1, 5, 16})
+  {
+    auto candidates = xtsp::CandidateSet<int>::fromGraph(gExplicit, K);
+    for (const size_t vFirstPick : {0, 77})
+    {
+      auto tour = xtsp::algo::nearestNeighborTour(gExplicit, candidates, vFirstPick);
+      ASSERT_TRUE(tour.isHamiltonian());
+      ASSERT_EQ(tour.getDepotId(), vFirstPick);
+
+      std::vector<bool> visited(numV, false);
+      size_t vCurr = vFirstPick;
+      visited[vCurr] = true;
+      for (size_t step = 1; step < numV; ++step)
+      {
+        size_t vBest = numV;
+        for (size_t vX = 0; vX < numV; ++vX)
+          if (!visited[vX] && (vBest == numV 
+              || gExplicit.getEdgeCost(vCurr, vX) < gExplicit.getEdgeCost(vCurr, vBest)))
+            vBest = vX;
+        ASSERT_EQ(tour.next(vCurr), vBest) << "K = " << K << ", step " << step;
+        visited[vBest] = true;
+        vCurr = vBest;
+      }
+    }
+  }
+
+  auto candidates = xtsp::CandidateSet<float>::fromGraph(g, 8);
+  auto tour = xtsp::algo::nearestNeighborTour(g, candidates);
+  EXPECT_TRUE(tour.isHamiltonian());
+  EXPECT_THROW(xtsp::algo::nearestNeighborTour(g, candidates, numV), std::invalid_argument);
+}
+
+// the fallback via the K-d tree (K = 1 falls back often)
+TEST(NearestNeighborTour, pr144KdTreeFallback)
+{
+  spdlog::set_level(spdlog::level::warn);
+  auto g = xtsp::ImplicitCompleteGraph<float>::loadFromTsplibFile(dataDir/"pr144.tsp");
+  const size_t numV = g.numVertices();
+  auto candidates = xtsp::CandidateSet<float>::fromGraph(g, 1);
+  auto tour = xtsp::algo::nearestNeighborTour(g, candidates, 5);
+  ASSERT_TRUE(tour.isHamiltonian());
+
+  // the same cost as the nearest unvisited vertex (the ties may differ)
+  std::vector<bool> visited(numV, false);
+  size_t vCurr = 5;
+  visited[vCurr] = true;
+  for (size_t step = 1; step < numV; ++step)
+  {
+    float minCost = std::numeric_limits<float>::max();
+    for (size_t vX = 0; vX < numV; ++vX)
+      if (!visited[vX])
+        minCost = std::min(minCost, g.getEdgeCost(vCurr, vX));
+    const size_t vNext = tour.next(vCurr);
+    ASSERT_FALSE(visited[vNext]) << "step " << step;
+    ASSERT_FLOAT_EQ(g.getEdgeCost(vCurr, vNext), minCost) << "step " << step;
+    visited[vNext] = true;
+    vCurr = vNext;
+  }
+}
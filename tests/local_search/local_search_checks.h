@@ -0,0 +1,94 @@
+#pragma once
+
+#include "xtsp/core/complete_graph.h"
+#include "xtsp/core/tour.h"
+#include "xtsp/core/utils.h"
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+// The steps shared by the local search tests, so that each test only
+// adds the assertions specific to its solver.
+// (The failures point here, hence the label in every message.)
+
+/// @brief a TSPLIB instance of tests/dataset, with integral costs
+inline xtsp::CompleteGraph<int> loadIntGraph(const std::string &instance)
+{
+  static const auto dataDir = std::filesystem::path(
+    __FILE__).parent_path().parent_path()/"dataset";
+  spdlog::set_level(spdlog::level::warn);
+  return xtsp::ImplicitCompleteGraph<float>::loadFromTsplibFile(dataDir/instance).explicitize(1);
+}
+
+/// @brief the random initial tour (a fixed seed per test)
+inline std::vector<size_t> randomPermutation(size_t numVertices, unsigned seed = 123)
+{
+  std::vector<size_t> perm;
+  xtsp::utils::genPermutation(xtsp::utils::Rng_T(seed), numVertices, perm);
+  return perm;
+}
+
+/// @brief run \p solve on \p tour , which shall reach a confirmed local optimum
+///        with some moves, and an improvement matching the tour cost
+/// @retval the outcome of \p solve
+template <typename CostTy, typename SolveFn>
+auto checkLocalSearchRun(
+  const std::string &label, xtsp::AbstractTour &tour,
+  const xtsp::AbstractCompGraph<CostTy> &g, SolveFn solve)
+{
+  const auto oldTourCost = xtsp::evalTour(tour, g);
+  const auto res = solve();
+  EXPECT_TRUE(tour.isHamiltonian()) << label;
+  EXPECT_TRUE(res.confirmedLocalOptimum()) << label;
+  EXPECT_GT(res.numMoves(), 0) << label;
+  EXPECT_EQ(oldTourCost - res.improvement(), xtsp::evalTour(tour, g)) << label;
+  SPDLOG_INFO("{}: {} -> {} using {:d} moves",
+    label, oldTourCost, xtsp::evalTour(tour, g), res.numMoves());
+  return res;
+}
+
+/// @brief \p query (v) finds no valid move for any vertex v
+template <typename QueryFn>
+void expectNoMoveLeft(const std::string &label, size_t numVertices, QueryFn query)
+{
+  for (size_t v = 0; v < numVertices; ++v)
+    EXPECT_FALSE(query(v).isValid()) << label << ", v = " << v;
+}
+
+/// @brief apply a (valid) query result alone, which shall keep the tour
+///        Hamiltonian and improve it by exactly its gain
+/// @retval is the tour still Hamiltonian?
+template <typename CostTy, typename TourTy, typename MoveTy, typename ApplyFn>
+bool checkMoveImprovesByItsGain(
+  const std::string &label, TourTy &tour, const xtsp::AbstractCompGraph<CostTy> &g,
+  const MoveTy &move, ApplyFn apply)
+{
+  const auto oldTourCost = xtsp::evalTour(tour, g);
+  apply(tour, move);
+  if (!tour.isHamiltonian())
+  {
+    ADD_FAILURE() << label << ": the tour is broken";
+    return false;
+  }
+  EXPECT_EQ(oldTourCost - move.improvement, xtsp::evalTour(tour, g)) << label;
+  return true;
+}
+
+/// @brief run \p runBefore and then \p runAfter on the same tour,
+///        where the latter shall find what the former misses
+/// @retval the outcome of \p runAfter
+template <typename CostTy, typename BeforeFn, typename AfterFn>
+auto checkImprovesOnTopOf(
+  const std::string &label, xtsp::AbstractTour &tour,
+  const xtsp::AbstractCompGraph<CostTy> &g, BeforeFn runBefore, AfterFn runAfter)
+{
+  runBefore();
+  const auto costBefore = xtsp::evalTour(tour, g);
+  const auto res = runAfter();
+  EXPECT_GT(res.improvement(), 0) << label;
+  EXPECT_EQ(costBefore - res.improvement(), xtsp::evalTour(tour, g)) << label;
+  return res;
+}
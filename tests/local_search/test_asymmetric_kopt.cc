@@ -0,0 +1,154 @@
+#include "xtsp/local_search/asymmetric_kopt.h"
+#include "xtsp/core/complete_graph.h"
+#include "xtsp/core/tour_alternatives.h"
+#include "xtsp/core/utils.h"
+#include "local_search_checks.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <spdlog/spdlog.h>
+
+// random points in the plane, plus some random noise in each direction
+template <typename CostTy>
+static xtsp::CompleteGraph<CostTy> genAsymmetricGraph(size_t numVertices, unsigned seed)
+{
+  xtsp::utils::Rng_T rng(seed);
+  std::uniform_real_distribution<double> coord(0, 1000), noise(0, 200);
+  std::vector<std::pair<double, double>> pts(numVertices);
+  for (auto& [x, y] : pts)
+  {
+    x = coord(rng);
+    y = coord(rng);
+  }
+  Eigen::Matrix<CostTy, -1, -1> costs(numVertices, numVertices);
+  for (size_t i = 0; i < numVertices; ++i)
+    for (size_t j = 0; j < numVertices; ++j)
+    {
+      const double dist = std::hypot(
+        pts[i].first - pts[j].first, pts[i].second - pts[j].second);
+      costs(i, j) = (i == j) ? 0 : static_cast<CostTy>(std::round(dist + noise(rng)));
+    }
+  return xtsp::CompleteGraph<CostTy>(false, costs);
+}
+
+template <typename TourTy>
+static void runAsymmetricTwoOpt(size_t maxSegmentLength, bool firstImprovement)
+{
+  spdlog::set_level(spdlog::level::warn);
+  const auto g = genAsymmetricGraph<int>(200, 7);
+  TourTy tour(randomPermutation(g.numVertices()));
+  xtsp::algo::AsymmetricTwoOptFinder<int> solver(g, 10, maxSegmentLength);
+  checkLocalSearchRun(fmt::format("asymmetric 2-opt/Or-opt (L = {:d})", maxSegmentLength),
+    tour, g, [&] { return solver.solve(tour, g, firstImprovement); });
+
+  // nothing is left to find
+  auto resAgain = solver.solve(tour, g, firstImprovement);
+  EXPECT_EQ(resAgain.numMoves(), 0);
+  EXPECT_EQ(resAgain.improvement(), 0);
+}
+
+TEST(AsymmetricTwoOpt, permTourFirstImprov)
+{
+  runAsymmetricTwoOpt<xtsp::PermTour>(3, true);
+}
+
+TEST(AsymmetricTwoOpt, permTourBestImprov)
+{
+  runAsymmetricTwoOpt<xtsp::PermTour>(3, false);
+}
+
+TEST(AsymmetricTwoOpt, adjTabTourTwoOptOnly)
+{
+  runAsymmetricTwoOpt<xtsp::AdjTabTour>(0, true);
+}
+
+TEST(AsymmetricTwoOpt, orOptImprovesATwoOptTour)
+{
+  spdlog::set_level(spdlog::level::warn);
+  const auto g = genAsymmetricGraph<int>(200, 11);
+  xtsp::PermTour tour(randomPermutation(g.numVertices(), 5));
+  xtsp::algo::AsymmetricTwoOptFinder<int> twoOpt(g, 10, 0);
+  xtsp::algo::AsymmetricTwoOptFinder<int> orOpt(twoOpt.getCandidates(), 3);
+  checkImprovesOnTopOf("asymmetric Or-opt after 2-opt", tour, g,
+    [&] { return twoOpt.solve(tour, g); },
+    [&] { return orOpt.solve(tour, g); });
+}
+
+TEST(AsymmetricTwoOpt, floatCosts)
+{
+  spdlog::set_level(spdlog::level::warn);
+  const auto g = genAsymmetricGraph<float>(150, 3);
+  std::vector<size_t> initPerm;
+  xtsp::utils::genPermutation(xtsp::utils::Rng_T(42), g.numVertices(), initPerm);
+  xtsp::PermTour tour(initPerm);
+  auto oldTourCost = xtsp::evalTour(tour, g);
+
+  xtsp::algo::AsymmetricTwoOptFinder<float> solver(g, 8, 3);
+  auto res = solver.solve(tour, g);
+  EXPECT_TRUE(tour.isHamiltonian());
+  EXPECT_TRUE(res.confirmedLocalOptimum());
+  EXPECT_GT(res.numMoves(), 0);
+  EXPECT_NEAR(oldTourCost - res.improvement(), xtsp::evalTour(tour, g), 1e-4 * oldTourCost);
+}
+
+TEST(AsymmetricTwoOpt, tooSmallGraph)
+{
+  const auto g = genAsymmetricGraph<int>(4, 1);
+  EXPECT_THROW(xtsp::algo::AsymmetricTwoOptFinder<int> solver(g), std::invalid_argument);
+}
+
+template <typename TourTy>
+static void runOrThreeOpt(bool firstImprovement)
+{
+  spdlog::set_level(spdlog::level::warn);
+  const auto g = genAsymmetricGraph<int>(200, 7);
+  TourTy tour(randomPermutation(g.numVertices()));
+  xtsp::algo::OrThreeOptFinder<int> solver(g, 10);
+  checkLocalSearchRun("or-3opt", tour, g, [&] {
+    return solver.solve(tour, g, firstImprovement);
+  });
+  expectNoMoveLeft("or-3opt", g.numVertices(), [&](size_t v) {
+    return solver.queryMoveGivenA(tour, v, g, false);
+  });
+}
+
+TEST(OrThreeOpt, permTourFirstImprov)
+{
+  runOrThreeOpt<xtsp::PermTour>(true);
+}
+
+TEST(OrThreeOpt, adjTabTourBestImprov)
+{
+  runOrThreeOpt<xtsp::AdjTabTour>(false);
+}
+
+TEST(OrThreeOpt, eachMoveImprovesByItsGain)
+{
+  const auto g = genAsymmetricGraph<int>(60, 2);
+  xtsp::PermTour tour(randomPermutation(g.numVertices(), 9));
+  xtsp::algo::OrThreeOptFinder<int> solver(g, 59);
+  size_t numMoves = 0;
+  for (size_t v = 0; v < g.numVertices(); ++v)
+  {
+    const auto res = solver.queryMoveGivenA(tour, v, g, false);
+    if (!res.isValid())
+      continue;
+    ASSERT_TRUE(checkMoveImprovesByItsGain(fmt::format("or-3opt, a = {:d}", v),
+      tour, g, res, xtsp::algo::OrThreeOptFinder<int>::applyMove));
+    ++numMoves;
+  }
+  EXPECT_GT(numMoves, 0);
+}
+
+TEST(OrThreeOpt, improvesAnAsymmetricTwoOptTour)
+{
+  spdlog::set_level(spdlog::level::warn);
+  const auto g = genAsymmetricGraph<int>(200, 11);
+  xtsp::PermTour tour(randomPermutation(g.numVertices(), 5));
+  xtsp::algo::AsymmetricTwoOptFinder<int> twoOpt(g, 10, 3);
+  xtsp::algo::OrThreeOptFinder<int> orThreeOpt(twoOpt.getCandidates());
+  checkImprovesOnTopOf("or-3opt after asymmetric 2-opt/Or-opt", tour, g,
+    [&] { return twoOpt.solve(tour, g); },
+    [&] { return orThreeOpt.solve(tour, g); });
+}
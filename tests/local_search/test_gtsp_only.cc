@@ -1,6 +1,7 @@
 #include "xtsp/local_search/gtsp_only.h"
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <iostream>
 #include <spdlog/spdlog.h>
 
@@ -158,4 +159,78 @@ TEST_F(ClusterOptimizerToyExample, tryAllClustersAsCut)
   }
 }
 
+TEST_F(ClusterOptimizerToyExample, narrowCostType)
+{
+  spdlog::set_level(spdlog::level::warn);
+  auto cutCluster = m_clustering->evalWhichHasTheLeastVertices();
+  const float upscale = 100;
+  auto gNarrow = m_graph->explicitizeAs<uint16_t>(upscale);
+
+  std::vector<size_t> computedOptVertices;
+  xtsp::algo::GtspClusterOptimizer<uint16_t> solver(m_clustering->numVertices());
+  int64_t computedOptCost = solver.solve(*m_tour, gNarrow, cutCluster, computedOptVertices);
+  EXPECT_EQ(computedOptCost, nint(m_trueOptCost*upscale));
+  for (size_t rank = 0; rank < m_clustering->numClusters(); ++rank)
+  {
+    EXPECT_EQ(computedOptVertices[rank], m_trueOptGenTour[rank]) 
+      << "at tour rank = " << rank;
+  }
+}
+
+TEST_F(ClusterOptimizerToyExample, stopCriterion)
+{
+  spdlog::set_level(spdlog::level::warn);
+  const size_t cutCluster = 0; // 9 vertices, i.e., 9 DPs
+  xtsp::algo::GtspClusterOptimizer<float> solver(m_clustering->numVertices());
+  auto evalSeq = [&](const std::vector<size_t>& seq) {
+    return xtsp::evalTour(xtsp::PermTour(seq, m_clustering->numVertices()), *m_graph);
+  };
+
+  // the progress is reported whenever a DP finds a better tour
+  std::vector<float> reportedCosts;
+  xtsp::algo::StopCriterion<float> reporting;
+  reporting.setProgressCallback([&](const xtsp::AbstractTour& bestSoFar, float cost) {
+    EXPECT_FLOAT_EQ(xtsp::evalTour(bestSoFar, *m_graph), cost);
+    reportedCosts.push_back(cost);
+  });
+  std::vector<size_t> computedOptVertices;
+  float computedOptCost = solver.solve(
+    *m_tour, *m_graph, cutCluster, computedOptVertices, &reporting);
+  EXPECT_FLOAT_EQ(computedOptCost, m_trueOptCost);
+  EXPECT_FALSE(reporting.stopped());
+  ASSERT_FALSE(reportedCosts.empty());
+  EXPECT_TRUE(std::is_sorted(reportedCosts.crbegin(), reportedCosts.crend()));
+  EXPECT_FLOAT_EQ(reportedCosts.back(), m_trueOptCost);
+
+  // past the deadline, only the first DP finishes: the one for the tour's own
+  // vertex of cutCluster, which is never worse than the tour.
+  // (From the optimal tour, the DP of any other vertex would be worse.)
+  auto optTour = xtsp::GeneralizedTour::fromPermutation(m_trueOptGenTour, m_clustering);
+  for (xtsp::GeneralizedTour* tour : {m_tour.get(), &optTour})
+  {
+    const float inputCost = xtsp::evalTour(*tour->getTour(), *m_graph);
+    xtsp::algo::StopCriterion<float> expired;
+    expired.setDeadline(xtsp::algo::StopCriterion<float>::Clock::now());
+    std::vector<size_t> partialVertices;
+    float partialCost = solver.solve(
+      *tour, *m_graph, cutCluster, partialVertices, &expired);
+    EXPECT_EQ(expired.stopReason(), xtsp::algo::kDeadlineReached);
+    ASSERT_EQ(partialVertices.size(), m_clustering->numClusters());
+    EXPECT_EQ(partialVertices[tour->findClusterRankById(cutCluster)],
+      tour->getVertexByClusterId(cutCluster));
+    EXPECT_FLOAT_EQ(partialCost, evalSeq(partialVertices));
+    EXPECT_FLOAT_EQ(expired.cost(), partialCost);
+    EXPECT_LE(partialCost, inputCost);
+    EXPECT_GE(partialCost, m_trueOptCost);
+
+    // and improve() writes it back
+    xtsp::algo::StopCriterion<float> expiredAgain;
+    expiredAgain.setDeadline(xtsp::algo::StopCriterion<float>::Clock::now());
+    auto tourCopy = xtsp::GeneralizedTour::fromPermutation(
+      tour->getTour()->getSequence(), m_clustering);
+    EXPECT_FLOAT_EQ(solver.improve(tourCopy, *m_graph, cutCluster, &expiredAgain), partialCost);
+    EXPECT_LE(xtsp::evalTour(*tourCopy.getTour(), *m_graph), inputCost);
+  }
+}
+
 /// @todo test scalability
\ No newline at end of file
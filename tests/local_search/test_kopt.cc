@@ -1,9 +1,14 @@
 #include "xtsp/local_search/kopt.h"
 #include "xtsp/core/tour_alternatives.h"
+#include "xtsp/core/two_level_list_tour.h"
+#include "xtsp/core/point_graph.h"
 #include "xtsp/local_search/gtsp_only.h"
+#include "xtsp/core/utils.h"
+#include "local_search_checks.h"
 
 #include <gtest/gtest.h>
 #include <iostream>
+#include <filesystem>
 #include <spdlog/spdlog.h>
 
 class TwoOptHamTour : public testing::Test
@@ -107,3 +112,366 @@ TEST_F(TwoOptHamTour, solveBestImprovMax10Sweeps)
   std::cout << std::endl;
 }
 /// @todo test partial Hamiltonian tour
+
+TEST_F(TwoOptHamTour, neighborListFullLists)
+{
+  spdlog::set_level(spdlog::level::debug);
+  auto oldTourCost = xtsp::evalTour(m_tour, m_graph);
+
+  // with K = N-1, it should be as good as the usual 2-opt
+  xtsp::algo::NeighborListTwoOptFinder<float> solver(m_graph, 8);
+  ASSERT_EQ(solver.numNeighbors(), 8);
+  auto res = solver.solve(m_tour, m_graph, true);
+  EXPECT_TRUE(res.confirmedTwoOpt());
+  EXPECT_TRUE(res.improvement() > 0);
+  EXPECT_TRUE(m_tour.isHamiltonian());
+  EXPECT_FLOAT_EQ(oldTourCost - res.improvement(), xtsp::evalTour(m_tour, m_graph));
+  for (size_t vA = 0; vA < m_graph.numVertices(); ++vA)
+    EXPECT_FALSE(xtsp::algo::find2OptMoveGivenA(m_tour, vA, m_graph, false).isValid())
+      << "vA = " << vA;
+}
+
+TEST_F(TwoOptHamTour, neighborListSortedAscending)
+{
+  xtsp::algo::NeighborListTwoOptFinder<float> solver(m_graph, 3);
+  ASSERT_EQ(solver.numNeighbors(), 3);
+  for (size_t v = 0; v < m_graph.numVertices(); ++v)
+  {
+    auto neighbors = solver.getCandidates().getCandidates(v);
+    ASSERT_EQ(neighbors.size(), 3);
+    for (size_t k = 0; k < neighbors.size(); ++k)
+    {
+      EXPECT_NE(neighbors[k].vertex, v);
+      EXPECT_EQ(neighbors[k].cost, m_graph.getEdgeCost(v, neighbors[k].vertex));
+      if (k > 0)
+      {
+        EXPECT_LE(neighbors[k-1].cost, neighbors[k].cost);
+      }
+    }
+  }
+}
+
+template <typename TourTy>
+static void runNeighborListTwoOptPr144(bool firstImprovement)
+{
+  const auto g = loadIntGraph("pr144.tsp");
+  TourTy tour(randomPermutation(g.numVertices()));
+  xtsp::algo::NeighborListTwoOptFinder<int> solver(g, 10);
+  checkLocalSearchRun("neighbor-list 2-opt on pr144", tour, g, [&] {
+    return solver.solve(tour, g, firstImprovement);
+  });
+  expectNoMoveLeft("neighbor-list 2-opt", g.numVertices(), [&](size_t vA) {
+    return solver.queryMoveGivenA(tour, vA, g, false);
+  });
+}
+
+TEST(NeighborListTwoOpt, pr144PermTourFirstImprov)
+{
+  runNeighborListTwoOptPr144<xtsp::PermTour>(true);
+}
+
+TEST(NeighborListTwoOpt, pr144AdjTabTourBestImprov)
+{
+  runNeighborListTwoOptPr144<xtsp::AdjTabTour>(false);
+}
+
+// narrower storage, same arithmetic
+TEST(NeighborListTwoOpt, pr144Uint16SameAsInt)
+{
+  static const auto dataDir = std::filesystem::path(
+    __FILE__).parent_path().parent_path()/"dataset";
+  spdlog::set_level(spdlog::level::warn);
+  auto g = xtsp::ImplicitCompleteGraph<float>::loadFromTsplibFile(dataDir/"pr144.tsp");
+  auto gInt = g.explicitize(1);
+  auto gNarrow = g.explicitizeNarrowest(1);
+  ASSERT_TRUE(std::holds_alternative<xtsp::CompleteGraph<uint16_t>>(gNarrow));
+  const auto& gU16 = std::get<xtsp::CompleteGraph<uint16_t>>(gNarrow);
+
+  std::vector<size_t> initPerm;
+  xtsp::utils::genPermutation(xtsp::utils::Rng_T(123), g.numVertices(), initPerm);
+  xtsp::PermTour tourInt(initPerm);
+  xtsp::PermTour tourU16(initPerm);
+  ASSERT_EQ(xtsp::evalTour(tourInt, gInt), xtsp::evalTour(tourU16, gU16));
+
+  auto resInt = xtsp::algo::NeighborListTwoOptFinder<int>(gInt, 10).solve(tourInt, gInt);
+  auto resU16 = xtsp::algo::NeighborListTwoOptFinder<uint16_t>(gU16, 10).solve(tourU16, gU16);
+  EXPECT_EQ(resInt.improvement(), resU16.improvement());
+  EXPECT_EQ(resInt.numMoves(), resU16.numMoves());
+  EXPECT_EQ(xtsp::evalTour(tourInt, gInt), xtsp::evalTour(tourU16, gU16));
+
+  xtsp::algo::PriorityTwoOptFinder<uint16_t> solver(tourU16, gU16);
+  auto res = solver.solve(tourU16, gU16, 100);
+  EXPECT_TRUE(res.confirmedTwoOpt());
+  EXPECT_GE(res.improvement(), 0);
+}
+
+// the later sweeps only process the changed edges, 
+// but a move-free sweep must still confirm 2-opt
+TEST(PriorityTwoOpt, pr144SweepByHandConfirmsTwoOpt)
+{
+  static const auto dataDir = std::filesystem::path(
+    __FILE__).parent_path().parent_path()/"dataset";
+  spdlog::set_level(spdlog::level::warn);
+  auto g = xtsp::ImplicitCompleteGraph<float>::loadFromTsplibFile(dataDir/"pr144.tsp");
+  auto gExplicit = g.explicitize(1);
+
+  std::vector<size_t> initPerm;
+  xtsp::utils::genPermutation(xtsp::utils::Rng_T(321), g.numVertices(), initPerm);
+  xtsp::AdjTabTour tour(initPerm);
+  const auto oldTourCost = xtsp::evalTour(tour, gExplicit);
+
+  xtsp::algo::PriorityTwoOptFinder<int> solver(tour, gExplicit);
+  int totalImprovement = 0;
+  size_t numSweeps = 0;
+  for (; numSweeps < 1000; ++numSweeps)
+  {
+    auto res = solver.tryOneSweep2Opts(tour, gExplicit, numSweeps % 2 == 0);
+    totalImprovement += res.improvement();
+    if (res.numMoves() == 0)
+      break;
+  }
+  EXPECT_LT(numSweeps, 1000);
+  EXPECT_TRUE(tour.isHamiltonian());
+  EXPECT_EQ(oldTourCost - totalImprovement, xtsp::evalTour(tour, gExplicit));
+  for (size_t v = 0; v < g.numVertices(); ++v)
+    EXPECT_FALSE(xtsp::algo::find2OptMoveGivenA(tour, v, gExplicit, false).isValid())
+      << "v = " << v;
+
+  // a change behind the finder's back needs a reset
+  tour.exchangeTwoEdges(initPerm[0], initPerm[70]);
+  solver.reset(tour, gExplicit);
+  auto res = solver.solve(tour, gExplicit, 1000);
+  EXPECT_TRUE(res.confirmedTwoOpt());
+  for (size_t v = 0; v < g.numVertices(); ++v)
+    EXPECT_FALSE(xtsp::algo::find2OptMoveGivenA(tour, v, gExplicit, false).isValid())
+      << "v = " << v;
+}
+
+// a user-defined graph type, which the solvers can only reach via virtual calls
+class ForwardingGraph : public xtsp::AbstractCompGraph<float>
+{
+public:
+  ForwardingGraph(const xtsp::AbstractCompGraph<float>& g) : m_g(g) {}
+  bool isSymmetric() const override
+  {
+    return m_g.isSymmetric();
+  }
+  float getEdgeCost(size_t from, size_t to) const override
+  {
+    return m_g.getEdgeCost(from, to);
+  }
+  size_t numVertices() const override
+  {
+    return m_g.numVertices();
+  }
+protected:
+  const xtsp::AbstractCompGraph<float>& m_g;
+};
+
+// the specialized code paths should give exactly the same result
+// as the generic (virtual) one
+TEST(TwoOptDispatch, sameForAllGraphAndTourTypes)
+{
+  spdlog::set_level(spdlog::level::warn);
+  const size_t numPts = 150;
+  xtsp::utils::Rng_T rng(11);
+  // integer coordinates so that all the distances are bitwise identical
+  std::uniform_int_distribution<int> coord(0, 1000);
+  Eigen::MatrixXf xy(numPts, 2);
+  for (size_t i = 0; i < numPts; ++i)
+    for (int d = 0; d < 2; ++d)
+      xy(i, d) = coord(rng);
+  xtsp::ImplicitCompleteGraph<float> gImplicit(xy);
+  xtsp::PointGraph<2, xtsp::kL2Norm> gPts(xy);
+  Eigen::MatrixXf mat(numPts, numPts);
+  for (size_t i = 0; i < numPts; ++i)
+    for (size_t j = 0; j < numPts; ++j)
+      mat(i, j) = gImplicit.getEdgeCost(i, j);
+  xtsp::CompleteGraph<float> gExplicit(true, mat);
+  ForwardingGraph gGeneric(gImplicit);
+  const std::vector<const xtsp::AbstractCompGraph<float>*> graphs = {
+    &gImplicit, &gPts, &gExplicit, &gGeneric};
+
+  std::vector<size_t> initPerm;
+  xtsp::utils::genPermutation(rng, numPts, initPerm);
+  auto toPerm = [](const xtsp::AbstractTour& tour) {
+    std::vector<size_t> perm{tour.getDepotId()};
+    while (perm.size() < tour.size())
+      perm.push_back(tour.next(perm.back()));
+    return perm;
+  };
+
+  // run both solvers on a copy of the initial tour
+  auto runSolvers = [&](auto tour, const xtsp::AbstractCompGraph<float>& g) {
+    std::array<std::vector<size_t>, 2> perms;
+    auto res = xtsp::algo::PriorityTwoOptFinder<float>(tour, g).solve(tour, g, 100, false);
+    EXPECT_TRUE(res.confirmedTwoOpt());
+    perms[0] = toPerm(tour);
+    xtsp::algo::NeighborListTwoOptFinder<float> finder(gExplicit, 8);
+    finder.solve(tour, g);
+    perms[1] = toPerm(tour);
+    return perms;
+  };
+
+  const float initCost = xtsp::evalTour(xtsp::AdjTabTour(initPerm), gGeneric);
+  const auto permsRefPerm = runSolvers(xtsp::PermTour(initPerm), gGeneric);
+  const auto permsRefAdjTab = runSolvers(xtsp::AdjTabTour(initPerm), gGeneric);
+  for (const auto g : graphs)
+  {
+    // (PermTour sums the edges in a different order)
+    EXPECT_FLOAT_EQ(xtsp::evalTour(xtsp::PermTour(initPerm), *g), initCost);
+    EXPECT_EQ(xtsp::evalTour(xtsp::AdjTabTour(initPerm), *g), initCost);
+    EXPECT_EQ(runSolvers(xtsp::PermTour(initPerm), *g), permsRefPerm);
+    EXPECT_EQ(runSolvers(xtsp::AdjTabTour(initPerm), *g), permsRefAdjTab);
+  }
+}
+
+
+// the rank-order scan of PermTour (with the vectorized reduction)
+// should find the same move as a plain scan along the tour
+template <typename CostTy>
+static void checkTwoOptScanGivenA(
+  const xtsp::AbstractCompGraph<CostTy>& g, const std::vector<size_t>& perm, bool exact)
+{
+  using Accum = xtsp::AccumTy<CostTy>;
+  const xtsp::PermTour permTour(perm, g.numVertices());
+  const xtsp::AdjTabTour adjTabTour(perm, g.numVertices());
+  size_t numValid = 0;
+  for (const size_t vA : perm)
+  {
+    for (const bool firstImprovement : {true, false})
+    {
+      Accum bestImprovement = 0;
+      size_t bestC = g.numVertices();
+      const size_t vB = permTour.next(vA);
+      for (size_t vC = permTour.next(vB); permTour.next(vC) != vA; vC = permTour.next(vC))
+      {
+        const size_t vD = permTour.next(vC);
+        const Accum improvement = (Accum(g.getEdgeCost(vA, vB)) + g.getEdgeCost(vC, vD))
+          - (Accum(g.getEdgeCost(vA, vC)) + g.getEdgeCost(vB, vD));
+        if (improvement > bestImprovement)
+        {
+          bestImprovement = improvement;
+          bestC = vC;
+          if (firstImprovement)
+            break;
+        }
+      }
+      const auto resPerm = xtsp::algo::find2OptMoveGivenA(permTour, vA, g, firstImprovement);
+      const auto resAdjTab = xtsp::algo::find2OptMoveGivenA(adjTabTour, vA, g, firstImprovement);
+      ASSERT_EQ(resPerm.isValid(), resAdjTab.isValid()) << "vA = " << vA;
+      EXPECT_EQ(resPerm.improvement, resAdjTab.improvement) << "vA = " << vA;
+      if (resPerm.isValid())
+      {
+        ++numValid;
+        EXPECT_EQ(resPerm.vC, resAdjTab.vC) << "vA = " << vA;
+      }
+      if (exact)
+      {
+        EXPECT_EQ(resPerm.improvement, bestImprovement) << "vA = " << vA;
+        if (bestImprovement > 0)
+        {
+          EXPECT_EQ(resPerm.vC, bestC) << "vA = " << vA;
+        }
+      }
+      else
+      {
+        EXPECT_NEAR(resPerm.improvement, bestImprovement, 1e-2) << "vA = " << vA;
+      }
+    }
+  }
+  EXPECT_GT(numValid, 0);
+}
+
+TEST(TwoOptDispatch, permTourScanSameAsPlainScan)
+{
+  static const auto dataDir = std::filesystem::path(
+    __FILE__).parent_path().parent_path()/"dataset";
+  auto g = xtsp::ImplicitCompleteGraph<float>::loadFromTsplibFile(dataDir/"pr144.tsp");
+  auto gInt = g.explicitize(1);
+  auto gNarrow = g.explicitizeNarrowest(1);
+  ASSERT_TRUE(std::holds_alternative<xtsp::CompleteGraph<uint16_t>>(gNarrow));
+  const auto& gU16 = std::get<xtsp::CompleteGraph<uint16_t>>(gNarrow);
+
+  // a full tour and a partial one (so that the ranks wrap at another size)
+  std::vector<size_t> perm;
+  xtsp::utils::genPermutation(xtsp::utils::Rng_T(5), g.numVertices(), perm);
+  for (const size_t tourSize : {g.numVertices(), size_t(101)})
+  {
+    const std::vector<size_t> tourPerm(perm.begin(), perm.begin() + tourSize);
+    checkTwoOptScanGivenA<int>(gInt, tourPerm, true);
+    checkTwoOptScanGivenA<uint16_t>(gU16, tourPerm, true);
+    checkTwoOptScanGivenA<float>(g, tourPerm, false);
+  }
+}
+
+template <typename TourTy>
+static void runThreeOptPr144(bool firstImprovement, xtsp::algo::SweepMethod method)
+{
+  const auto g = loadIntGraph("pr144.tsp");
+  TourTy tour(randomPermutation(g.numVertices()));
+  xtsp::algo::ThreeOptFinder<int> solver(g, 10);
+  checkLocalSearchRun("3-opt on pr144", tour, g, [&] {
+    return solver.solve(tour, g, 1000, firstImprovement, method);
+  });
+  expectNoMoveLeft("3-opt (t1 = v)", g.numVertices(), [&](size_t vT1) {
+    return solver.queryMoveGivenT1(tour, vT1, g, false);
+  });
+}
+
+TEST(ThreeOpt, pr144PermTourPriorityFirstImprov)
+{
+  runThreeOptPr144<xtsp::PermTour>(true, xtsp::algo::kPriorityTwoOptSweep);
+}
+
+TEST(ThreeOpt, pr144AdjTabTourBitfieldBestImprov)
+{
+  runThreeOptPr144<xtsp::AdjTabTour>(false, xtsp::algo::kBitfieldTwoOptSweep);
+}
+
+TEST(ThreeOpt, pr144TwoLevelListTourPriorityBestImprov)
+{
+  runThreeOptPr144<xtsp::TwoLevelListTour>(false, xtsp::algo::kPriorityTwoOptSweep);
+}
+
+// each query result, applied alone, improves the tour by exactly its gain
+TEST(ThreeOpt, everyMoveTypeImprovesByItsGain)
+{
+  const auto g = loadIntGraph("pr144.tsp");
+  const auto initPerm = randomPermutation(g.numVertices(), 5);
+  xtsp::algo::ThreeOptFinder<int> solver(g, 10);
+  std::array<size_t, 4> numMovesPerType{};
+  std::array<size_t, 2> numMovesPerDirection{};
+  for (size_t v = 0; v < g.numVertices(); ++v)
+  {
+    for (bool firstImprovement : {true, false})
+    {
+      xtsp::PermTour tour(initPerm);
+      const auto res = solver.queryMoveGivenT1(tour, v, g, firstImprovement);
+      if (!res.isValid())
+        continue;
+      ASSERT_TRUE(checkMoveImprovesByItsGain(
+        fmt::format("3-opt, type = {:d}, mirrored = {}", static_cast<int>(res.type), res.mirrored),
+        tour, g, res, xtsp::algo::ThreeOptFinder<int>::applyMove));
+      ++numMovesPerType[res.type];
+      ++numMovesPerDirection[res.mirrored];
+    }
+  }
+  for (size_t type = 0; type < numMovesPerType.size(); ++type)
+    EXPECT_GT(numMovesPerType[type], 0) << "type = " << type;
+  EXPECT_GT(numMovesPerDirection[0], 0);
+  EXPECT_GT(numMovesPerDirection[1], 0);
+}
+
+// 3-opt finds what 2-opt misses
+TEST(ThreeOpt, improvesATwoOptTour)
+{
+  const auto g = loadIntGraph("pr144.tsp");
+  xtsp::AdjTabTour tour(randomPermutation(g.numVertices(), 7));
+  xtsp::algo::NeighborListTwoOptFinder<int> twoOpt(g, 10);
+  xtsp::algo::ThreeOptFinder<int> threeOpt(twoOpt.getCandidates());
+  auto res = checkImprovesOnTopOf("3-opt after 2-opt", tour, g,
+    [&] { return twoOpt.solve(tour, g); },
+    [&] { return threeOpt.solve(tour, g, 1000); });
+  EXPECT_TRUE(res.confirmedLocalOptimum());
+}
@@ -0,0 +1,80 @@
+#include "xtsp/local_search/lk.h"
+#include "xtsp/local_search/kopt.h"
+#include "xtsp/initialization/nearest_neighbor.h"
+#include "xtsp/core/tour_alternatives.h"
+#include "xtsp/core/two_level_list_tour.h"
+#include "xtsp/core/utils.h"
+#include "local_search_checks.h"
+
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+template <typename TourTy>
+static void runLinKernighan(
+  const std::string& instance, size_t maxDepth, double optimalCost, double maxGap)
+{
+  const auto g = loadIntGraph(instance);
+  xtsp::algo::LinKernighan<int> solver(g, 10, maxDepth);
+  TourTy tour(xtsp::algo::nearestNeighborTour(g, solver.getCandidates()).getSequence());
+  checkLocalSearchRun("Lin-Kernighan on " + instance, tour, g, [&] {
+    return solver.solve(tour, g);
+  });
+  EXPECT_EQ(tour.journalSize(), 0);
+  EXPECT_LT(xtsp::evalTour(tour, g), optimalCost * (1 + maxGap));
+}
+
+TEST(LinKernighan, pr144PermTour)
+{
+  runLinKernighan<xtsp::PermTour>("pr144.tsp", 50, 58537, 0.05);
+}
+
+TEST(LinKernighan, pr144AdjTabTourDepth5)
+{
+  runLinKernighan<xtsp::AdjTabTour>("pr144.tsp", 5, 58537, 0.05);
+}
+
+TEST(LinKernighan, pr144TwoLevelListTour)
+{
+  runLinKernighan<xtsp::TwoLevelListTour>("pr144.tsp", 50, 58537, 0.05);
+}
+
+TEST(LinKernighan, u1817PermTour)
+{
+  runLinKernighan<xtsp::PermTour>("u1817.tsp", 50, 57201, 0.04);
+}
+
+// a failed attempt leaves the tour as it was
+TEST(LinKernighan, noImprovementNoChange)
+{
+  const auto g = loadIntGraph("pr144.tsp");
+  xtsp::PermTour tour(randomPermutation(g.numVertices(), 7));
+  xtsp::algo::LinKernighan<int> solver(g, 10);
+  solver.solve(tour, g);
+  std::vector<size_t> nextOf(g.numVertices());
+  for (size_t v = 0; v < g.numVertices(); ++v)
+    nextOf[v] = tour.next(v);
+  for (size_t v = 0; v < g.numVertices(); ++v)
+  {
+    EXPECT_EQ(solver.improveFrom(tour, v, tour.next(v), g), 0);
+    EXPECT_EQ(solver.improveFrom(tour, v, tour.prev(v), g), 0);
+  }
+  for (size_t v = 0; v < g.numVertices(); ++v)
+    EXPECT_EQ(tour.next(v), nextOf[v]);
+  EXPECT_THROW(solver.improveFrom(tour, 0, nextOf[nextOf[0]], g),
+    std::invalid_argument);
+}
+
+// LK finds what 3-opt misses
+TEST(LinKernighan, improvesAThreeOptTour)
+{
+  const auto g = loadIntGraph("u1817.tsp");
+  xtsp::algo::ThreeOptFinder<int> threeOpt(g, 10);
+  xtsp::algo::LinKernighan<int> lk(threeOpt.getCandidates());
+  xtsp::AdjTabTour tour(xtsp::algo::nearestNeighborTour(
+    g, threeOpt.getCandidates()).getSequence());
+  checkImprovesOnTopOf("Lin-Kernighan after 3-opt", tour, g,
+    [&] { return threeOpt.solve(tour, g, 1000, false); },
+    [&] { return lk.solve(tour, g); });
+  // and vice versa, nothing is left for 3-opt
+  EXPECT_EQ(threeOpt.solve(tour, g, 1000, false).improvement(), 0);
+}
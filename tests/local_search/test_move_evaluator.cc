@@ -0,0 +1,110 @@
+#include "xtsp/local_search/move_evaluator.h"
+#include "xtsp/initialization/nearest_neighbor.h"
+#include "xtsp/core/tour_alternatives.h"
+#include "xtsp/core/two_level_list_tour.h"
+#include "xtsp/core/utils.h"
+#include "local_search_checks.h"
+
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+static const std::vector<xtsp::algo::NeighborhoodOperator> allOperators{
+  xtsp::algo::kTwoOptOperator, xtsp::algo::kTwoHOptOperator,
+  xtsp::algo::kNodeSwapOperator, xtsp::algo::kNodeInsertionOperator};
+
+template <typename TourTy>
+static void runOperatorPr144(xtsp::algo::NeighborhoodOperator op, bool firstImprovement)
+{
+  const auto g = loadIntGraph("pr144.tsp");
+  TourTy tour(randomPermutation(g.numVertices()));
+  xtsp::algo::MoveEvaluator<int> solver(g, 10);
+  const auto label = fmt::format("operator {:d} on pr144", static_cast<int>(op));
+  checkLocalSearchRun(label, tour, g, [&] {
+    return solver.solve(tour, g, op, firstImprovement);
+  });
+  expectNoMoveLeft(label, g.numVertices(), [&](size_t v) {
+    return solver.queryMoveGivenX(tour, v, op, g, false);
+  });
+}
+
+TEST(MoveEvaluator, pr144PermTourFirstImprov)
+{
+  for (const auto op : allOperators)
+    runOperatorPr144<xtsp::PermTour>(op, true);
+}
+
+TEST(MoveEvaluator, pr144AdjTabTourBestImprov)
+{
+  for (const auto op : allOperators)
+    runOperatorPr144<xtsp::AdjTabTour>(op, false);
+}
+
+TEST(MoveEvaluator, pr144TwoLevelListTourFirstImprov)
+{
+  for (const auto op : allOperators)
+    runOperatorPr144<xtsp::TwoLevelListTour>(op, true);
+}
+
+TEST(MoveEvaluator, everyMoveImprovesByItsGainAndCanBeUndone)
+{
+  const auto g = loadIntGraph("pr144.tsp");
+  xtsp::algo::MoveEvaluator<int> solver(g, 10);
+  for (const auto op : allOperators)
+  {
+    xtsp::PermTour tour(randomPermutation(g.numVertices(), 7));
+    size_t numMoves = 0;
+    for (size_t v = 0; v < g.numVertices(); ++v)
+    {
+      const auto move = solver.queryMoveGivenX(tour, v, op, g, false);
+      if (!move.isValid())
+        continue;
+      const auto oldTourCost = xtsp::evalTour(tour, g);
+      const size_t checkpoint = tour.checkpoint();
+      ASSERT_TRUE(checkMoveImprovesByItsGain(
+        fmt::format("operator {:d}, move type {:d}", static_cast<int>(op),
+          static_cast<int>(move.type)),
+        tour, g, move, xtsp::algo::MoveEvaluator<int>::applyMove));
+      // every other move is undone
+      if (numMoves++ % 2 == 1)
+      {
+        tour.rollback(checkpoint);
+        EXPECT_EQ(oldTourCost, xtsp::evalTour(tour, g));
+      }
+      tour.clearJournal();
+    }
+    EXPECT_GT(numMoves, 0) << "operator " << op;
+  }
+}
+
+TEST(MoveEvaluator, variableNeighborhoodDescent)
+{
+  const auto g = loadIntGraph("pr144.tsp");
+  xtsp::algo::MoveEvaluator<int> solver(g, 10);
+  xtsp::PermTour tour(xtsp::algo::nearestNeighborTour(
+    g, solver.getCandidates()).getSequence());
+  auto oldTourCost = xtsp::evalTour(tour, g);
+
+  // 2-opt alone, for comparison
+  xtsp::PermTour tourTwoOpt(tour.getSequence());
+  solver.solve(tourTwoOpt, g, xtsp::algo::kTwoOptOperator);
+
+  auto res = solver.variableNeighborhoodDescent(tour, g, allOperators);
+  EXPECT_TRUE(tour.isHamiltonian());
+  EXPECT_TRUE(res.confirmedLocalOptimum());
+  EXPECT_EQ(oldTourCost - res.improvement(), xtsp::evalTour(tour, g));
+  EXPECT_LE(xtsp::evalTour(tour, g), xtsp::evalTour(tourTwoOpt, g));
+  for (const auto op : allOperators)
+    expectNoMoveLeft(fmt::format("VND, operator {:d}", static_cast<int>(op)), g.numVertices(),
+      [&](size_t v) { return solver.queryMoveGivenX(tour, v, op, g, false); });
+  SPDLOG_INFO("VND on pr144: {:d} -> {:d} using {:d} moves (2-opt alone: {:d})",
+    oldTourCost, xtsp::evalTour(tour, g), res.numMoves(),
+    xtsp::evalTour(tourTwoOpt, g));
+}
+
+TEST(MoveEvaluator, rejectsAsymmetricGraphs)
+{
+  Eigen::MatrixXi costs = Eigen::MatrixXi::Ones(6, 6);
+  costs(0, 1) = 2;
+  xtsp::CompleteGraph<int> g(false, costs);
+  EXPECT_THROW(xtsp::algo::MoveEvaluator<int> solver(g), std::invalid_argument);
+}
@@ -0,0 +1,44 @@
+#include "xtsp/local_search/or_opt.h"
+#include "xtsp/local_search/kopt.h"
+#include "xtsp/core/tour_alternatives.h"
+#include "xtsp/core/utils.h"
+#include "local_search_checks.h"
+
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+template <typename TourTy>
+static void runNeighborListOrOptPr144(bool firstImprovement)
+{
+  const auto g = loadIntGraph("pr144.tsp");
+  TourTy tour(randomPermutation(g.numVertices()));
+  xtsp::algo::NeighborListOrOptFinder<int> solver(g, 10);
+  checkLocalSearchRun("neighbor-list Or-opt on pr144", tour, g, [&] {
+    return solver.solve(tour, g, firstImprovement);
+  });
+  expectNoMoveLeft("neighbor-list Or-opt", g.numVertices(), [&](size_t v) {
+    return solver.queryMoveGivenX(tour, v, g, false);
+  });
+}
+
+TEST(NeighborListOrOpt, pr144PermTourFirstImprov)
+{
+  runNeighborListOrOptPr144<xtsp::PermTour>(true);
+}
+
+TEST(NeighborListOrOpt, pr144AdjTabTourBestImprov)
+{
+  runNeighborListOrOptPr144<xtsp::AdjTabTour>(false);
+}
+
+// Or-opt finds what 2-opt misses (and vice versa)
+TEST(NeighborListOrOpt, improvesATwoOptTour)
+{
+  const auto g = loadIntGraph("pr144.tsp");
+  xtsp::AdjTabTour tour(randomPermutation(g.numVertices(), 7));
+  xtsp::algo::NeighborListTwoOptFinder<int> twoOpt(g, 10);
+  xtsp::algo::NeighborListOrOptFinder<int> orOpt(twoOpt.getCandidates());
+  checkImprovesOnTopOf("Or-opt after 2-opt", tour, g,
+    [&] { return twoOpt.solve(tour, g); },
+    [&] { return orOpt.solve(tour, g); });
+}
@@ -0,0 +1,81 @@
+#include "xtsp/local_search/parallel_kopt.h"
+#include "xtsp/initialization/nearest_neighbor.h"
+#include "xtsp/core/tour_alternatives.h"
+#include "xtsp/core/two_level_list_tour.h"
+#include "xtsp/core/utils.h"
+#include "local_search_checks.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <spdlog/spdlog.h>
+
+TEST(ThreadPool, parallelForCoversEachTaskOnce)
+{
+  xtsp::internal::ThreadPool pool(4);
+  EXPECT_EQ(pool.numThreads(), 4);
+  for (size_t numTasks : {0, 1, 3, 1000})
+  {
+    std::vector<std::atomic<int>> counts(numTasks);
+    pool.parallelFor(numTasks, [&](size_t taskId, size_t threadId) {
+      EXPECT_LT(threadId, 4);
+      ++counts[taskId];
+    });
+    for (const auto &count : counts)
+      EXPECT_EQ(count, 1);
+  }
+  EXPECT_THROW(pool.parallelFor(100, [](size_t taskId, size_t) {
+    if (taskId == 42)
+      throw std::runtime_error("task 42");
+  }), std::runtime_error);
+  // still usable afterwards
+  std::atomic<size_t> sum = 0;
+  pool.parallelFor(10, [&](size_t taskId, size_t) { sum += taskId; });
+  EXPECT_EQ(sum, 45);
+}
+
+template <typename TourTy>
+static std::vector<size_t> runParallelTwoOpt(
+  size_t numThreads, const std::string &instance, bool nearestNeighborStart)
+{
+  const auto g = loadIntGraph(instance);
+  TourTy tour(nearestNeighborStart
+    ? xtsp::algo::nearestNeighborTour(
+        g, xtsp::CandidateSet<int>::fromGraph(g, 10)).getSequence()
+    : randomPermutation(g.numVertices()));
+
+  xtsp::algo::ParallelTwoOptFinder<int> solver(numThreads);
+  EXPECT_EQ(solver.numThreads(), numThreads);
+  const auto label = fmt::format("parallel 2-opt ({:d} threads) on {}", numThreads, instance);
+  checkLocalSearchRun(label, tour, g, [&] { return solver.solve(tour, g); });
+  expectNoMoveLeft(label, g.numVertices(), [&](size_t v) {
+    return xtsp::algo::find2OptMoveGivenA(tour, v, g, false);
+  });
+
+  std::vector<size_t> perm{tour.getDepotId()};
+  while (perm.size() < tour.size())
+    perm.push_back(tour.next(perm.back()));
+  return perm;
+}
+
+TEST(ParallelTwoOpt, pr144PermTour)
+{
+  runParallelTwoOpt<xtsp::PermTour>(4, "pr144.tsp", false);
+}
+
+TEST(ParallelTwoOpt, pr144TwoLevelListTour)
+{
+  runParallelTwoOpt<xtsp::TwoLevelListTour>(3, "pr144.tsp", false);
+}
+
+// the batches don't depend on how the work is split
+TEST(ParallelTwoOpt, pr144SameForAnyNumberOfThreads)
+{
+  const auto permSingle = runParallelTwoOpt<xtsp::AdjTabTour>(1, "pr144.tsp", false);
+  const auto permMulti = runParallelTwoOpt<xtsp::AdjTabTour>(4, "pr144.tsp", false);
+  EXPECT_EQ(permSingle, permMulti);
+}
+
+TEST(ParallelTwoOpt, u1817FromNearestNeighbor)
+{
+  runParallelTwoOpt<xtsp::AdjTabTour>(4, "u1817.tsp", true);
+}
@@ -0,0 +1,303 @@
+#include "xtsp/algorithm_utils/stop_criterion.h"
+#include "xtsp/local_search/kopt.h"
+#include "xtsp/local_search/or_opt.h"
+#include "xtsp/local_search/lk.h"
+#include "xtsp/local_search/asymmetric_kopt.h"
+#include "xtsp/local_search/move_evaluator.h"
+#include "xtsp/local_search/parallel_kopt.h"
+#include "xtsp/core/tour_alternatives.h"
+#include "xtsp/core/utils.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <spdlog/spdlog.h>
+
+static const auto dataDir = std::filesystem::path(
+  __FILE__).parent_path().parent_path()/"dataset";
+
+using xtsp::algo::StopCriterion;
+
+TEST(StopCriterion, reasons)
+{
+  // nothing set: never stops
+  StopCriterion<int> never;
+  never.start(1000);
+  for (int round = 0; round < 100; ++round)
+  {
+    EXPECT_FALSE(never.shouldStop());
+    EXPECT_FALSE(never.endRound());
+  }
+  EXPECT_EQ(never.stopReason(), xtsp::algo::kNotStopped);
+
+  // the target cost, tracked via the improvements
+  StopCriterion<int> target;
+  target.setTargetCost(900);
+  target.start(1000);
+  EXPECT_FALSE(target.shouldStop());
+  target.recordImprovement(60);
+  EXPECT_EQ(target.cost(), 940);
+  EXPECT_FALSE(target.shouldStop());
+  target.recordImprovement(40);
+  EXPECT_EQ(target.cost(), 900);
+  EXPECT_TRUE(target.shouldStop());
+  EXPECT_EQ(target.stopReason(), xtsp::algo::kTargetCostReached);
+  // reached before even starting, start resets the rest
+  target.start(800);
+  EXPECT_TRUE(target.stopped());
+  target.start(2000);
+  EXPECT_FALSE(target.stopped());
+
+  // 3 rounds in a row improving by at most 5
+  StopCriterion<int> stagnation;
+  stagnation.setStagnationWindow(3, 5);
+  stagnation.start(1000);
+  stagnation.recordImprovement(3);
+  EXPECT_FALSE(stagnation.endRound());
+  stagnation.recordImprovement(5);
+  EXPECT_FALSE(stagnation.endRound());
+  stagnation.recordImprovement(6); // resets the window
+  EXPECT_FALSE(stagnation.endRound());
+  EXPECT_FALSE(stagnation.endRound());
+  EXPECT_FALSE(stagnation.endRound());
+  EXPECT_TRUE(stagnation.endRound());
+  EXPECT_EQ(stagnation.stopReason(), xtsp::algo::kStagnated);
+
+  std::atomic<bool> cancelFlag = false;
+  StopCriterion<float> cancel;
+  cancel.setCancelFlag(&cancelFlag);
+  cancel.start(1000.0f);
+  EXPECT_FALSE(cancel.shouldStop());
+  cancelFlag = true;
+  EXPECT_TRUE(cancel.shouldStop());
+  EXPECT_EQ(cancel.stopReason(), xtsp::algo::kCancelled);
+
+  // the clock is read by the first check of a run, regardless of the interval
+  StopCriterion<float> deadline;
+  deadline.setTimeBudget(StopCriterion<float>::Clock::duration::zero())
+    .setClockCheckInterval(1000);
+  deadline.start(1000.0f);
+  EXPECT_TRUE(deadline.shouldStop());
+  EXPECT_EQ(deadline.stopReason(), xtsp::algo::kDeadlineReached);
+}
+
+TEST(StopCriterion, progressCallbackOnlyReportsImprovements)
+{
+  std::vector<int> reported;
+  StopCriterion<int> stop;
+  stop.setProgressCallback([&](const xtsp::AbstractTour &, int64_t cost) {
+    reported.push_back(cost);
+  });
+  EXPECT_TRUE(stop.hasProgressCallback());
+  xtsp::PermTour tour(std::vector<size_t>{0, 1, 2, 3});
+  stop.start(100);
+  stop.endRound(tour);
+  stop.recordImprovement(10);
+  stop.endRound(tour);
+  stop.endRound(tour);
+  stop.recordImprovement(1);
+  stop.endRound(tour);
+  EXPECT_EQ(reported, (std::vector<int>{90, 89}));
+}
+
+using TourSolver = std::function<xtsp::algo::LocalSearchOutcome<int>(
+  xtsp::AbstractTour &tour, const xtsp::AbstractCompGraph<int> &g,
+  StopCriterion<int> *stop)>;
+
+// cancel the solver from the progress callback, i.e., after its first round
+static void checkCancelledAfterFirstRound(const std::string &name, TourSolver solver)
+{
+  spdlog::set_level(spdlog::level::warn);
+  auto g = xtsp::ImplicitCompleteGraph<float>::loadFromTsplibFile(
+    dataDir/"pr144.tsp").explicitize(1);
+  std::vector<size_t> initPerm;
+  xtsp::utils::genPermutation(xtsp::utils::Rng_T(42), g.numVertices(), initPerm);
+  xtsp::AdjTabTour tour(initPerm);
+  const auto initCost = xtsp::evalTour(tour, g);
+
+  std::atomic<bool> cancelFlag = false;
+  std::vector<int64_t> reported;
+  StopCriterion<int> stop;
+  stop.setCancelFlag(&cancelFlag).setProgressCallback(
+    [&](const xtsp::AbstractTour &bestSoFar, int64_t cost) {
+      EXPECT_EQ(cost, xtsp::evalTour(bestSoFar, g)) << name;
+      reported.push_back(cost);
+      cancelFlag = true;
+    });
+  const auto res = solver(tour, g, &stop);
+
+  EXPECT_EQ(stop.stopReason(), xtsp::algo::kCancelled) << name;
+  EXPECT_EQ(reported.size(), 1) << name;
+  EXPECT_FALSE(res.confirmedLocalOptimum()) << name;
+  EXPECT_GT(res.numMoves(), 0) << name;
+  EXPECT_TRUE(tour.isHamiltonian()) << name;
+  EXPECT_EQ(initCost - res.improvement(), xtsp::evalTour(tour, g)) << name;
+  EXPECT_EQ(stop.cost(), xtsp::evalTour(tour, g)) << name;
+  if (!reported.empty())
+  {
+    EXPECT_EQ(reported.front(), stop.cost()) << name;
+  }
+}
+
+TEST(StopCriterion, cancelledFromTheProgressCallback)
+{
+  using namespace xtsp::algo;
+  checkCancelledAfterFirstRound("priority 2-opt",
+    [](auto &tour, const auto &g, auto *stop) {
+      return PriorityTwoOptFinder<int>(tour, g).solve(tour, g, 10, true, stop);
+    });
+  checkCancelledAfterFirstRound("neighbor-list 2-opt",
+    [](auto &tour, const auto &g, auto *stop) {
+      return NeighborListTwoOptFinder<int>(g, 8).solve(tour, g, true, stop);
+    });
+  checkCancelledAfterFirstRound("3-opt",
+    [](auto &tour, const auto &g, auto *stop) {
+      return ThreeOptFinder<int>(g, 8).solve(
+        tour, g, 10, true, kPriorityTwoOptSweep, stop);
+    });
+  checkCancelledAfterFirstRound("Or-opt",
+    [](auto &tour, const auto &g, auto *stop) {
+      return NeighborListOrOptFinder<int>(g, 8).solve(tour, g, true, stop);
+    });
+  checkCancelledAfterFirstRound("LK",
+    [](auto &tour, const auto &g, auto *stop) {
+      return LinKernighan<int>(g, 8).solve(tour, g, stop);
+    });
+  checkCancelledAfterFirstRound("asymmetric 2-opt",
+    [](auto &tour, const auto &g, auto *stop) {
+      return AsymmetricTwoOptFinder<int>(g, 8).solve(tour, g, true, stop);
+    });
+  checkCancelledAfterFirstRound("Or-3opt",
+    [](auto &tour, const auto &g, auto *stop) {
+      return OrThreeOptFinder<int>(g, 8).solve(tour, g, true, stop);
+    });
+  checkCancelledAfterFirstRound("VND",
+    [](auto &tour, const auto &g, auto *stop) {
+      return MoveEvaluator<int>(g, 8).variableNeighborhoodDescent(tour, g,
+        {kTwoOptOperator, kNodeInsertionOperator}, true, stop);
+    });
+  checkCancelledAfterFirstRound("parallel 2-opt",
+    [](auto &tour, const auto &g, auto *stop) {
+      return ParallelTwoOptFinder<int>(2).solve(tour, g, 1000, stop);
+    });
+}
+
+TEST(StopCriterion, priorityTwoOptStopsEarly)
+{
+  spdlog::set_level(spdlog::level::warn);
+  auto g = xtsp::ImplicitCompleteGraph<float>::loadFromTsplibFile(
+    dataDir/"pr144.tsp").explicitize(1);
+  std::vector<size_t> initPerm;
+  xtsp::utils::genPermutation(xtsp::utils::Rng_T(7), g.numVertices(), initPerm);
+  const auto initCost = xtsp::evalTour(xtsp::PermTour(initPerm), g);
+  xtsp::algo::PriorityTwoOptFinder<int> solver(xtsp::PermTour(initPerm), g);
+
+  // cancelled up front: the tour stays as it is
+  {
+    xtsp::PermTour tour(initPerm);
+    std::atomic<bool> cancelFlag = true;
+    StopCriterion<int> stop;
+    stop.setCancelFlag(&cancelFlag);
+    const auto res = solver.solve(tour, g, 1000, true, &stop);
+    EXPECT_EQ(stop.stopReason(), xtsp::algo::kCancelled);
+    EXPECT_EQ(res.numMoves(), 0);
+    EXPECT_FALSE(res.confirmedTwoOpt());
+    EXPECT_EQ(tour.getSequence(), initPerm);
+  }
+
+  // the deadline has passed already
+  {
+    xtsp::PermTour tour(initPerm);
+    StopCriterion<int> stop;
+    stop.setDeadline(StopCriterion<int>::Clock::now());
+    const auto res = solver.solve(tour, g, 1000, true, &stop);
+    EXPECT_EQ(stop.stopReason(), xtsp::algo::kDeadlineReached);
+    EXPECT_EQ(res.numMoves(), 0);
+    EXPECT_FALSE(res.confirmedTwoOpt());
+  }
+
+  // halfway to the 2-opt local optimum
+  xtsp::PermTour fullTour(initPerm);
+  const auto fullRes = solver.solve(fullTour, g, 1000);
+  ASSERT_TRUE(fullRes.confirmedTwoOpt());
+  const auto targetCost = initCost - fullRes.improvement() / 2;
+  {
+    xtsp::PermTour tour(initPerm);
+    StopCriterion<int> stop;
+    stop.setTargetCost(targetCost);
+    const auto res = solver.solve(tour, g, 1000, true, &stop);
+    EXPECT_EQ(stop.stopReason(), xtsp::algo::kTargetCostReached);
+    EXPECT_FALSE(res.confirmedTwoOpt());
+    EXPECT_LT(res.numMoves(), fullRes.numMoves());
+    EXPECT_LE(xtsp::evalTour(tour, g), targetCost);
+    EXPECT_EQ(stop.cost(), xtsp::evalTour(tour, g));
+    EXPECT_TRUE(tour.isHamiltonian());
+  }
+
+  // the sweeps keep improving by less than the whole first one
+  {
+    xtsp::PermTour tour(initPerm);
+    StopCriterion<int> stop;
+    stop.setStagnationWindow(1, initCost);
+    const auto res = solver.solve(tour, g, 1000, true, &stop);
+    EXPECT_EQ(stop.stopReason(), xtsp::algo::kStagnated);
+    EXPECT_FALSE(res.confirmedTwoOpt());
+    EXPECT_EQ(initCost - res.improvement(), xtsp::evalTour(tour, g));
+  }
+}
+
+// VND is one run, i.e., the stagnation window spans the operators
+TEST(StopCriterion, stagnationAcrossTheVndOperators)
+{
+  using namespace xtsp::algo;
+  spdlog::set_level(spdlog::level::warn);
+  auto g = xtsp::ImplicitCompleteGraph<float>::loadFromTsplibFile(
+    dataDir/"pr144.tsp").explicitize(1);
+  std::vector<size_t> initPerm;
+  xtsp::utils::genPermutation(xtsp::utils::Rng_T(3), g.numVertices(), initPerm);
+  xtsp::AdjTabTour tour(initPerm);
+  MoveEvaluator<int> evaluator(g, 8);
+  const std::vector<NeighborhoodOperator> ops{kTwoOptOperator, kNodeInsertionOperator};
+  ASSERT_TRUE(evaluator.variableNeighborhoodDescent(tour, g, ops).confirmedLocalOptimum());
+
+  // one move-free round per operator
+  StopCriterion<int> stop;
+  stop.setStagnationWindow(2);
+  const auto res = evaluator.variableNeighborhoodDescent(tour, g, ops, true, &stop);
+  EXPECT_EQ(stop.stopReason(), kStagnated);
+  EXPECT_EQ(res.numMoves(), 0);
+  EXPECT_FALSE(res.confirmedLocalOptimum());
+  EXPECT_EQ(stop.cost(), xtsp::evalTour(tour, g));
+
+  // only 2 move-free rounds in total, i.e., fewer than the window
+  StopCriterion<int> wider;
+  wider.setStagnationWindow(3);
+  EXPECT_TRUE(evaluator.variableNeighborhoodDescent(tour, g, ops, true, &wider)
+    .confirmedLocalOptimum());
+  EXPECT_EQ(wider.stopReason(), kNotStopped);
+}
+
+TEST(StopCriterion, timeBudget)
+{
+  spdlog::set_level(spdlog::level::warn);
+  auto g = xtsp::ImplicitCompleteGraph<float>::loadFromTsplibFile(dataDir/"u1817.tsp");
+  std::vector<size_t> initPerm;
+  xtsp::utils::genPermutation(xtsp::utils::Rng_T(1), g.numVertices(), initPerm);
+  xtsp::AdjTabTour tour(initPerm);
+  const auto initCost = xtsp::evalTour(tour, g);
+
+  // the exhaustive 2-opt from a random tour takes way longer than that
+  using Clock = StopCriterion<float>::Clock;
+  StopCriterion<float> stop;
+  stop.setTimeBudget(std::chrono::milliseconds(50));
+  const auto startTime = Clock::now();
+  xtsp::algo::PriorityTwoOptFinder<float> solver(tour, g);
+  const auto res = solver.solve(tour, g, 1000, true, &stop);
+  const auto elapsed = Clock::now() - startTime;
+  EXPECT_EQ(stop.stopReason(), xtsp::algo::kDeadlineReached);
+  EXPECT_FALSE(res.confirmedTwoOpt());
+  EXPECT_LT(elapsed, std::chrono::seconds(2));
+  EXPECT_TRUE(tour.isHamiltonian());
+  EXPECT_NEAR(initCost - res.improvement(), xtsp::evalTour(tour, g), 1e-3 * initCost);
+}